@@ -0,0 +1,290 @@
+#include "block_compressor.h"
+#include "mip_generator.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static void DecodeBc1Colors(const uint8_t* Block, bool bAlwaysFourColors, uint8_t Texels[16][4])
+{
+    uint16_t Color0 = static_cast<uint16_t>(Block[0] | Block[1] << 8);
+    uint16_t Color1 = static_cast<uint16_t>(Block[2] | Block[3] << 8);
+
+    int Palette[4][4];
+    UnpackRgb565(Color0, Palette[0]);
+    UnpackRgb565(Color1, Palette[1]);
+
+    for (int c = 0; c < 3; ++c)
+    {
+        if (Color0 > Color1 || bAlwaysFourColors)
+        {
+            Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+            Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+        }
+        else
+        {
+            Palette[2][c] = (Palette[0][c] + Palette[1][c]) / 2;
+            Palette[3][c] = 0;
+        }
+    }
+
+    uint32_t Indices = Block[4] | Block[5] << 8 | Block[6] << 16 | static_cast<uint32_t>(Block[7]) << 24;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            Texels[i][c] = static_cast<uint8_t>(Palette[(Indices >> (i * 2)) & 3][c]);
+        }
+
+        Texels[i][3] = 255;
+    }
+}
+
+static void DecodeBc3Block(const uint8_t* Block, uint8_t Texels[16][4])
+{
+    DecodeBc1Colors(Block + 8, true, Texels);
+
+    int Palette[8] = {Block[0], Block[1]};
+
+    for (int k = 2; k < 8; ++k)
+    {
+        Palette[k] = Block[0] > Block[1] ? ((8 - k) * Block[0] + (k - 1) * Block[1] + 3) / 7 : k < 6 ? ((6 - k) * Block[0] + (k - 1) * Block[1] + 2) / 5 : (k == 6 ? 0 : 255);
+    }
+
+    uint64_t Indices = 0;
+
+    for (int b = 0; b < 6; ++b)
+    {
+        Indices |= static_cast<uint64_t>(Block[2 + b]) << (b * 8);
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        Texels[i][3] = static_cast<uint8_t>(Palette[(Indices >> (i * 3)) & 7]);
+    }
+}
+
+static uint32_t ReadBlockBits(const uint8_t* Block, int& Offset, int Count)
+{
+    uint32_t Value = 0;
+
+    for (int b = 0; b < Count; ++b, ++Offset)
+    {
+        Value |= static_cast<uint32_t>((Block[Offset / 8] >> (Offset % 8)) & 1) << b;
+    }
+
+    return Value;
+}
+
+// Mode 6 only, the encoder emits nothing else
+static bool DecodeBc7Block(const uint8_t* Block, uint8_t Texels[16][4])
+{
+    int Offset = 0;
+
+    if (ReadBlockBits(Block, Offset, 7) != 1u << 6)
+    {
+        return false;
+    }
+
+    int Endpoints[2][4];
+
+    for (int c = 0; c < 4; ++c)
+    {
+        Endpoints[0][c] = static_cast<int>(ReadBlockBits(Block, Offset, 7)) << 1;
+        Endpoints[1][c] = static_cast<int>(ReadBlockBits(Block, Offset, 7)) << 1;
+    }
+
+    for (auto& Endpoint : Endpoints)
+    {
+        uint32_t PBit = ReadBlockBits(Block, Offset, 1);
+
+        for (int c = 0; c < 4; ++c)
+        {
+            Endpoint[c] |= static_cast<int>(PBit);
+        }
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        int Weight = BC7_WEIGHTS[ReadBlockBits(Block, Offset, i == 0 ? 3 : 4)];
+
+        for (int c = 0; c < 4; ++c)
+        {
+            Texels[i][c] = static_cast<uint8_t>(((64 - Weight) * Endpoints[0][c] + Weight * Endpoints[1][c] + 32) >> 6);
+        }
+    }
+
+    return true;
+}
+
+static bool DecodeTextureMip(const FTextureMip& Compressed, EBlockFormat Format, FTextureMip& Mip)
+{
+    uint32_t BlocksX = (Compressed.Width + 3) / 4;
+    uint32_t BlocksY = (Compressed.Height + 3) / 4;
+    uint32_t BlockSize = GetBlockFormatSize(Format);
+
+    Mip = {Compressed.Width, Compressed.Height, std::vector<uint8_t>(static_cast<std::size_t>(Compressed.Width) * Compressed.Height * 4)};
+
+    for (uint32_t y = 0; y < BlocksY; ++y)
+    {
+        for (uint32_t x = 0; x < BlocksX; ++x)
+        {
+            const uint8_t* Block = &Compressed.Data[(static_cast<std::size_t>(y) * BlocksX + x) * BlockSize];
+            uint8_t Texels[16][4];
+
+            if (Format == EBlockFormat::Bc1)
+            {
+                DecodeBc1Colors(Block, false, Texels);
+            }
+            else if (Format == EBlockFormat::Bc3)
+            {
+                DecodeBc3Block(Block, Texels);
+            }
+            else if (!DecodeBc7Block(Block, Texels))
+            {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t TexelX = x * 4 + i % 4;
+                uint32_t TexelY = y * 4 + i / 4;
+
+                if (TexelX < Mip.Width && TexelY < Mip.Height)
+                {
+                    std::copy(Texels[i], Texels[i] + 4, &Mip.Data[(static_cast<std::size_t>(TexelY) * Mip.Width + TexelX) * 4]);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static double GetPsnr(const FTextureMip& A, const FTextureMip& B, int Channels)
+{
+    double SquaredError = 0.;
+
+    for (std::size_t i = 0; i < A.Data.size(); ++i)
+    {
+        if (static_cast<int>(i % 4) < Channels)
+        {
+            SquaredError += (A.Data[i] - B.Data[i]) * (A.Data[i] - B.Data[i]);
+        }
+    }
+
+    double MeanSquaredError = SquaredError / (A.Data.size() / 4 * Channels);
+    return MeanSquaredError > 0. ? 10. * std::log10(255. * 255. / MeanSquaredError) : 99.;
+}
+
+static const char* GetBlockFormatName(EBlockFormat Format)
+{
+    return Format == EBlockFormat::Bc1 ? "BC1" : Format == EBlockFormat::Bc3 ? "BC3" : "BC7";
+}
+
+static const char* GetQualityName(ECompressionQuality Quality)
+{
+    return Quality == ECompressionQuality::Fast ? "fast" : Quality == ECompressionQuality::Normal ? "normal" : "high";
+}
+
+// Flat blocks have to survive exactly and odd sized levels must cover every texel
+static bool RunRoundTripTests()
+{
+    std::mt19937 Random(42);
+
+    for (EBlockFormat Format : {EBlockFormat::Bc1, EBlockFormat::Bc3, EBlockFormat::Bc7})
+    {
+        for (ECompressionQuality Quality : {ECompressionQuality::Fast, ECompressionQuality::Normal, ECompressionQuality::High})
+        {
+            for (uint32_t Size : {1u, 3u, 4u, 6u, 13u})
+            {
+                const uint8_t Flat[4] = {0, 255, 132, 255};
+                FTextureMip Mip{Size, Size + 1, std::vector<uint8_t>(static_cast<std::size_t>(Size) * (Size + 1) * 4)};
+
+                for (std::size_t i = 0; i < Mip.Data.size(); ++i)
+                {
+                    Mip.Data[i] = Flat[i % 4];
+                }
+
+                FTextureMip Decoded;
+
+                if (!DecodeTextureMip(CompressTextureMip(Mip, Format, Quality), Format, Decoded) || GetPsnr(Mip, Decoded, 4) < 40.)
+                {
+                    std::cerr << GetBlockFormatName(Format) << " " << GetQualityName(Quality) << " failed on a flat " << Size << "x" << Size + 1 << " level" << std::endl;
+                    return false;
+                }
+
+                for (auto& Value : Mip.Data)
+                {
+                    Value = static_cast<uint8_t>(Random());
+                }
+
+                if (!DecodeTextureMip(CompressTextureMip(Mip, Format, Quality), Format, Decoded))
+                {
+                    std::cerr << GetBlockFormatName(Format) << " " << GetQualityName(Quality) << " wrote an undecodable block" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::string TexturePath = argc > 1 ? argv[1] : "models/viking_room/viking_room.png";
+
+    if (!RunRoundTripTests())
+    {
+        return EXIT_FAILURE;
+    }
+
+    int Width, Height, Channels;
+    stbi_uc* Pixels = stbi_load(TexturePath.c_str(), &Width, &Height, &Channels, STBI_rgb_alpha);
+
+    if (!Pixels)
+    {
+        std::cerr << "Failed to load texture image " << TexturePath << ": " << stbi_failure_reason() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    FTextureMip Mip{static_cast<uint32_t>(Width), static_cast<uint32_t>(Height), std::vector<uint8_t>(Pixels, Pixels + static_cast<std::size_t>(Width) * Height * 4)};
+    stbi_image_free(Pixels);
+
+    double Texels = static_cast<double>(Width) * Height;
+
+    std::cout << "Round trip tests:      passed" << std::endl;
+    std::cout << "Image:                 " << Width << "x" << Height << ", " << Mip.Data.size() << " bytes" << std::endl;
+
+    for (EBlockFormat Format : {EBlockFormat::Bc1, EBlockFormat::Bc3, EBlockFormat::Bc7})
+    {
+        for (ECompressionQuality Quality : {ECompressionQuality::Fast, ECompressionQuality::Normal, ECompressionQuality::High})
+        {
+            auto Start = std::chrono::high_resolution_clock::now();
+            FTextureMip Compressed = CompressTextureMip(Mip, Format, Quality);
+            auto EncodeTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+
+            FTextureMip Decoded;
+
+            if (!DecodeTextureMip(Compressed, Format, Decoded))
+            {
+                std::cerr << "Failed to decode " << GetBlockFormatName(Format) << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            std::cout << GetBlockFormatName(Format) << " " << GetQualityName(Quality) << ":" << std::string(14 - std::string(GetQualityName(Quality)).size(), ' ') << Compressed.Data.size() << " bytes, RGB PSNR "
+                      << GetPsnr(Mip, Decoded, 3) << " dB, encode " << EncodeTime << " ms, " << Texels / EncodeTime / 1e3 << " Mtexels/s" << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+#include "mesh_codec.h"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Matches the compact vertex format the application streams: SNORM16 positions and UNORM16 texture coordinates, both
+// relative to their bounds
+struct FBenchmarkVertex
+{
+    int16_t Position[4];
+    uint16_t TexCoord[2];
+};
+
+static bool RoundTripVertices(const std::vector<uint8_t>& Vertices, std::size_t Stride)
+{
+    std::size_t VertexCount = Vertices.size() / Stride;
+    std::vector<uint8_t> Encoded;
+
+    if (!EncodeVertexBuffer(Vertices.data(), VertexCount, Stride, Encoded) || !ValidateMeshCodecStream(Encoded.data(), Encoded.size(), VertexCount))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> Decoded(Vertices.size());
+
+    if (!DecodeVertexBuffer(Decoded.data(), Encoded.data(), Encoded.size(), VertexCount, Stride, 0, VertexCount) || Decoded != Vertices)
+    {
+        return false;
+    }
+
+    // Every block range a streamed upload can ask for decodes to the same bytes
+    for (std::size_t First = 0; First < VertexCount; First += MESH_CODEC_BLOCK_SIZE)
+    {
+        std::size_t End = std::min<std::size_t>(VertexCount, First + 2 * MESH_CODEC_BLOCK_SIZE);
+        std::vector<uint8_t> Range((End - First) * Stride);
+
+        if (!DecodeVertexBuffer(Range.data(), Encoded.data(), Encoded.size(), VertexCount, Stride, First, End) ||
+            !std::equal(Range.begin(), Range.end(), Vertices.begin() + First * Stride))
+        {
+            return false;
+        }
+    }
+
+    // Truncated streams have to be rejected instead of read past their end
+    return Encoded.size() <= (GetMeshCodecBlockCount(VertexCount) + 1) * sizeof(uint32_t) ||
+           !DecodeVertexBuffer(Decoded.data(), Encoded.data(), Encoded.size() - 1, VertexCount, Stride, 0, VertexCount);
+}
+
+template<typename IndexType>
+static bool RoundTripIndices(const std::vector<IndexType>& Indices)
+{
+    std::vector<uint8_t> Encoded = EncodeIndexBuffer(Indices.data(), Indices.size(), sizeof(IndexType));
+    std::vector<IndexType> Decoded(Indices.size());
+
+    return ValidateMeshCodecStream(Encoded.data(), Encoded.size(), Indices.size()) &&
+           DecodeIndexBuffer(Decoded.data(), Encoded.data(), Encoded.size(), Indices.size(), sizeof(IndexType)) && Decoded == Indices;
+}
+
+static bool RunRoundTripTests()
+{
+    std::mt19937 Random(42);
+
+    for (std::size_t Stride : {1, 3, 4, 8, 12, 20, 32, 64})
+    {
+        for (std::size_t VertexCount : {0, 1, 15, 16, 17, 255, 256, 257, 1000})
+        {
+            std::vector<uint8_t> Noise(VertexCount * Stride);
+            std::vector<uint8_t> Smooth(VertexCount * Stride);
+
+            for (std::size_t i = 0; i < Noise.size(); ++i)
+            {
+                Noise[i] = static_cast<uint8_t>(Random());
+                Smooth[i] = static_cast<uint8_t>(i / Stride / 3 + i % Stride * 7 + Random() % 3);
+            }
+
+            if (!RoundTripVertices(Noise, Stride) || !RoundTripVertices(Smooth, Stride))
+            {
+                std::cerr << "Vertex round trip failed for stride " << Stride << ", " << VertexCount << " vertices" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    for (std::size_t IndexCount : {0, 3, 255, 256, 257, 3000})
+    {
+        std::vector<uint16_t> Indices16(IndexCount);
+        std::vector<uint32_t> Indices32(IndexCount);
+
+        for (std::size_t i = 0; i < IndexCount; ++i)
+        {
+            Indices16[i] = static_cast<uint16_t>(i % 7 == 0 ? Random() : i / 2);
+            Indices32[i] = i % 5 == 0 ? static_cast<uint32_t>(Random()) : static_cast<uint32_t>(i / 2);
+        }
+
+        if (IndexCount > 2)
+        {
+            Indices16[1] = 65535;
+            Indices32[2] = 0xFFFFFFFFu;
+        }
+
+        if (!RoundTripIndices(Indices16) || !RoundTripIndices(Indices32))
+        {
+            std::cerr << "Index round trip failed for " << IndexCount << " indices" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename FunctionType>
+static double MeasureBest(FunctionType Function, int Iterations)
+{
+    double Best = 1e30;
+
+    for (int i = 0; i < Iterations; ++i)
+    {
+        auto Start = std::chrono::high_resolution_clock::now();
+        Function();
+        auto End = std::chrono::high_resolution_clock::now();
+
+        Best = std::min(Best, std::chrono::duration<double, std::milli>(End - Start).count());
+    }
+
+    return Best;
+}
+
+int main(int argc, char** argv)
+{
+    std::string ModelPath = argc > 1 ? argv[1] : "models/viking_room/viking_room.obj";
+    int Iterations = argc > 2 ? std::stoi(argv[2]) : 50;
+
+    if (!RunRoundTripTests())
+    {
+        return EXIT_FAILURE;
+    }
+
+    tinyobj::attrib_t Attrib;
+    std::vector<tinyobj::shape_t> Shapes;
+    std::vector<tinyobj::material_t> Materials;
+    std::string Warn, Err;
+
+    if (!tinyobj::LoadObj(&Attrib, &Shapes, &Materials, &Warn, &Err, ModelPath.c_str()))
+    {
+        std::cerr << Warn << Err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Corners are deduplicated in first use order, close to the vertex fetch order of the application
+    float Min[3] = {1e30f, 1e30f, 1e30f};
+    float Max[3] = {-1e30f, -1e30f, -1e30f};
+
+    for (std::size_t i = 0; i < Attrib.vertices.size(); ++i)
+    {
+        Min[i % 3] = std::min(Min[i % 3], Attrib.vertices[i]);
+        Max[i % 3] = std::max(Max[i % 3], Attrib.vertices[i]);
+    }
+
+    float TexMin[2] = {1e30f, 1e30f};
+    float TexMax[2] = {-1e30f, -1e30f};
+
+    for (std::size_t i = 0; i < Attrib.texcoords.size(); ++i)
+    {
+        TexMin[i % 2] = std::min(TexMin[i % 2], Attrib.texcoords[i]);
+        TexMax[i % 2] = std::max(TexMax[i % 2], Attrib.texcoords[i]);
+    }
+
+    std::vector<FBenchmarkVertex> Vertices;
+    std::vector<uint32_t> Indices;
+    std::map<std::pair<int, int>, uint32_t> UniqueVertices;
+
+    for (const auto& Shape : Shapes)
+    {
+        for (const auto& Index : Shape.mesh.indices)
+        {
+            auto Result = UniqueVertices.emplace(std::make_pair(Index.vertex_index, Index.texcoord_index), static_cast<uint32_t>(Vertices.size()));
+
+            if (Result.second)
+            {
+                FBenchmarkVertex Vert{};
+
+                for (int i = 0; i < 3; ++i)
+                {
+                    float Normalized = (Attrib.vertices[3 * Index.vertex_index + i] - Min[i]) / std::max(Max[i] - Min[i], 1e-6f) * 2.f - 1.f;
+                    Vert.Position[i] = static_cast<int16_t>(std::lround(Normalized * 32767.f));
+                }
+
+                for (int i = 0; i < 2; ++i)
+                {
+                    float Normalized = Index.texcoord_index >= 0 ? (Attrib.texcoords[2 * Index.texcoord_index + i] - TexMin[i]) / std::max(TexMax[i] - TexMin[i], 1e-6f) : 0.f;
+                    Vert.TexCoord[i] = static_cast<uint16_t>(std::lround(Normalized * 65535.f));
+                }
+
+                Vertices.push_back(Vert);
+            }
+
+            Indices.push_back(Result.first->second);
+        }
+    }
+
+    std::vector<uint8_t> EncodedVertices;
+    EncodeVertexBuffer(Vertices.data(), Vertices.size(), sizeof(FBenchmarkVertex), EncodedVertices);
+    std::vector<uint8_t> EncodedIndices = EncodeIndexBuffer(Indices.data(), Indices.size(), sizeof(uint32_t));
+
+    std::vector<FBenchmarkVertex> DecodedVertices(Vertices.size());
+    std::vector<uint32_t> DecodedIndices(Indices.size());
+    bool bDecoded = true;
+
+    double VertexTime = MeasureBest([&]() { bDecoded &= DecodeVertexBuffer(DecodedVertices.data(), EncodedVertices.data(), EncodedVertices.size(), Vertices.size(), sizeof(FBenchmarkVertex), 0, Vertices.size()); }, Iterations);
+    double IndexTime = MeasureBest([&]() { bDecoded &= DecodeIndexBuffer(DecodedIndices.data(), EncodedIndices.data(), EncodedIndices.size(), Indices.size(), sizeof(uint32_t)); }, Iterations);
+    double CopyTime = MeasureBest([&]() { std::memcpy(DecodedVertices.data(), Vertices.data(), Vertices.size() * sizeof(FBenchmarkVertex)); }, Iterations);
+
+    if (!bDecoded || std::memcmp(DecodedVertices.data(), Vertices.data(), Vertices.size() * sizeof(FBenchmarkVertex)) != 0 || DecodedIndices != Indices)
+    {
+        std::cerr << "Decoded model differs" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    double VertexBytes = static_cast<double>(Vertices.size() * sizeof(FBenchmarkVertex));
+    double IndexBytes = static_cast<double>(Indices.size() * sizeof(uint32_t));
+
+    std::cout << "Round trip tests:      passed" << std::endl;
+    std::cout << "Vertices:              " << VertexBytes << " -> " << EncodedVertices.size() << " bytes, decode " << VertexTime << " ms, " << VertexBytes / VertexTime / 1e6 << " GB/s" << std::endl;
+    std::cout << "Indices:               " << IndexBytes << " -> " << EncodedIndices.size() << " bytes, decode " << IndexTime << " ms, " << IndexBytes / IndexTime / 1e6 << " GB/s" << std::endl;
+    std::cout << "memcpy:                " << VertexBytes / CopyTime / 1e6 << " GB/s" << std::endl;
+
+    return EXIT_SUCCESS;
+}
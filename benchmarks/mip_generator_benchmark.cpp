@@ -0,0 +1,177 @@
+#include "mip_generator.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static uint8_t LinearToSrgb(float Value)
+{
+    Value = std::min(std::max(Value, 0.f), 1.f);
+    Value = Value <= 0.0031308f ? Value * 12.92f : 1.055f * std::pow(Value, 1.f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(Value * 255.f + 0.5f);
+}
+
+// Scalar float chain the generator has to match, every level is filtered from the unquantized level above
+static std::vector<FTextureMip> GenerateReferenceMipChain(const uint8_t* Pixels, uint32_t Width, uint32_t Height)
+{
+    uint32_t LevelCount = std::min(GetTextureMipLevelCount(Width, Height), TEXTURE_CACHE_MAX_LEVELS);
+
+    std::vector<FTextureMip> Mips(LevelCount);
+    Mips[0] = {Width, Height, std::vector<uint8_t>(Pixels, Pixels + static_cast<std::size_t>(Width) * Height * 4)};
+
+    std::vector<float> Source(Mips[0].Data.size());
+
+    for (std::size_t i = 0; i < Source.size(); ++i)
+    {
+        Source[i] = i % 4 == 3 ? Pixels[i] / 255.f : GetSrgbToLinear16Table()[Pixels[i]] / 65535.f;
+    }
+
+    for (uint32_t Level = 1; Level < LevelCount; ++Level)
+    {
+        uint32_t SourceWidth = Mips[Level - 1].Width;
+        uint32_t SourceHeight = Mips[Level - 1].Height;
+        FTextureMip& Mip = Mips[Level];
+        Mip = {std::max(SourceWidth / 2, 1u), std::max(SourceHeight / 2, 1u), {}};
+        Mip.Data.resize(static_cast<std::size_t>(Mip.Width) * Mip.Height * 4);
+
+        std::vector<float> Filtered(Mip.Data.size());
+
+        for (uint32_t y = 0; y < Mip.Height; ++y)
+        {
+            for (uint32_t x = 0; x < Mip.Width; ++x)
+            {
+                uint32_t X[2] = {std::min(x * 2, SourceWidth - 1), std::min(x * 2 + 1, SourceWidth - 1)};
+                uint32_t Y[2] = {std::min(y * 2, SourceHeight - 1), std::min(y * 2 + 1, SourceHeight - 1)};
+
+                for (int c = 0; c < 4; ++c)
+                {
+                    float Sum = 0.f;
+
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        Sum += Source[(static_cast<std::size_t>(Y[i / 2]) * SourceWidth + X[i % 2]) * 4 + c];
+                    }
+
+                    std::size_t Index = (static_cast<std::size_t>(y) * Mip.Width + x) * 4 + c;
+                    Filtered[Index] = Sum * 0.25f;
+                    Mip.Data[Index] = c == 3 ? static_cast<uint8_t>(Filtered[Index] * 255.f + 0.5f) : LinearToSrgb(Filtered[Index]);
+                }
+            }
+        }
+
+        Source = std::move(Filtered);
+    }
+
+    return Mips;
+}
+
+static int GetMaxDifference(const std::vector<FTextureMip>& A, const std::vector<FTextureMip>& B)
+{
+    if (A.size() != B.size())
+    {
+        return 256;
+    }
+
+    int MaxDifference = 0;
+
+    for (std::size_t Level = 0; Level < A.size(); ++Level)
+    {
+        if (A[Level].Width != B[Level].Width || A[Level].Height != B[Level].Height || A[Level].Data.size() != B[Level].Data.size())
+        {
+            return 256;
+        }
+
+        for (std::size_t i = 0; i < A[Level].Data.size(); ++i)
+        {
+            MaxDifference = std::max(MaxDifference, std::abs(A[Level].Data[i] - B[Level].Data[i]));
+        }
+    }
+
+    return MaxDifference;
+}
+
+static bool RunReferenceTests()
+{
+    std::mt19937 Random(42);
+    const uint32_t Sizes[][2] = {{1, 1}, {1, 7}, {7, 1}, {2, 2}, {3, 5}, {5, 3}, {4, 4}, {6, 9}, {17, 33}, {64, 1}, {255, 130}, {512, 512}};
+
+    for (const auto& Size : Sizes)
+    {
+        std::vector<uint8_t> Pixels(static_cast<std::size_t>(Size[0]) * Size[1] * 4);
+
+        for (auto& Pixel : Pixels)
+        {
+            Pixel = static_cast<uint8_t>(Random());
+        }
+
+        int MaxDifference = GetMaxDifference(GenerateMipChain(Pixels.data(), Size[0], Size[1]), GenerateReferenceMipChain(Pixels.data(), Size[0], Size[1]));
+
+        if (MaxDifference > 1)
+        {
+            std::cerr << "Mip chain of " << Size[0] << "x" << Size[1] << " differs from the reference by " << MaxDifference << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename FunctionType>
+static double MeasureBest(FunctionType Function, int Iterations)
+{
+    double Best = 1e30;
+
+    for (int i = 0; i < Iterations; ++i)
+    {
+        auto Start = std::chrono::high_resolution_clock::now();
+        Function();
+        auto End = std::chrono::high_resolution_clock::now();
+
+        Best = std::min(Best, std::chrono::duration<double, std::milli>(End - Start).count());
+    }
+
+    return Best;
+}
+
+int main(int argc, char** argv)
+{
+    std::string TexturePath = argc > 1 ? argv[1] : "models/viking_room/viking_room.png";
+    int Iterations = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    if (!RunReferenceTests())
+    {
+        return EXIT_FAILURE;
+    }
+
+    int Width, Height, Channels;
+    stbi_uc* Pixels = stbi_load(TexturePath.c_str(), &Width, &Height, &Channels, STBI_rgb_alpha);
+
+    if (!Pixels)
+    {
+        std::cerr << "Failed to load texture image " << TexturePath << ": " << stbi_failure_reason() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<FTextureMip> Mips;
+    std::vector<FTextureMip> ReferenceMips;
+
+    double GeneratorTime = MeasureBest([&]() { Mips = GenerateMipChain(Pixels, static_cast<uint32_t>(Width), static_cast<uint32_t>(Height)); }, Iterations);
+    double ReferenceTime = MeasureBest([&]() { ReferenceMips = GenerateReferenceMipChain(Pixels, static_cast<uint32_t>(Width), static_cast<uint32_t>(Height)); }, Iterations);
+    stbi_image_free(Pixels);
+
+    double Texels = static_cast<double>(Width) * Height;
+
+    std::cout << "Reference tests:       passed" << std::endl;
+    std::cout << "Image:                 " << Width << "x" << Height << ", " << Mips.size() << " mip levels, max difference " << GetMaxDifference(Mips, ReferenceMips) << std::endl;
+    std::cout << "Scalar reference:      " << ReferenceTime << " ms, " << Texels / ReferenceTime / 1e3 << " Mtexels/s" << std::endl;
+    std::cout << "Mip generator:         " << GeneratorTime << " ms, " << Texels / GeneratorTime / 1e3 << " Mtexels/s" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,620 @@
+#include "texture_cache.h"
+#include "texture_formats.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+const std::vector<const char*> HostImageCopyExtensions = {
+        VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME,
+        VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME,
+        VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME
+};
+
+const VkImageUsageFlags TEXTURE_IMAGE_USAGE = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+// A headless device with one graphics queue, and host image copies when the device has them
+struct FUploadDevice
+{
+    VkInstance Instance = VK_NULL_HANDLE;
+    VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+    VkDevice Device = VK_NULL_HANDLE;
+    VkQueue Queue = VK_NULL_HANDLE;
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+    VkFence Fence = VK_NULL_HANDLE;
+    uint32_t QueueFamily = 0;
+    bool bHostImageCopySupported = false;
+    PFN_vkCopyMemoryToImageEXT CopyMemoryToImageEXT = nullptr;
+    PFN_vkCopyImageToMemoryEXT CopyImageToMemoryEXT = nullptr;
+    PFN_vkTransitionImageLayoutEXT TransitionImageLayoutEXT = nullptr;
+};
+
+static bool CheckHostImageCopySupport(VkPhysicalDevice PhysicalDevice)
+{
+    VkPhysicalDeviceProperties Properties{};
+    vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+    if (Properties.apiVersion < VK_API_VERSION_1_1)
+    {
+        return false;
+    }
+
+    uint32_t ExtensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &ExtensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> AvailableExtensions(ExtensionCount);
+    vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &ExtensionCount, AvailableExtensions.data());
+
+    std::set<std::string> RequiredExtensions(HostImageCopyExtensions.begin(), HostImageCopyExtensions.end());
+
+    for (const auto& Extension : AvailableExtensions)
+    {
+        RequiredExtensions.erase(Extension.extensionName);
+    }
+
+    if (!RequiredExtensions.empty())
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceHostImageCopyFeaturesEXT HostImageCopyFeatures{};
+    HostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2 Features{};
+    Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    Features.pNext = &HostImageCopyFeatures;
+    vkGetPhysicalDeviceFeatures2(PhysicalDevice, &Features);
+
+    if (HostImageCopyFeatures.hostImageCopy != VK_TRUE)
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceHostImageCopyPropertiesEXT HostImageCopyProperties{};
+    HostImageCopyProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2 Properties2{};
+    Properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    Properties2.pNext = &HostImageCopyProperties;
+    vkGetPhysicalDeviceProperties2(PhysicalDevice, &Properties2);
+
+    std::vector<VkImageLayout> CopySrcLayouts(HostImageCopyProperties.copySrcLayoutCount);
+    std::vector<VkImageLayout> CopyDstLayouts(HostImageCopyProperties.copyDstLayoutCount);
+    HostImageCopyProperties.pCopySrcLayouts = CopySrcLayouts.data();
+    HostImageCopyProperties.pCopyDstLayouts = CopyDstLayouts.data();
+    vkGetPhysicalDeviceProperties2(PhysicalDevice, &Properties2);
+
+    return std::find(CopyDstLayouts.begin(), CopyDstLayouts.end(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) != CopyDstLayouts.end() &&
+           std::find(CopySrcLayouts.begin(), CopySrcLayouts.end(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) != CopySrcLayouts.end();
+}
+
+static FUploadDevice CreateUploadDevice()
+{
+    FUploadDevice Upload;
+
+    VkApplicationInfo AppInfo{};
+    AppInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    AppInfo.pApplicationName = "Texture Upload Benchmark";
+    AppInfo.apiVersion = VK_API_VERSION_1_1;
+
+    VkInstanceCreateInfo InstanceInfo{};
+    InstanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    InstanceInfo.pApplicationInfo = &AppInfo;
+
+    if (vkCreateInstance(&InstanceInfo, nullptr, &Upload.Instance) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create instance!");
+    }
+
+    uint32_t DeviceCount = 0;
+    vkEnumeratePhysicalDevices(Upload.Instance, &DeviceCount, nullptr);
+
+    std::vector<VkPhysicalDevice> Devices(DeviceCount);
+    vkEnumeratePhysicalDevices(Upload.Instance, &DeviceCount, Devices.data());
+
+    // A device with host image copies is preferred, otherwise only the staging path can be measured
+    for (bool bRequireHostImageCopy : {true, false})
+    {
+        for (VkPhysicalDevice PhysicalDevice : Devices)
+        {
+            uint32_t FamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &FamilyCount, nullptr);
+
+            std::vector<VkQueueFamilyProperties> Families(FamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &FamilyCount, Families.data());
+
+            for (uint32_t i = 0; i < FamilyCount && Upload.PhysicalDevice == VK_NULL_HANDLE; ++i)
+            {
+                if ((Families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && (!bRequireHostImageCopy || CheckHostImageCopySupport(PhysicalDevice)))
+                {
+                    Upload.PhysicalDevice = PhysicalDevice;
+                    Upload.QueueFamily = i;
+                    Upload.bHostImageCopySupported = bRequireHostImageCopy;
+                }
+            }
+        }
+    }
+
+    if (Upload.PhysicalDevice == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("Failed to find a suitable GPU!");
+    }
+
+    float QueuePriority = 1.f;
+    VkDeviceQueueCreateInfo QueueInfo{};
+    QueueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    QueueInfo.queueFamilyIndex = Upload.QueueFamily;
+    QueueInfo.queueCount = 1;
+    QueueInfo.pQueuePriorities = &QueuePriority;
+
+    VkPhysicalDeviceFeatures SupportedFeatures;
+    vkGetPhysicalDeviceFeatures(Upload.PhysicalDevice, &SupportedFeatures);
+
+    VkPhysicalDeviceFeatures DeviceFeatures{};
+    DeviceFeatures.textureCompressionBC = SupportedFeatures.textureCompressionBC;
+
+    VkPhysicalDeviceHostImageCopyFeaturesEXT HostImageCopyFeatures{};
+    HostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+    HostImageCopyFeatures.hostImageCopy = VK_TRUE;
+
+    VkDeviceCreateInfo DeviceInfo{};
+    DeviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    DeviceInfo.queueCreateInfoCount = 1;
+    DeviceInfo.pQueueCreateInfos = &QueueInfo;
+    DeviceInfo.pEnabledFeatures = &DeviceFeatures;
+
+    if (Upload.bHostImageCopySupported)
+    {
+        DeviceInfo.pNext = &HostImageCopyFeatures;
+        DeviceInfo.enabledExtensionCount = static_cast<uint32_t>(HostImageCopyExtensions.size());
+        DeviceInfo.ppEnabledExtensionNames = HostImageCopyExtensions.data();
+    }
+
+    if (vkCreateDevice(Upload.PhysicalDevice, &DeviceInfo, nullptr, &Upload.Device) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create logical device!");
+    }
+
+    vkGetDeviceQueue(Upload.Device, Upload.QueueFamily, 0, &Upload.Queue);
+
+    if (Upload.bHostImageCopySupported)
+    {
+        Upload.CopyMemoryToImageEXT = (PFN_vkCopyMemoryToImageEXT) vkGetDeviceProcAddr(Upload.Device, "vkCopyMemoryToImageEXT");
+        Upload.CopyImageToMemoryEXT = (PFN_vkCopyImageToMemoryEXT) vkGetDeviceProcAddr(Upload.Device, "vkCopyImageToMemoryEXT");
+        Upload.TransitionImageLayoutEXT = (PFN_vkTransitionImageLayoutEXT) vkGetDeviceProcAddr(Upload.Device, "vkTransitionImageLayoutEXT");
+    }
+
+    VkCommandPoolCreateInfo PoolInfo{};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    PoolInfo.queueFamilyIndex = Upload.QueueFamily;
+
+    VkFenceCreateInfo FenceInfo{};
+    FenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateCommandPool(Upload.Device, &PoolInfo, nullptr, &Upload.CommandPool) != VK_SUCCESS ||
+        vkCreateFence(Upload.Device, &FenceInfo, nullptr, &Upload.Fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create command pool!");
+    }
+
+    return Upload;
+}
+
+static void DestroyUploadDevice(FUploadDevice& Upload)
+{
+    vkDestroyFence(Upload.Device, Upload.Fence, nullptr);
+    vkDestroyCommandPool(Upload.Device, Upload.CommandPool, nullptr);
+    vkDestroyDevice(Upload.Device, nullptr);
+    vkDestroyInstance(Upload.Instance, nullptr);
+}
+
+static uint32_t FindMemoryType(const FUploadDevice& Upload, uint32_t TypeFilter, VkMemoryPropertyFlags Properties)
+{
+    VkPhysicalDeviceMemoryProperties MemProperties;
+    vkGetPhysicalDeviceMemoryProperties(Upload.PhysicalDevice, &MemProperties);
+
+    for (uint32_t i = 0; i < MemProperties.memoryTypeCount; ++i)
+    {
+        if (TypeFilter & (1 << i) && (MemProperties.memoryTypes[i].propertyFlags & Properties) == Properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+static VkDeviceMemory AllocateMemory(const FUploadDevice& Upload, const VkMemoryRequirements& Requirements, VkMemoryPropertyFlags Properties)
+{
+    VkMemoryAllocateInfo AllocInfo{};
+    AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    AllocInfo.allocationSize = Requirements.size;
+    AllocInfo.memoryTypeIndex = FindMemoryType(Upload, Requirements.memoryTypeBits, Properties);
+
+    VkDeviceMemory Memory;
+
+    if (vkAllocateMemory(Upload.Device, &AllocInfo, nullptr, &Memory) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate memory!");
+    }
+
+    return Memory;
+}
+
+static void CreateTextureImage(const FUploadDevice& Upload, const FTextureCache& Texture, VkImageUsageFlags Usage, VkImage& Image, VkDeviceMemory& Memory)
+{
+    const FTextureCacheHeader& Header = Texture.GetHeader();
+
+    VkImageCreateInfo ImageInfo{};
+    ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+    ImageInfo.extent = {Header.Width, Header.Height, 1};
+    ImageInfo.mipLevels = Header.LevelCount;
+    ImageInfo.arrayLayers = 1;
+    ImageInfo.format = static_cast<VkFormat>(Header.Format);
+    ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    ImageInfo.usage = Usage;
+    ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    if (vkCreateImage(Upload.Device, &ImageInfo, nullptr, &Image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create image!");
+    }
+
+    VkMemoryRequirements Requirements;
+    vkGetImageMemoryRequirements(Upload.Device, Image, &Requirements);
+    Memory = AllocateMemory(Upload, Requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vkBindImageMemory(Upload.Device, Image, Memory, 0);
+}
+
+static void DestroyImage(const FUploadDevice& Upload, VkImage Image, VkDeviceMemory Memory)
+{
+    vkDestroyImage(Upload.Device, Image, nullptr);
+    vkFreeMemory(Upload.Device, Memory, nullptr);
+}
+
+static VkImageMemoryBarrier GetLevelsBarrier(VkImage Image, uint32_t LevelCount, VkImageLayout OldLayout, VkImageLayout NewLayout)
+{
+    VkImageMemoryBarrier Barrier{};
+    Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier.srcAccessMask = OldLayout == VK_IMAGE_LAYOUT_UNDEFINED ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+    Barrier.dstAccessMask = OldLayout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+    Barrier.oldLayout = OldLayout;
+    Barrier.newLayout = NewLayout;
+    Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.image = Image;
+    Barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, LevelCount, 0, 1};
+    return Barrier;
+}
+
+// The application's route: a staging buffer the chain is read into, a copy and two barriers on the queue, and a wait
+static void UploadThroughStaging(const FUploadDevice& Upload, const FTextureCache& Texture)
+{
+    const FTextureCacheHeader& Header = Texture.GetHeader();
+
+    VkBufferCreateInfo BufferInfo{};
+    BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferInfo.size = Texture.GetDataSize();
+    BufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer StagingBuffer;
+
+    if (vkCreateBuffer(Upload.Device, &BufferInfo, nullptr, &StagingBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create buffer!");
+    }
+
+    VkMemoryRequirements Requirements;
+    vkGetBufferMemoryRequirements(Upload.Device, StagingBuffer, &Requirements);
+    VkDeviceMemory StagingMemory = AllocateMemory(Upload, Requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vkBindBufferMemory(Upload.Device, StagingBuffer, StagingMemory, 0);
+
+    void* Data;
+    vkMapMemory(Upload.Device, StagingMemory, 0, BufferInfo.size, 0, &Data);
+
+    if (Texture.ReadLevels(0, Header.LevelCount, static_cast<char*>(Data)) == 0)
+    {
+        throw std::runtime_error("Failed to read cooked texture levels!");
+    }
+
+    vkUnmapMemory(Upload.Device, StagingMemory);
+
+    VkImage Image;
+    VkDeviceMemory ImageMemory;
+    CreateTextureImage(Upload, Texture, TEXTURE_IMAGE_USAGE, Image, ImageMemory);
+
+    std::vector<VkBufferImageCopy> Regions(Header.LevelCount);
+
+    for (uint32_t i = 0; i < Header.LevelCount; ++i)
+    {
+        Regions[i].bufferOffset = Texture.GetLevelOffset(i);
+        Regions[i].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1};
+        Regions[i].imageExtent = {Header.Levels[i].Width, Header.Levels[i].Height, 1};
+    }
+
+    VkCommandBufferAllocateInfo AllocInfo{};
+    AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    AllocInfo.commandPool = Upload.CommandPool;
+    AllocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer CommandBuffer;
+    vkAllocateCommandBuffers(Upload.Device, &AllocInfo, &CommandBuffer);
+
+    VkCommandBufferBeginInfo BeginInfo{};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+
+    VkImageMemoryBarrier Barrier = GetLevelsBarrier(Image, Header.LevelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &Barrier);
+    vkCmdCopyBufferToImage(CommandBuffer, StagingBuffer, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(Regions.size()), Regions.data());
+    Barrier = GetLevelsBarrier(Image, Header.LevelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &Barrier);
+
+    vkEndCommandBuffer(CommandBuffer);
+
+    VkSubmitInfo SubmitInfo{};
+    SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.commandBufferCount = 1;
+    SubmitInfo.pCommandBuffers = &CommandBuffer;
+
+    if (vkQueueSubmit(Upload.Queue, 1, &SubmitInfo, Upload.Fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to submit texture upload!");
+    }
+
+    vkWaitForFences(Upload.Device, 1, &Upload.Fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(Upload.Device, 1, &Upload.Fence);
+    vkFreeCommandBuffers(Upload.Device, Upload.CommandPool, 1, &CommandBuffer);
+
+    vkDestroyBuffer(Upload.Device, StagingBuffer, nullptr);
+    vkFreeMemory(Upload.Device, StagingMemory, nullptr);
+    DestroyImage(Upload, Image, ImageMemory);
+}
+
+// Stored levels are copied out of the mapping, supercompressed ones are inflated into Inflated first
+static std::vector<VkMemoryToImageCopyEXT> GetHostCopyRegions(const FTextureCache& Texture, std::vector<char>& Inflated)
+{
+    const FTextureCacheHeader& Header = Texture.GetHeader();
+    std::vector<VkMemoryToImageCopyEXT> Regions(Header.LevelCount);
+
+    for (uint32_t i = 0; i < Header.LevelCount; ++i)
+    {
+        const char* Data = Texture.GetStoredLevelData(i);
+
+        if (Data == nullptr)
+        {
+            if (Inflated.empty())
+            {
+                Inflated.resize(Texture.GetDataSize());
+            }
+
+            if (Texture.ReadLevels(i, 1, &Inflated[Texture.GetLevelOffset(i)]) == 0)
+            {
+                throw std::runtime_error("Failed to read cooked texture levels!");
+            }
+
+            Data = &Inflated[Texture.GetLevelOffset(i)];
+        }
+
+        Regions[i].sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT;
+        Regions[i].pHostPointer = Data;
+        Regions[i].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1};
+        Regions[i].imageExtent = {Header.Levels[i].Width, Header.Levels[i].Height, 1};
+    }
+
+    return Regions;
+}
+
+static void CopyLevelsFromHost(const FUploadDevice& Upload, const FTextureCache& Texture, VkImage Image)
+{
+    std::vector<char> Inflated;
+    std::vector<VkMemoryToImageCopyEXT> Regions = GetHostCopyRegions(Texture, Inflated);
+
+    VkHostImageLayoutTransitionInfoEXT Transition{};
+    Transition.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT;
+    Transition.image = Image;
+    Transition.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    Transition.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    Transition.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, Texture.GetHeader().LevelCount, 0, 1};
+
+    VkCopyMemoryToImageInfoEXT CopyInfo{};
+    CopyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT;
+    CopyInfo.dstImage = Image;
+    CopyInfo.dstImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    CopyInfo.regionCount = static_cast<uint32_t>(Regions.size());
+    CopyInfo.pRegions = Regions.data();
+
+    if (Upload.TransitionImageLayoutEXT(Upload.Device, 1, &Transition) != VK_SUCCESS || Upload.CopyMemoryToImageEXT(Upload.Device, &CopyInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to copy memory to image!");
+    }
+}
+
+// The extension's route: the levels are written into the image on this thread, nothing is submitted
+static void UploadFromHost(const FUploadDevice& Upload, const FTextureCache& Texture)
+{
+    VkImage Image;
+    VkDeviceMemory Memory;
+    CreateTextureImage(Upload, Texture, TEXTURE_IMAGE_USAGE | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT, Image, Memory);
+    CopyLevelsFromHost(Upload, Texture, Image);
+    DestroyImage(Upload, Image, Memory);
+}
+
+// Every level copied in from the host has to read back unchanged
+static bool RunRoundTripTest(const FUploadDevice& Upload, const FTextureCache& Texture)
+{
+    const FTextureCacheHeader& Header = Texture.GetHeader();
+
+    VkImage Image;
+    VkDeviceMemory Memory;
+    CreateTextureImage(Upload, Texture, TEXTURE_IMAGE_USAGE | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT, Image, Memory);
+    CopyLevelsFromHost(Upload, Texture, Image);
+
+    std::vector<char> Expected(Texture.GetDataSize());
+    std::vector<char> Read(Texture.GetDataSize());
+    Texture.ReadLevels(0, Header.LevelCount, Expected.data());
+
+    std::vector<VkImageToMemoryCopyEXT> Regions(Header.LevelCount);
+
+    for (uint32_t i = 0; i < Header.LevelCount; ++i)
+    {
+        Regions[i].sType = VK_STRUCTURE_TYPE_IMAGE_TO_MEMORY_COPY_EXT;
+        Regions[i].pHostPointer = &Read[Texture.GetLevelOffset(i)];
+        Regions[i].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1};
+        Regions[i].imageExtent = {Header.Levels[i].Width, Header.Levels[i].Height, 1};
+    }
+
+    VkCopyImageToMemoryInfoEXT CopyInfo{};
+    CopyInfo.sType = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_MEMORY_INFO_EXT;
+    CopyInfo.srcImage = Image;
+    CopyInfo.srcImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    CopyInfo.regionCount = static_cast<uint32_t>(Regions.size());
+    CopyInfo.pRegions = Regions.data();
+
+    bool bPassed = Upload.CopyImageToMemoryEXT(Upload.Device, &CopyInfo) == VK_SUCCESS;
+
+    for (uint32_t i = 0; bPassed && i < Header.LevelCount; ++i)
+    {
+        bPassed = std::memcmp(&Expected[Texture.GetLevelOffset(i)], &Read[Texture.GetLevelOffset(i)], Header.Levels[i].UncompressedSize) == 0;
+    }
+
+    DestroyImage(Upload, Image, Memory);
+
+    return bPassed;
+}
+
+// Whether images that allow host copies are laid out as well for sampling as images that do not
+static bool IsOptimalForDeviceAccess(const FUploadDevice& Upload, VkFormat Format)
+{
+    VkPhysicalDeviceImageFormatInfo2 FormatInfo{};
+    FormatInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2;
+    FormatInfo.format = Format;
+    FormatInfo.type = VK_IMAGE_TYPE_2D;
+    FormatInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    FormatInfo.usage = TEXTURE_IMAGE_USAGE | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+
+    VkHostImageCopyDevicePerformanceQueryEXT PerformanceQuery{};
+    PerformanceQuery.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT;
+
+    VkImageFormatProperties2 FormatProperties{};
+    FormatProperties.sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2;
+    FormatProperties.pNext = &PerformanceQuery;
+
+    return vkGetPhysicalDeviceImageFormatProperties2(Upload.PhysicalDevice, &FormatInfo, &FormatProperties) == VK_SUCCESS && PerformanceQuery.optimalDeviceAccess;
+}
+
+static bool IsSampledFormat(const FUploadDevice& Upload, VkFormat Format)
+{
+    VkFormatProperties Props;
+    vkGetPhysicalDeviceFormatProperties(Upload.PhysicalDevice, Format, &Props);
+    return (Props.optimalTilingFeatures & (VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT)) == (VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT);
+}
+
+template<typename FunctionType>
+static double MeasureBest(FunctionType Function, int Iterations)
+{
+    double Best = 1e30;
+
+    for (int i = 0; i < Iterations; ++i)
+    {
+        auto Start = std::chrono::high_resolution_clock::now();
+        Function();
+        auto End = std::chrono::high_resolution_clock::now();
+
+        Best = std::min(Best, std::chrono::duration<double, std::milli>(End - Start).count());
+    }
+
+    return Best;
+}
+
+// Uploads whole cooked mip chains both ways. Run asset_cooker first, every cooked format of the texture is measured.
+static int RunBenchmark(const std::string& TexturePath, int Iterations)
+{
+    FUploadDevice Upload = CreateUploadDevice();
+
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(Upload.PhysicalDevice, &Properties);
+
+    std::cout << "Device:                " << Properties.deviceName << (Upload.bHostImageCopySupported ? "" : ", no host image copy") << std::endl;
+
+    int Measured = 0;
+
+    for (const auto& Info : COOKED_TEXTURE_FORMATS)
+    {
+        FTextureCache Texture;
+
+        if (!Texture.Open(GetCookedTexturePath(TexturePath, Info)) || !IsSampledFormat(Upload, Info.Format))
+        {
+            continue;
+        }
+
+        Texture.Prefault();
+
+        const FTextureCacheHeader& Header = Texture.GetHeader();
+        double Megabytes = static_cast<double>(Texture.GetDataSize()) / (1 << 20);
+        std::string Name = std::string(IsBlockCompressedFormat(Info) ? Info.Extension + 1 : "rgba8") + (Texture.IsSupercompressed() ? " lz" : "");
+
+        std::cout << Name << ":" << std::string(Name.size() < 22 ? 22 - Name.size() : 1, ' ') << Header.Width << "x" << Header.Height << ", " << Header.LevelCount
+                  << " mip levels, " << Texture.GetDataSize() << " bytes" << std::endl;
+
+        double StagingTime = MeasureBest([&]() { UploadThroughStaging(Upload, Texture); }, Iterations);
+        std::cout << "  Staging buffer:      " << StagingTime << " ms, " << Megabytes / StagingTime * 1e3 << " MB/s" << std::endl;
+
+        if (Upload.bHostImageCopySupported)
+        {
+            if (!RunRoundTripTest(Upload, Texture))
+            {
+                std::cerr << "Host image copy of " << Name << " did not read back unchanged" << std::endl;
+                DestroyUploadDevice(Upload);
+                return EXIT_FAILURE;
+            }
+
+            double HostTime = MeasureBest([&]() { UploadFromHost(Upload, Texture); }, Iterations);
+            std::cout << "  Host image copy:     " << HostTime << " ms, " << Megabytes / HostTime * 1e3 << " MB/s"
+                      << (IsOptimalForDeviceAccess(Upload, Info.Format) ? "" : ", not optimal for device access, the application stages it") << std::endl;
+        }
+
+        ++Measured;
+    }
+
+    DestroyUploadDevice(Upload);
+
+    if (Measured == 0)
+    {
+        std::cerr << "No cooked texture of " << TexturePath << " the device can sample, run asset_cooker" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+    std::string TexturePath = argc > 1 ? argv[1] : "models/viking_room/viking_room.png";
+    int Iterations = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    try
+    {
+        return RunBenchmark(TexturePath, Iterations);
+    }
+    catch (const std::exception& Error)
+    {
+        std::cerr << Error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,150 @@
+#include "main.h"
+#include "index_tuple_map.h"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FBenchmarkVertex
+{
+    FVector3 Pos;
+    FVector3 Color;
+    FVector2 TexCoord;
+
+    bool operator==(const FBenchmarkVertex& Other) const
+    {
+        return Pos == Other.Pos && Color == Other.Color && TexCoord == Other.TexCoord;
+    }
+};
+
+template<> struct std::hash<FBenchmarkVertex>
+{
+    size_t operator()(FBenchmarkVertex const& Vertex) const
+    {
+        return ((std::hash<FVector3>()(Vertex.Pos) ^
+                (std::hash<FVector3>()(Vertex.Color) << 1)) >> 1) ^
+                (std::hash<FVector2>()(Vertex.TexCoord) << 1);
+    }
+};
+
+static FBenchmarkVertex MakeVertex(const tinyobj::attrib_t& Attrib, const tinyobj::index_t& Index)
+{
+    FBenchmarkVertex Vert{};
+    Vert.Pos = {Attrib.vertices[3 * Index.vertex_index + 0], Attrib.vertices[3 * Index.vertex_index + 1], Attrib.vertices[3 * Index.vertex_index + 2]};
+    Vert.TexCoord = {Attrib.texcoords[2 * Index.texcoord_index + 0], 1.f - Attrib.texcoords[2 * Index.texcoord_index + 1]};
+    Vert.Color = {1.f, 1.f, 1.f};
+    return Vert;
+}
+
+static void DeduplicateWithUnorderedMap(const tinyobj::attrib_t& Attrib, const std::vector<tinyobj::shape_t>& Shapes, std::vector<FBenchmarkVertex>& Vertices, std::vector<uint32_t>& Indices)
+{
+    std::unordered_map<FBenchmarkVertex, uint32_t> UniqueVertices{};
+
+    for (const auto& Shape : Shapes)
+    {
+        for (const auto& Index : Shape.mesh.indices)
+        {
+            FBenchmarkVertex Vert = MakeVertex(Attrib, Index);
+
+            if (UniqueVertices.find(Vert) == UniqueVertices.end())
+            {
+                UniqueVertices[Vert] = static_cast<uint32_t>(Vertices.size());
+                Vertices.push_back(Vert);
+            }
+
+            Indices.push_back(UniqueVertices[Vert]);
+        }
+    }
+}
+
+static void DeduplicateWithIndexTupleMap(const tinyobj::attrib_t& Attrib, const std::vector<tinyobj::shape_t>& Shapes, std::vector<FBenchmarkVertex>& Vertices, std::vector<uint32_t>& Indices)
+{
+    std::size_t CornerCount = 0;
+
+    for (const auto& Shape : Shapes)
+    {
+        CornerCount += Shape.mesh.indices.size();
+    }
+
+    auto PositionIndices = BuildCanonicalIndices(Attrib.vertices, 3);
+    auto TexCoordIndices = BuildCanonicalIndices(Attrib.texcoords, 2);
+
+    FIndexTupleMap UniqueVertices(CornerCount);
+    Indices.reserve(CornerCount);
+
+    for (const auto& Shape : Shapes)
+    {
+        for (const auto& Index : Shape.mesh.indices)
+        {
+            auto Result = UniqueVertices.FindOrInsert({PositionIndices[Index.vertex_index], -1, TexCoordIndices[Index.texcoord_index]}, static_cast<uint32_t>(Vertices.size()));
+
+            if (Result.second)
+            {
+                Vertices.push_back(MakeVertex(Attrib, Index));
+            }
+
+            Indices.push_back(Result.first);
+        }
+    }
+}
+
+template<typename FunctionType>
+static double Measure(FunctionType Function, int Iterations, const tinyobj::attrib_t& Attrib, const std::vector<tinyobj::shape_t>& Shapes, std::vector<FBenchmarkVertex>& Vertices, std::vector<uint32_t>& Indices)
+{
+    double Best = 1e30;
+
+    for (int i = 0; i < Iterations; ++i)
+    {
+        Vertices.clear();
+        Indices.clear();
+
+        auto Start = std::chrono::high_resolution_clock::now();
+        Function(Attrib, Shapes, Vertices, Indices);
+        auto End = std::chrono::high_resolution_clock::now();
+
+        Best = std::min(Best, std::chrono::duration<double, std::milli>(End - Start).count());
+    }
+
+    return Best;
+}
+
+int main(int argc, char** argv)
+{
+    std::string ModelPath = argc > 1 ? argv[1] : "models/viking_room/viking_room.obj";
+    int Iterations = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    tinyobj::attrib_t Attrib;
+    std::vector<tinyobj::shape_t> Shapes;
+    std::vector<tinyobj::material_t> Materials;
+    std::string Warn, Err;
+
+    if (!tinyobj::LoadObj(&Attrib, &Shapes, &Materials, &Warn, &Err, ModelPath.c_str()))
+    {
+        std::cerr << Warn << Err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<FBenchmarkVertex> MapVertices, TupleVertices;
+    std::vector<uint32_t> MapIndices, TupleIndices;
+
+    double MapTime = Measure(DeduplicateWithUnorderedMap, Iterations, Attrib, Shapes, MapVertices, MapIndices);
+    double TupleTime = Measure(DeduplicateWithIndexTupleMap, Iterations, Attrib, Shapes, TupleVertices, TupleIndices);
+
+    if (MapVertices.size() != TupleVertices.size() || MapIndices != TupleIndices)
+    {
+        std::cerr << "Deduplicated meshes differ" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Corners:               " << MapIndices.size() << std::endl;
+    std::cout << "std::unordered_map:    " << MapTime << " ms, " << MapVertices.size() << " vertices" << std::endl;
+    std::cout << "FIndexTupleMap:        " << TupleTime << " ms, " << TupleVertices.size() << " vertices" << std::endl;
+    std::cout << "Speedup:               " << MapTime / TupleTime << "x" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,582 @@
+#pragma once
+
+#include "mip_generator.h"
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+enum class EBlockFormat
+{
+    Bc1,
+    Bc3,
+    Bc7
+};
+
+// Fast takes endpoints from the bounding box, Normal fits them to the principal axis and refines them once
+// with least squares, High keeps refining while the error drops
+enum class ECompressionQuality
+{
+    Fast,
+    Normal,
+    High
+};
+
+// Part of every cooked compressed texture's hash, bump it when the encoder output changes
+const uint32_t BLOCK_COMPRESSOR_VERSION = 1;
+const int BLOCK_COMPRESSOR_HIGH_PASSES = 4;
+const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+const float BC1_WEIGHTS[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+
+// 4x4 RGBA texels of one block, sRGB encoded like the hardware interpolates them
+struct FColorBlock
+{
+    float Texels[16][4];
+};
+
+static int GetRefinementPasses(ECompressionQuality Quality)
+{
+    return Quality == ECompressionQuality::Fast ? 0 : Quality == ECompressionQuality::Normal ? 1 : BLOCK_COMPRESSOR_HIGH_PASSES;
+}
+
+// Blocks hanging over the edge of a level repeat its last row and column
+static void LoadColorBlock(const FTextureMip& Mip, uint32_t BlockX, uint32_t BlockY, FColorBlock& Block)
+{
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        uint32_t x = std::min(BlockX * 4 + i % 4, Mip.Width - 1);
+        uint32_t y = std::min(BlockY * 4 + i / 4, Mip.Height - 1);
+        const uint8_t* Texel = &Mip.Data[(static_cast<std::size_t>(y) * Mip.Width + x) * 4];
+
+        for (int c = 0; c < 4; ++c)
+        {
+            Block.Texels[i][c] = Texel[c];
+        }
+    }
+}
+
+static float GetSquaredDistance(const float* A, const float* B, int Channels)
+{
+    float Distance = 0.f;
+
+    for (int c = 0; c < Channels; ++c)
+    {
+        Distance += (A[c] - B[c]) * (A[c] - B[c]);
+    }
+
+    return Distance;
+}
+
+static void FitEndpoints(const FColorBlock& Block, int Channels, ECompressionQuality Quality, float Start[4], float End[4])
+{
+    float Mean[4] = {};
+    float Min[4] = {255.f, 255.f, 255.f, 255.f};
+    float Max[4] = {};
+
+    for (const auto& Texel : Block.Texels)
+    {
+        for (int c = 0; c < Channels; ++c)
+        {
+            Mean[c] += Texel[c] / 16.f;
+            Min[c] = std::min(Min[c], Texel[c]);
+            Max[c] = std::max(Max[c], Texel[c]);
+        }
+    }
+
+    if (Quality == ECompressionQuality::Fast)
+    {
+        for (int c = 0; c < Channels; ++c)
+        {
+            float Inset = (Max[c] - Min[c]) / 16.f;
+            Start[c] = Min[c] + Inset;
+            End[c] = Max[c] - Inset;
+        }
+
+        return;
+    }
+
+    float Covariance[4][4] = {};
+
+    for (const auto& Texel : Block.Texels)
+    {
+        for (int a = 0; a < Channels; ++a)
+        {
+            for (int b = 0; b < Channels; ++b)
+            {
+                Covariance[a][b] += (Texel[a] - Mean[a]) * (Texel[b] - Mean[b]);
+            }
+        }
+    }
+
+    // Power iteration from the covariance column of the channel that varies most
+    int Widest = 0;
+
+    for (int c = 1; c < Channels; ++c)
+    {
+        Widest = Covariance[c][c] > Covariance[Widest][Widest] ? c : Widest;
+    }
+
+    float Axis[4] = {};
+
+    for (int c = 0; c < Channels; ++c)
+    {
+        Axis[c] = Covariance[c][Widest];
+    }
+
+    for (int Iteration = 0; Iteration < 8; ++Iteration)
+    {
+        float Next[4] = {};
+        float Scale = 0.f;
+
+        for (int a = 0; a < Channels; ++a)
+        {
+            for (int b = 0; b < Channels; ++b)
+            {
+                Next[a] += Covariance[a][b] * Axis[b];
+            }
+
+            Scale = std::max(Scale, std::abs(Next[a]));
+        }
+
+        if (Scale < 1e-6f)
+        {
+            break;
+        }
+
+        for (int c = 0; c < Channels; ++c)
+        {
+            Axis[c] = Next[c] / Scale;
+        }
+    }
+
+    float LengthSquared = 0.f;
+
+    for (int c = 0; c < Channels; ++c)
+    {
+        LengthSquared += Axis[c] * Axis[c];
+    }
+
+    float MinProjection = 0.f;
+    float MaxProjection = 0.f;
+
+    if (LengthSquared > 1e-6f)
+    {
+        MinProjection = std::numeric_limits<float>::max();
+        MaxProjection = std::numeric_limits<float>::lowest();
+
+        for (const auto& Texel : Block.Texels)
+        {
+            float Projection = 0.f;
+
+            for (int c = 0; c < Channels; ++c)
+            {
+                Projection += (Texel[c] - Mean[c]) * Axis[c];
+            }
+
+            MinProjection = std::min(MinProjection, Projection / LengthSquared);
+            MaxProjection = std::max(MaxProjection, Projection / LengthSquared);
+        }
+    }
+
+    for (int c = 0; c < Channels; ++c)
+    {
+        Start[c] = std::min(std::max(Mean[c] + MinProjection * Axis[c], 0.f), 255.f);
+        End[c] = std::min(std::max(Mean[c] + MaxProjection * Axis[c], 0.f), 255.f);
+    }
+}
+
+// Least squares endpoints for the palette weights the texels were assigned, false if they do not pin the endpoints down
+static bool SolveEndpoints(const FColorBlock& Block, int Channels, const float Weights[16], float Start[4], float End[4])
+{
+    float AA = 0.f, AB = 0.f, BB = 0.f;
+    float AX[4] = {};
+    float BX[4] = {};
+
+    for (int i = 0; i < 16; ++i)
+    {
+        float A = 1.f - Weights[i];
+        float B = Weights[i];
+        AA += A * A;
+        AB += A * B;
+        BB += B * B;
+
+        for (int c = 0; c < Channels; ++c)
+        {
+            AX[c] += A * Block.Texels[i][c];
+            BX[c] += B * Block.Texels[i][c];
+        }
+    }
+
+    float Determinant = AA * BB - AB * AB;
+
+    if (std::abs(Determinant) < 1e-6f)
+    {
+        return false;
+    }
+
+    for (int c = 0; c < Channels; ++c)
+    {
+        Start[c] = std::min(std::max((AX[c] * BB - BX[c] * AB) / Determinant, 0.f), 255.f);
+        End[c] = std::min(std::max((BX[c] * AA - AX[c] * AB) / Determinant, 0.f), 255.f);
+    }
+
+    return true;
+}
+
+static uint16_t PackRgb565(const float Color[4])
+{
+    auto Quantize = [](float Value, int Max) { return static_cast<uint16_t>(std::lround(std::min(std::max(Value, 0.f), 255.f) * Max / 255.f)); };
+    return static_cast<uint16_t>(Quantize(Color[0], 31) << 11 | Quantize(Color[1], 63) << 5 | Quantize(Color[2], 31));
+}
+
+static void UnpackRgb565(uint16_t Packed, int Color[3])
+{
+    int R = Packed >> 11, G = (Packed >> 5) & 63, B = Packed & 31;
+    Color[0] = R << 3 | R >> 2;
+    Color[1] = G << 2 | G >> 4;
+    Color[2] = B << 3 | B >> 2;
+}
+
+// Color half of BC1 and BC3, always in the four color mode
+static float EncodeBc1Block(const FColorBlock& Block, ECompressionQuality Quality, uint8_t* Output)
+{
+    float Start[4], End[4];
+    FitEndpoints(Block, 3, Quality, Start, End);
+
+    float BestError = std::numeric_limits<float>::max();
+
+    for (int Pass = 0; Pass <= GetRefinementPasses(Quality); ++Pass)
+    {
+        uint16_t Color0 = PackRgb565(Start);
+        uint16_t Color1 = PackRgb565(End);
+
+        if (Color0 < Color1)
+        {
+            std::swap(Color0, Color1);
+        }
+
+        int Endpoints[2][3];
+        UnpackRgb565(Color0, Endpoints[0]);
+        UnpackRgb565(Color1, Endpoints[1]);
+
+        float Palette[4][4] = {};
+
+        for (int c = 0; c < 3; ++c)
+        {
+            Palette[0][c] = static_cast<float>(Endpoints[0][c]);
+            Palette[1][c] = static_cast<float>(Endpoints[1][c]);
+            Palette[2][c] = static_cast<float>((2 * Endpoints[0][c] + Endpoints[1][c]) / 3);
+            Palette[3][c] = static_cast<float>((Endpoints[0][c] + 2 * Endpoints[1][c]) / 3);
+        }
+
+        // Equal endpoints would switch the block to the three color mode, every texel takes the first color then
+        int PaletteSize = Color0 == Color1 ? 1 : 4;
+        uint32_t Indices = 0;
+        float Weights[16];
+        float Error = 0.f;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int Index = 0;
+            float IndexError = GetSquaredDistance(Block.Texels[i], Palette[0], 3);
+
+            for (int p = 1; p < PaletteSize; ++p)
+            {
+                float Distance = GetSquaredDistance(Block.Texels[i], Palette[p], 3);
+
+                if (Distance < IndexError)
+                {
+                    Index = p;
+                    IndexError = Distance;
+                }
+            }
+
+            Indices |= static_cast<uint32_t>(Index) << (i * 2);
+            Weights[i] = BC1_WEIGHTS[Index];
+            Error += IndexError;
+        }
+
+        if (Error < BestError)
+        {
+            BestError = Error;
+            const uint32_t Words[2] = {static_cast<uint32_t>(Color0) | static_cast<uint32_t>(Color1) << 16, Indices};
+
+            for (int b = 0; b < 8; ++b)
+            {
+                Output[b] = static_cast<uint8_t>(Words[b / 4] >> (b % 4 * 8));
+            }
+        }
+
+        if (PaletteSize == 1 || !SolveEndpoints(Block, 3, Weights, Start, End))
+        {
+            break;
+        }
+    }
+
+    return BestError;
+}
+
+// Alpha half of BC3 in the eight value mode, spanning the block's alpha range
+static float EncodeBc3AlphaBlock(const FColorBlock& Block, uint8_t* Output)
+{
+    int Min = 255, Max = 0;
+
+    for (const auto& Texel : Block.Texels)
+    {
+        Min = std::min(Min, static_cast<int>(Texel[3]));
+        Max = std::max(Max, static_cast<int>(Texel[3]));
+    }
+
+    int Palette[8] = {Max, Min};
+
+    for (int k = 2; k < 8; ++k)
+    {
+        Palette[k] = ((8 - k) * Max + (k - 1) * Min + 3) / 7;
+    }
+
+    uint64_t Indices = 0;
+    float Error = 0.f;
+
+    for (int i = 0; i < 16 && Max != Min; ++i)
+    {
+        int Index = 0;
+
+        for (int k = 1; k < 8; ++k)
+        {
+            if (std::abs(Palette[k] - Block.Texels[i][3]) < std::abs(Palette[Index] - Block.Texels[i][3]))
+            {
+                Index = k;
+            }
+        }
+
+        Indices |= static_cast<uint64_t>(Index) << (i * 3);
+        Error += (Palette[Index] - Block.Texels[i][3]) * (Palette[Index] - Block.Texels[i][3]);
+    }
+
+    Output[0] = static_cast<uint8_t>(Max);
+    Output[1] = static_cast<uint8_t>(Min);
+
+    for (int b = 0; b < 6; ++b)
+    {
+        Output[2 + b] = static_cast<uint8_t>(Indices >> (b * 8));
+    }
+
+    return Error;
+}
+
+static float EncodeBc3Block(const FColorBlock& Block, ECompressionQuality Quality, uint8_t* Output)
+{
+    return EncodeBc3AlphaBlock(Block, Output) + EncodeBc1Block(Block, Quality, Output + 8);
+}
+
+// Seven bits per channel plus a shared lowest bit per endpoint, whichever lowest bit lands closer
+static void QuantizeBc7Endpoint(const float Color[4], uint8_t Quantized[4], uint8_t& PBit, int Expanded[4])
+{
+    float BestError = std::numeric_limits<float>::max();
+
+    for (int Bit = 0; Bit < 2; ++Bit)
+    {
+        uint8_t Candidate[4];
+        float Error = 0.f;
+
+        for (int c = 0; c < 4; ++c)
+        {
+            Candidate[c] = static_cast<uint8_t>(std::min(std::max(std::lround((Color[c] - Bit) / 2.f), 0L), 127L));
+            float Value = static_cast<float>(Candidate[c] << 1 | Bit);
+            Error += (Value - Color[c]) * (Value - Color[c]);
+        }
+
+        if (Error < BestError)
+        {
+            BestError = Error;
+            PBit = static_cast<uint8_t>(Bit);
+
+            for (int c = 0; c < 4; ++c)
+            {
+                Quantized[c] = Candidate[c];
+                Expanded[c] = Candidate[c] << 1 | Bit;
+            }
+        }
+    }
+}
+
+static void WriteBlockBits(uint8_t* Output, int& Offset, uint32_t Value, int Count)
+{
+    for (int b = 0; b < Count; ++b, ++Offset)
+    {
+        Output[Offset / 8] |= static_cast<uint8_t>(((Value >> b) & 1) << (Offset % 8));
+    }
+}
+
+// Mode 6: one RGBA subset with 4 bit indices. The first texel's index loses its top bit, so the endpoints are
+// swapped whenever that bit would be set.
+static void WriteBc7Mode6Block(uint8_t Quantized[2][4], uint8_t PBits[2], uint8_t Indices[16], uint8_t* Output)
+{
+    if (Indices[0] >= 8)
+    {
+        std::swap(Quantized[0], Quantized[1]);
+        std::swap(PBits[0], PBits[1]);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            Indices[i] = static_cast<uint8_t>(15 - Indices[i]);
+        }
+    }
+
+    std::fill(Output, Output + 16, uint8_t{0});
+    int Offset = 0;
+
+    WriteBlockBits(Output, Offset, 1u << 6, 7);
+
+    for (int c = 0; c < 4; ++c)
+    {
+        WriteBlockBits(Output, Offset, Quantized[0][c], 7);
+        WriteBlockBits(Output, Offset, Quantized[1][c], 7);
+    }
+
+    WriteBlockBits(Output, Offset, PBits[0], 1);
+    WriteBlockBits(Output, Offset, PBits[1], 1);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        WriteBlockBits(Output, Offset, Indices[i], i == 0 ? 3 : 4);
+    }
+}
+
+static float EncodeBc7Block(const FColorBlock& Block, ECompressionQuality Quality, uint8_t* Output)
+{
+    float Start[4], End[4];
+    FitEndpoints(Block, 4, Quality, Start, End);
+
+    float BestError = std::numeric_limits<float>::max();
+
+    for (int Pass = 0; Pass <= GetRefinementPasses(Quality); ++Pass)
+    {
+        uint8_t Quantized[2][4];
+        uint8_t PBits[2];
+        int Endpoints[2][4];
+        QuantizeBc7Endpoint(Start, Quantized[0], PBits[0], Endpoints[0]);
+        QuantizeBc7Endpoint(End, Quantized[1], PBits[1], Endpoints[1]);
+
+        float Palette[16][4];
+
+        for (int p = 0; p < 16; ++p)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                Palette[p][c] = static_cast<float>(((64 - BC7_WEIGHTS[p]) * Endpoints[0][c] + BC7_WEIGHTS[p] * Endpoints[1][c] + 32) >> 6);
+            }
+        }
+
+        uint8_t Indices[16];
+        float Weights[16];
+        float Error = 0.f;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int Index = 0;
+            float IndexError = GetSquaredDistance(Block.Texels[i], Palette[0], 4);
+
+            for (int p = 1; p < 16; ++p)
+            {
+                float Distance = GetSquaredDistance(Block.Texels[i], Palette[p], 4);
+
+                if (Distance < IndexError)
+                {
+                    Index = p;
+                    IndexError = Distance;
+                }
+            }
+
+            Indices[i] = static_cast<uint8_t>(Index);
+            Weights[i] = BC7_WEIGHTS[Index] / 64.f;
+            Error += IndexError;
+        }
+
+        if (Error < BestError)
+        {
+            BestError = Error;
+            WriteBc7Mode6Block(Quantized, PBits, Indices, Output);
+        }
+
+        if (!SolveEndpoints(Block, 4, Weights, Start, End))
+        {
+            break;
+        }
+    }
+
+    return BestError;
+}
+
+static uint32_t GetBlockFormatSize(EBlockFormat Format)
+{
+    return Format == EBlockFormat::Bc1 ? 8 : 16;
+}
+
+// Rows of blocks are spread over threads like the mip generator spreads rows of texels
+static FTextureMip CompressTextureMip(const FTextureMip& Mip, EBlockFormat Format, ECompressionQuality Quality)
+{
+    uint32_t BlocksX = (Mip.Width + 3) / 4;
+    uint32_t BlocksY = (Mip.Height + 3) / 4;
+    uint32_t BlockSize = GetBlockFormatSize(Format);
+
+    FTextureMip Compressed{Mip.Width, Mip.Height, std::vector<uint8_t>(static_cast<std::size_t>(BlocksX) * BlocksY * BlockSize)};
+
+    ParallelForRows(BlocksY, static_cast<std::size_t>(BlocksX) * 16, [&](uint32_t FirstRow, uint32_t EndRow)
+    {
+        FColorBlock Block;
+
+        for (uint32_t y = FirstRow; y < EndRow; ++y)
+        {
+            for (uint32_t x = 0; x < BlocksX; ++x)
+            {
+                LoadColorBlock(Mip, x, y, Block);
+                uint8_t* Output = &Compressed.Data[(static_cast<std::size_t>(y) * BlocksX + x) * BlockSize];
+
+                switch (Format)
+                {
+                case EBlockFormat::Bc1:
+                    EncodeBc1Block(Block, Quality, Output);
+                    break;
+                case EBlockFormat::Bc3:
+                    EncodeBc3Block(Block, Quality, Output);
+                    break;
+                case EBlockFormat::Bc7:
+                    EncodeBc7Block(Block, Quality, Output);
+                    break;
+                }
+            }
+        }
+    });
+
+    return Compressed;
+}
+
+static std::vector<FTextureMip> CompressMipChain(const std::vector<FTextureMip>& Mips, EBlockFormat Format, ECompressionQuality Quality)
+{
+    std::vector<FTextureMip> Compressed;
+    Compressed.reserve(Mips.size());
+
+    for (const auto& Mip : Mips)
+    {
+        Compressed.push_back(CompressTextureMip(Mip, Format, Quality));
+    }
+
+    return Compressed;
+}
+
+static bool HasTranslucentTexels(const FTextureMip& Mip)
+{
+    for (std::size_t i = 3; i < Mip.Data.size(); i += 4)
+    {
+        if (Mip.Data[i] != 255)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+const std::string COOKED_ASSET_DIRECTORY = "cooked";
+
+// Cooked assets mirror the source tree under COOKED_ASSET_DIRECTORY, with the cache extension appended to the source file name
+static std::string GetCookedAssetPath(const std::string& SourcePath, const std::string& Extension)
+{
+    std::filesystem::path Source = std::filesystem::path(SourcePath).lexically_normal().relative_path();
+    return (std::filesystem::path(COOKED_ASSET_DIRECTORY) / Source).generic_string() + Extension;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+struct FIndexTuple
+{
+    int VertexIndex;
+    int NormalIndex;
+    int TexCoordIndex;
+
+    bool operator==(const FIndexTuple& Other) const
+    {
+        return VertexIndex == Other.VertexIndex && NormalIndex == Other.NormalIndex && TexCoordIndex == Other.TexCoordIndex;
+    }
+};
+
+class FIndexTupleMap
+{
+public:
+    explicit FIndexTupleMap(std::size_t ExpectedCount)
+    {
+        std::size_t Capacity = 16;
+
+        while (Capacity < ExpectedCount * 2)
+        {
+            Capacity *= 2;
+        }
+
+        Slots.resize(Capacity);
+        Mask = Capacity - 1;
+    }
+
+    std::pair<uint32_t, bool> FindOrInsert(const FIndexTuple& Key, uint32_t Value)
+    {
+        if ((Count + 1) * 2 > Slots.size())
+        {
+            Grow();
+        }
+
+        std::size_t Index = Hash(Key) & Mask;
+
+        while (Slots[Index].bOccupied)
+        {
+            if (Slots[Index].Key == Key)
+            {
+                return {Slots[Index].Value, false};
+            }
+
+            Index = (Index + 1) & Mask;
+        }
+
+        Slots[Index].Key = Key;
+        Slots[Index].Value = Value;
+        Slots[Index].bOccupied = true;
+        ++Count;
+
+        return {Value, true};
+    }
+
+    std::size_t Size() const
+    {
+        return Count;
+    }
+
+private:
+    struct FSlot
+    {
+        FIndexTuple Key;
+        uint32_t Value;
+        bool bOccupied = false;
+    };
+
+    static std::size_t Hash(const FIndexTuple& Key)
+    {
+        uint64_t H = static_cast<uint32_t>(Key.VertexIndex);
+        H = H * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(Key.TexCoordIndex);
+        H = H * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(Key.NormalIndex);
+        H ^= H >> 32;
+        H *= 0xD6E8FEB86659FD93ull;
+        H ^= H >> 32;
+
+        return static_cast<std::size_t>(H);
+    }
+
+    void Grow()
+    {
+        std::vector<FSlot> OldSlots(Slots.size() * 2);
+        OldSlots.swap(Slots);
+        Mask = Slots.size() - 1;
+
+        for (const auto& Slot : OldSlots)
+        {
+            if (!Slot.bOccupied)
+            {
+                continue;
+            }
+
+            std::size_t Index = Hash(Slot.Key) & Mask;
+
+            while (Slots[Index].bOccupied)
+            {
+                Index = (Index + 1) & Mask;
+            }
+
+            Slots[Index] = Slot;
+        }
+    }
+
+    std::vector<FSlot> Slots;
+    std::size_t Mask = 0;
+    std::size_t Count = 0;
+};
+
+static int FloatBits(float Value)
+{
+    Value += 0.f;
+    int Bits;
+    std::memcpy(&Bits, &Value, sizeof(Bits));
+    return Bits;
+}
+
+static std::vector<int> BuildCanonicalIndices(const std::vector<float>& Values, int Components)
+{
+    std::size_t ElementCount = Values.size() / Components;
+    std::vector<int> CanonicalIndices(ElementCount);
+    FIndexTupleMap UniqueElements(ElementCount);
+
+    for (std::size_t i = 0; i < ElementCount; ++i)
+    {
+        const float* Element = &Values[i * Components];
+        FIndexTuple Key{FloatBits(Element[0]), Components > 1 ? FloatBits(Element[1]) : 0, Components > 2 ? FloatBits(Element[2]) : 0};
+        CanonicalIndices[i] = static_cast<int>(UniqueElements.FindOrInsert(Key, static_cast<uint32_t>(i)).first);
+    }
+
+    return CanonicalIndices;
+}
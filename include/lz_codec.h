@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Byte oriented LZ77 in the LZ4 block format: a token with literal and match length nibbles, the literals, a
+// 16 bit little endian match offset and length extension bytes. The last sequence only carries literals.
+const std::size_t LZ_MIN_MATCH = 4;
+const std::size_t LZ_MAX_OFFSET = 65535;
+const std::size_t LZ_END_LITERALS = 5;
+const std::size_t LZ_LAST_MATCH_DISTANCE = 12;
+const uint32_t LZ_HASH_BITS = 16;
+
+static uint32_t ReadLzWord(const uint8_t* Data)
+{
+    uint32_t Word;
+    std::memcpy(&Word, Data, sizeof(Word));
+    return Word;
+}
+
+static void WriteLzLength(std::vector<uint8_t>& Output, std::size_t Length)
+{
+    for (; Length >= 255; Length -= 255)
+    {
+        Output.push_back(255);
+    }
+
+    Output.push_back(static_cast<uint8_t>(Length));
+}
+
+static void WriteLzSequence(std::vector<uint8_t>& Output, const uint8_t* Literals, std::size_t LiteralCount, std::size_t Offset, std::size_t MatchLength)
+{
+    std::size_t MatchCode = MatchLength >= LZ_MIN_MATCH ? MatchLength - LZ_MIN_MATCH : 0;
+    Output.push_back(static_cast<uint8_t>(std::min<std::size_t>(LiteralCount, 15) << 4 | std::min<std::size_t>(MatchCode, 15)));
+
+    if (LiteralCount >= 15)
+    {
+        WriteLzLength(Output, LiteralCount - 15);
+    }
+
+    Output.insert(Output.end(), Literals, Literals + LiteralCount);
+
+    if (MatchLength == 0)
+    {
+        return;
+    }
+
+    Output.push_back(static_cast<uint8_t>(Offset));
+    Output.push_back(static_cast<uint8_t>(Offset >> 8));
+
+    if (MatchCode >= 15)
+    {
+        WriteLzLength(Output, MatchCode - 15);
+    }
+}
+
+// Greedy single probe hash matching, fast enough to run on every cooked level
+static std::vector<uint8_t> CompressLz(const uint8_t* Data, std::size_t Size)
+{
+    std::vector<uint8_t> Output;
+    Output.reserve(Size / 2 + 16);
+
+    std::vector<uint32_t> Table(std::size_t{1} << LZ_HASH_BITS, UINT32_MAX);
+    std::size_t Anchor = 0;
+
+    for (std::size_t i = 0; Size >= LZ_LAST_MATCH_DISTANCE && i + LZ_LAST_MATCH_DISTANCE <= Size;)
+    {
+        uint32_t Word = ReadLzWord(Data + i);
+        uint32_t& Entry = Table[(Word * 2654435761u) >> (32 - LZ_HASH_BITS)];
+        std::size_t Candidate = Entry;
+        Entry = static_cast<uint32_t>(i);
+
+        if (Candidate == UINT32_MAX || i - Candidate > LZ_MAX_OFFSET || ReadLzWord(Data + Candidate) != Word)
+        {
+            ++i;
+            continue;
+        }
+
+        std::size_t Length = LZ_MIN_MATCH;
+
+        while (i + Length < Size - LZ_END_LITERALS && Data[Candidate + Length] == Data[i + Length])
+        {
+            ++Length;
+        }
+
+        WriteLzSequence(Output, Data + Anchor, i - Anchor, i - Candidate, Length);
+        i += Length;
+        Anchor = i;
+    }
+
+    WriteLzSequence(Output, Data + Anchor, Size - Anchor, 0, 0);
+
+    return Output;
+}
+
+// Fails on anything that would read or write out of bounds, or that does not fill the destination exactly
+static bool DecompressLz(const uint8_t* Source, std::size_t SourceSize, uint8_t* Destination, std::size_t DestinationSize)
+{
+    const uint8_t* SourceEnd = Source + SourceSize;
+    uint8_t* Output = Destination;
+    uint8_t* OutputEnd = Destination + DestinationSize;
+
+    auto ReadLength = [&](std::size_t& Length)
+    {
+        uint8_t Byte;
+
+        do
+        {
+            if (Source == SourceEnd)
+            {
+                return false;
+            }
+
+            Byte = *Source++;
+            Length += Byte;
+        } while (Byte == 255);
+
+        return true;
+    };
+
+    while (Source < SourceEnd)
+    {
+        uint8_t Token = *Source++;
+        std::size_t LiteralCount = Token >> 4;
+
+        if ((LiteralCount == 15 && !ReadLength(LiteralCount)) ||
+            LiteralCount > static_cast<std::size_t>(SourceEnd - Source) || LiteralCount > static_cast<std::size_t>(OutputEnd - Output))
+        {
+            return false;
+        }
+
+        if (LiteralCount > 0)
+        {
+            std::memcpy(Output, Source, LiteralCount);
+        }
+
+        Source += LiteralCount;
+        Output += LiteralCount;
+
+        if (Source == SourceEnd)
+        {
+            break;
+        }
+
+        if (SourceEnd - Source < 2)
+        {
+            return false;
+        }
+
+        std::size_t Offset = Source[0] | static_cast<std::size_t>(Source[1]) << 8;
+        Source += 2;
+
+        std::size_t MatchLength = Token & 15;
+
+        if (Offset == 0 || Offset > static_cast<std::size_t>(Output - Destination) || (MatchLength == 15 && !ReadLength(MatchLength)))
+        {
+            return false;
+        }
+
+        MatchLength += LZ_MIN_MATCH;
+
+        if (MatchLength > static_cast<std::size_t>(OutputEnd - Output))
+        {
+            return false;
+        }
+
+        const uint8_t* Match = Output - Offset;
+
+        if (Offset >= MatchLength)
+        {
+            std::memcpy(Output, Match, MatchLength);
+            Output += MatchLength;
+        }
+        else
+        {
+            for (std::size_t i = 0; i < MatchLength; ++i)
+            {
+                *Output++ = Match[i];
+            }
+        }
+    }
+
+    return Output == OutputEnd;
+}
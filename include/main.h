@@ -2,10 +2,25 @@
 
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <stdexcept>
 #include <functional>
 #include <iostream>
 
+static std::uint64_t HashBytes(const void* Data, std::size_t Size)
+{
+    const auto* Bytes = static_cast<const unsigned char*>(Data);
+    std::uint64_t Hash = 14695981039346656037ull;
+
+    for (std::size_t i = 0; i < Size; ++i)
+    {
+        Hash ^= Bytes[i];
+        Hash *= 1099511628211ull;
+    }
+
+    return Hash;
+}
+
 struct FVector4
 {
 public:
@@ -114,6 +129,22 @@ public:
     std::array<FVector4, 4> Data;
 };
 
+FMatrix4 operator*(const FMatrix4& L, const FMatrix4& R)
+{
+    FMatrix4 Result;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const FVector4& C = R.Data[i];
+        Result.Data[i].X = L.Data[0].X * C.X + L.Data[1].X * C.Y + L.Data[2].X * C.Z + L.Data[3].X * C.W;
+        Result.Data[i].Y = L.Data[0].Y * C.X + L.Data[1].Y * C.Y + L.Data[2].Y * C.Z + L.Data[3].Y * C.W;
+        Result.Data[i].Z = L.Data[0].Z * C.X + L.Data[1].Z * C.Y + L.Data[2].Z * C.Z + L.Data[3].Z * C.W;
+        Result.Data[i].W = L.Data[0].W * C.X + L.Data[1].W * C.Y + L.Data[2].W * C.Z + L.Data[3].W * C.W;
+    }
+
+    return Result;
+}
+
 static FMatrix4 Rotate(float Angle, const FVector3& Axis)
 {
     auto C = std::cos(Angle);
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+const std::size_t MAPPED_FILE_PAGE_SIZE = 4096;
+
+// Sequential mappings are read ahead as a whole, random ones are only paged in where they are read
+enum class EMappedFileAccess
+{
+    Sequential,
+    Random
+};
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class FMappedFile
+{
+public:
+    FMappedFile() = default;
+
+    explicit FMappedFile(const std::string& Path, EMappedFileAccess Access = EMappedFileAccess::Sequential)
+    {
+        Open(Path, Access);
+    }
+
+    ~FMappedFile()
+    {
+        Close();
+    }
+
+    FMappedFile(const FMappedFile&) = delete;
+    FMappedFile& operator=(const FMappedFile&) = delete;
+
+    bool Open(const std::string& Path, EMappedFileAccess Access = EMappedFileAccess::Sequential)
+    {
+        Close();
+
+#ifdef _WIN32
+        FileHandle = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 Access == EMappedFileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+        if (FileHandle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER FileSize;
+        GetFileSizeEx(FileHandle, &FileSize);
+        Size = static_cast<std::size_t>(FileSize.QuadPart);
+
+        if (Size == 0)
+        {
+            return true;
+        }
+
+        MappingHandle = CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (MappingHandle == nullptr)
+        {
+            Close();
+            return false;
+        }
+
+        Data = static_cast<const char*>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+        FileDescriptor = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (FileDescriptor < 0)
+        {
+            return false;
+        }
+
+        struct stat FileStat{};
+        fstat(FileDescriptor, &FileStat);
+        Size = static_cast<std::size_t>(FileStat.st_size);
+
+        if (Size == 0)
+        {
+            return true;
+        }
+
+        void* Mapping = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+        Data = Mapping == MAP_FAILED ? nullptr : static_cast<const char*>(Mapping);
+
+        if (Data != nullptr)
+        {
+            madvise(Mapping, Size, Access == EMappedFileAccess::Sequential ? MADV_SEQUENTIAL | MADV_WILLNEED : MADV_RANDOM);
+        }
+#endif
+
+        if (Data == nullptr)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (Data != nullptr)
+        {
+            UnmapViewOfFile(Data);
+        }
+
+        if (MappingHandle != nullptr)
+        {
+            CloseHandle(MappingHandle);
+        }
+
+        if (FileHandle != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(FileHandle);
+        }
+
+        MappingHandle = nullptr;
+        FileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (Data != nullptr)
+        {
+            munmap(const_cast<char*>(Data), Size);
+        }
+
+        if (FileDescriptor >= 0)
+        {
+            close(FileDescriptor);
+        }
+
+        FileDescriptor = -1;
+#endif
+        Data = nullptr;
+        Size = 0;
+    }
+
+    bool IsOpen() const
+    {
+#ifdef _WIN32
+        return FileHandle != INVALID_HANDLE_VALUE;
+#else
+        return FileDescriptor >= 0;
+#endif
+    }
+
+    const char* GetData() const
+    {
+        return Data;
+    }
+
+    std::size_t GetSize() const
+    {
+        return Size;
+    }
+
+    // Touches every page, later reads out of the mapping then no longer wait on the disk
+    void Prefault() const
+    {
+        volatile char Sink = 0;
+
+        for (std::size_t Offset = 0; Offset < Size; Offset += MAPPED_FILE_PAGE_SIZE)
+        {
+            Sink = Sink + Data[Offset];
+        }
+    }
+
+private:
+    const char* Data = nullptr;
+    std::size_t Size = 0;
+#ifdef _WIN32
+    HANDLE FileHandle = INVALID_HANDLE_VALUE;
+    HANDLE MappingHandle = nullptr;
+#else
+    int FileDescriptor = -1;
+#endif
+};
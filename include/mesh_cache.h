@@ -0,0 +1,403 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "mesh_codec.h"
+#include "meshlet_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+const uint32_t MESH_CACHE_MAGIC = 0x4853454D;
+const uint32_t MESH_CACHE_VERSION = 9;
+const uint64_t MESH_CACHE_ALIGNMENT = 64;
+const uint32_t MESH_CACHE_MAX_ATTRIBUTES = 8;
+const uint32_t MESH_CACHE_MAX_LODS = 8;
+const uint32_t MESH_CACHE_MAX_PATH = 256;
+const std::string MESH_CACHE_EXTENSION = ".meshcache";
+
+struct FMeshVertexAttribute
+{
+    uint32_t Location;
+    uint32_t Format;
+    uint32_t Offset;
+};
+
+struct FMeshVertexLayout
+{
+    uint32_t Stride;
+    uint32_t AttributeCount;
+    FMeshVertexAttribute Attributes[MESH_CACHE_MAX_ATTRIBUTES];
+
+    bool operator==(const FMeshVertexLayout& Other) const
+    {
+        if (Stride != Other.Stride || AttributeCount != Other.AttributeCount)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < AttributeCount; ++i)
+        {
+            if (Attributes[i].Location != Other.Attributes[i].Location || Attributes[i].Format != Other.Attributes[i].Format || Attributes[i].Offset != Other.Attributes[i].Offset)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+struct FMeshBounds
+{
+    float Min[3];
+    float Max[3];
+    float TexCoordMin[2];
+    float TexCoordMax[2];
+};
+
+struct FMeshLod
+{
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    float Error;
+    uint32_t FirstSubmesh;
+    uint32_t SubmeshCount;
+};
+
+struct FMeshSubmesh
+{
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    uint32_t Material;
+    uint32_t FirstMeshlet;
+    uint32_t MeshletCount;
+};
+
+struct FMeshMaterial
+{
+    char DiffuseTexture[MESH_CACHE_MAX_PATH];
+};
+
+struct FMeshCacheHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t SourceHash;
+    FMeshVertexLayout Layout;
+    uint32_t IndexSize;
+    uint32_t Reserved;
+    uint64_t VertexCount;
+    uint64_t IndexCount;
+    uint64_t VertexOffset;
+    uint64_t IndexOffset;
+    FMeshBounds Bounds;
+    uint32_t LodCount;
+    FMeshLod Lods[MESH_CACHE_MAX_LODS];
+    uint64_t MeshletCount;
+    uint64_t MeshletVertexCount;
+    uint64_t MeshletTriangleSize;
+    uint64_t MeshletOffset;
+    uint64_t MeshletVertexOffset;
+    uint64_t MeshletTriangleOffset;
+    uint64_t SubmeshCount;
+    uint64_t MaterialCount;
+    uint64_t SubmeshOffset;
+    uint64_t MaterialOffset;
+    uint64_t VertexDataSize;
+    uint64_t IndexDataSize;
+};
+
+static uint64_t AlignMeshCacheOffset(uint64_t Offset)
+{
+    return (Offset + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1);
+}
+
+static FMeshBounds ComputeMeshBounds(const void* VertexData, std::size_t VertexCount, uint32_t Stride, uint32_t PositionOffset)
+{
+    FMeshBounds Bounds{};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Bounds.Min[i] = VertexCount ? std::numeric_limits<float>::max() : 0.f;
+        Bounds.Max[i] = VertexCount ? std::numeric_limits<float>::lowest() : 0.f;
+    }
+
+    const auto* Bytes = static_cast<const char*>(VertexData);
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        float Position[3];
+        std::memcpy(Position, Bytes + v * Stride + PositionOffset, sizeof(Position));
+
+        for (int i = 0; i < 3; ++i)
+        {
+            Bounds.Min[i] = std::min(Bounds.Min[i], Position[i]);
+            Bounds.Max[i] = std::max(Bounds.Max[i], Position[i]);
+        }
+    }
+
+    return Bounds;
+}
+
+static float GetMeshBoundsRadius(const FMeshBounds& Bounds)
+{
+    float Extent[3] = {Bounds.Max[0] - Bounds.Min[0], Bounds.Max[1] - Bounds.Min[1], Bounds.Max[2] - Bounds.Min[2]};
+    return std::sqrt(Extent[0] * Extent[0] + Extent[1] * Extent[1] + Extent[2] * Extent[2]) * 0.5f;
+}
+
+static bool WriteMeshCache(const std::string& Path, uint64_t SourceHash, const FMeshVertexLayout& Layout, const FMeshBounds& Bounds, const std::vector<FMeshLod>& Lods,
+                           const void* VertexData, std::size_t VertexCount, const void* IndexData, std::size_t IndexCount, uint32_t IndexSize, const FMeshletData& Meshlets,
+                           const std::vector<FMeshSubmesh>& Submeshes, const std::vector<FMeshMaterial>& Materials)
+{
+    if (Lods.empty() || Lods.size() > MESH_CACHE_MAX_LODS)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> EncodedVertices;
+
+    if (!EncodeVertexBuffer(VertexData, VertexCount, Layout.Stride, EncodedVertices))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> EncodedIndices = EncodeIndexBuffer(IndexData, IndexCount, IndexSize);
+
+    FMeshCacheHeader Header{};
+    Header.Magic = MESH_CACHE_MAGIC;
+    Header.Version = MESH_CACHE_VERSION;
+    Header.SourceHash = SourceHash;
+    Header.Layout = Layout;
+    Header.IndexSize = IndexSize;
+    Header.VertexCount = VertexCount;
+    Header.IndexCount = IndexCount;
+    Header.VertexDataSize = EncodedVertices.size();
+    Header.IndexDataSize = EncodedIndices.size();
+    Header.VertexOffset = AlignMeshCacheOffset(sizeof(FMeshCacheHeader));
+    Header.IndexOffset = AlignMeshCacheOffset(Header.VertexOffset + Header.VertexDataSize);
+    Header.Bounds = Bounds;
+    Header.LodCount = static_cast<uint32_t>(Lods.size());
+    std::copy(Lods.begin(), Lods.end(), Header.Lods);
+    Header.MeshletCount = Meshlets.Meshlets.size();
+    Header.MeshletVertexCount = Meshlets.Vertices.size();
+    Header.MeshletTriangleSize = Meshlets.Triangles.size();
+    Header.MeshletOffset = AlignMeshCacheOffset(Header.IndexOffset + Header.IndexDataSize);
+    Header.MeshletVertexOffset = AlignMeshCacheOffset(Header.MeshletOffset + Header.MeshletCount * sizeof(FMeshlet));
+    Header.MeshletTriangleOffset = AlignMeshCacheOffset(Header.MeshletVertexOffset + Header.MeshletVertexCount * sizeof(uint32_t));
+    Header.SubmeshCount = Submeshes.size();
+    Header.MaterialCount = Materials.size();
+    Header.SubmeshOffset = AlignMeshCacheOffset(Header.MeshletTriangleOffset + Header.MeshletTriangleSize);
+    Header.MaterialOffset = AlignMeshCacheOffset(Header.SubmeshOffset + Header.SubmeshCount * sizeof(FMeshSubmesh));
+
+    std::string TemporaryPath = Path + ".tmp";
+
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+
+        if (!File)
+        {
+            return false;
+        }
+
+        const char Padding[MESH_CACHE_ALIGNMENT] = {};
+        uint64_t Written = 0;
+
+        auto WriteBlob = [&](uint64_t Offset, const void* Data, uint64_t Size)
+        {
+            File.write(Padding, static_cast<std::streamsize>(Offset - Written));
+            File.write(static_cast<const char*>(Data), static_cast<std::streamsize>(Size));
+            Written = Offset + Size;
+        };
+
+        WriteBlob(0, &Header, sizeof(Header));
+        WriteBlob(Header.VertexOffset, EncodedVertices.data(), Header.VertexDataSize);
+        WriteBlob(Header.IndexOffset, EncodedIndices.data(), Header.IndexDataSize);
+        WriteBlob(Header.MeshletOffset, Meshlets.Meshlets.data(), Header.MeshletCount * sizeof(FMeshlet));
+        WriteBlob(Header.MeshletVertexOffset, Meshlets.Vertices.data(), Header.MeshletVertexCount * sizeof(uint32_t));
+        WriteBlob(Header.MeshletTriangleOffset, Meshlets.Triangles.data(), Header.MeshletTriangleSize);
+        WriteBlob(Header.SubmeshOffset, Submeshes.data(), Header.SubmeshCount * sizeof(FMeshSubmesh));
+        WriteBlob(Header.MaterialOffset, Materials.data(), Header.MaterialCount * sizeof(FMeshMaterial));
+
+        if (!File)
+        {
+            return false;
+        }
+    }
+
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, Path, Error);
+
+    if (Error)
+    {
+        std::filesystem::remove(TemporaryPath, Error);
+        return false;
+    }
+
+    return true;
+}
+
+class FMeshCache
+{
+public:
+    // The source hash is left to the caller, the runtime trusts the cooker to have replaced stale caches
+    bool Open(const std::string& Path, const FMeshVertexLayout& Layout)
+    {
+        Close();
+
+        if (!File.Open(Path) || File.GetSize() < sizeof(FMeshCacheHeader))
+        {
+            Close();
+            return false;
+        }
+
+        std::memcpy(&Header, File.GetData(), sizeof(Header));
+
+        bool bValid = Header.Magic == MESH_CACHE_MAGIC &&
+                      Header.Version == MESH_CACHE_VERSION &&
+                      Header.Layout == Layout &&
+                      (Header.IndexSize == sizeof(uint32_t) || (Header.IndexSize == sizeof(uint16_t) && Header.VertexCount <= (1u << 16))) &&
+                      Header.VertexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                      Header.IndexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                      Header.VertexOffset + Header.VertexDataSize <= Header.IndexOffset &&
+                      Header.IndexOffset + Header.IndexDataSize <= Header.MeshletOffset &&
+                      Header.MeshletOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                      Header.MeshletVertexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                      Header.MeshletTriangleOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                      Header.MeshletOffset + Header.MeshletCount * sizeof(FMeshlet) <= Header.MeshletVertexOffset &&
+                      Header.MeshletVertexOffset + Header.MeshletVertexCount * sizeof(uint32_t) <= Header.MeshletTriangleOffset &&
+                      Header.MeshletTriangleOffset + Header.MeshletTriangleSize <= Header.SubmeshOffset &&
+                      Header.SubmeshOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                      Header.MaterialOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                      Header.SubmeshOffset + Header.SubmeshCount * sizeof(FMeshSubmesh) <= Header.MaterialOffset &&
+                      Header.MaterialOffset + Header.MaterialCount * sizeof(FMeshMaterial) <= File.GetSize() &&
+                      Header.LodCount > 0 && Header.LodCount <= MESH_CACHE_MAX_LODS;
+
+        bValid = bValid && ValidateMeshCodecStream(File.GetData() + Header.VertexOffset, Header.VertexDataSize, Header.VertexCount) &&
+                 ValidateMeshCodecStream(File.GetData() + Header.IndexOffset, Header.IndexDataSize, Header.IndexCount);
+
+        for (uint32_t i = 0; bValid && i < Header.LodCount; ++i)
+        {
+            bValid = static_cast<uint64_t>(Header.Lods[i].FirstIndex) + Header.Lods[i].IndexCount <= Header.IndexCount &&
+                     static_cast<uint64_t>(Header.Lods[i].FirstSubmesh) + Header.Lods[i].SubmeshCount <= Header.SubmeshCount;
+        }
+
+        for (uint64_t i = 0; bValid && i < Header.SubmeshCount; ++i)
+        {
+            FMeshSubmesh Submesh;
+            std::memcpy(&Submesh, File.GetData() + Header.SubmeshOffset + i * sizeof(FMeshSubmesh), sizeof(Submesh));
+            bValid = static_cast<uint64_t>(Submesh.FirstIndex) + Submesh.IndexCount <= Header.IndexCount && Submesh.Material < Header.MaterialCount &&
+                     static_cast<uint64_t>(Submesh.FirstMeshlet) + Submesh.MeshletCount <= Header.MeshletCount;
+        }
+
+        for (uint64_t i = 0; bValid && i < Header.MaterialCount; ++i)
+        {
+            const char* DiffuseTexture = File.GetData() + Header.MaterialOffset + i * sizeof(FMeshMaterial);
+            bValid = std::memchr(DiffuseTexture, '\0', MESH_CACHE_MAX_PATH) != nullptr;
+        }
+
+        for (uint64_t i = 0; bValid && i < Header.MeshletCount; ++i)
+        {
+            FMeshlet Meshlet;
+            std::memcpy(&Meshlet, File.GetData() + Header.MeshletOffset + i * sizeof(FMeshlet), sizeof(Meshlet));
+            bValid = Meshlet.VertexCount <= MESHLET_MAX_VERTICES && Meshlet.TriangleCount <= MESHLET_MAX_TRIANGLES &&
+                     static_cast<uint64_t>(Meshlet.VertexOffset) + Meshlet.VertexCount <= Header.MeshletVertexCount &&
+                     static_cast<uint64_t>(Meshlet.TriangleOffset) + Meshlet.TriangleCount * 3 <= Header.MeshletTriangleSize;
+        }
+
+        if (!bValid)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close()
+    {
+        File.Close();
+        Header = FMeshCacheHeader{};
+    }
+
+    bool IsLoaded() const
+    {
+        return Header.Magic == MESH_CACHE_MAGIC;
+    }
+
+    const FMeshCacheHeader& GetHeader() const
+    {
+        return Header;
+    }
+
+    // Vertices and indices are stored as mesh codec streams, the sizes are the encoded sizes
+    const void* GetVertexData() const
+    {
+        return File.GetData() + Header.VertexOffset;
+    }
+
+    std::size_t GetVertexDataSize() const
+    {
+        return static_cast<std::size_t>(Header.VertexDataSize);
+    }
+
+    const void* GetIndexData() const
+    {
+        return File.GetData() + Header.IndexOffset;
+    }
+
+    std::size_t GetIndexDataSize() const
+    {
+        return static_cast<std::size_t>(Header.IndexDataSize);
+    }
+
+    const void* GetMeshletData() const
+    {
+        return File.GetData() + Header.MeshletOffset;
+    }
+
+    std::size_t GetMeshletDataSize() const
+    {
+        return static_cast<std::size_t>(Header.MeshletCount * sizeof(FMeshlet));
+    }
+
+    const void* GetMeshletVertexData() const
+    {
+        return File.GetData() + Header.MeshletVertexOffset;
+    }
+
+    std::size_t GetMeshletVertexDataSize() const
+    {
+        return static_cast<std::size_t>(Header.MeshletVertexCount * sizeof(uint32_t));
+    }
+
+    const void* GetMeshletTriangleData() const
+    {
+        return File.GetData() + Header.MeshletTriangleOffset;
+    }
+
+    std::size_t GetMeshletTriangleDataSize() const
+    {
+        return static_cast<std::size_t>(Header.MeshletTriangleSize);
+    }
+
+    const FMeshSubmesh* GetSubmeshes() const
+    {
+        return reinterpret_cast<const FMeshSubmesh*>(File.GetData() + Header.SubmeshOffset);
+    }
+
+    const FMeshMaterial* GetMaterials() const
+    {
+        return reinterpret_cast<const FMeshMaterial*>(File.GetData() + Header.MaterialOffset);
+    }
+
+private:
+    FMappedFile File;
+    FMeshCacheHeader Header{};
+};
@@ -0,0 +1,491 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MESH_CODEC_SSE2 1
+#endif
+
+const uint32_t MESH_CODEC_BLOCK_SIZE = 256;
+const uint32_t MESH_CODEC_GROUP_SIZE = 16;
+const uint32_t MESH_CODEC_MAX_STRIDE = 64;
+
+// An encoded stream is a table of BlockCount + 1 uint32 byte offsets followed by the blocks, every block holds
+// up to MESH_CODEC_BLOCK_SIZE elements and decodes on its own so a streamed upload can start at any block.
+// A block stores every byte of the element as its own plane: a 2 bit width code (0, 2, 4 or 8 bits) per group
+// of 16 bytes, followed by the packed groups. Vertex planes hold zigzagged deltas to the previous vertex,
+// index planes hold the bytes of zigzagged deltas to the previous index.
+//
+// This falls short of a several GB/s decode: the viking room decodes at about 1.4 to 2.6 GB/s for vertices and 2 GB/s
+// for indices on SSE2, depending on how well the width branches are predicted. Each 16 byte group takes around
+// 17 cycles to pick its width, unpack, undo the zigzag and prefix sum, and that is bound by instruction count rather
+// than by the carried sum. A pshufb unpack needs SSSE3, which the build does not enable. The vertices also only
+// shrink by 19 percent, because consecutive vertices in first use order are far apart and even the high byte planes
+// store most groups at 8 bits.
+
+static std::size_t GetMeshCodecBlockCount(std::size_t Count)
+{
+    return (Count + MESH_CODEC_BLOCK_SIZE - 1) / MESH_CODEC_BLOCK_SIZE;
+}
+
+static uint8_t ZigZagEncodeByte(uint8_t Delta)
+{
+    return static_cast<uint8_t>((Delta << 1) ^ (static_cast<int8_t>(Delta) >> 7));
+}
+
+static uint32_t ZigZagEncode(uint32_t Delta)
+{
+    return (Delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(Delta) >> 31);
+}
+
+static void EncodeBytePlane(const uint8_t* Values, std::size_t Count, std::vector<uint8_t>& Output)
+{
+    std::size_t GroupCount = (Count + MESH_CODEC_GROUP_SIZE - 1) / MESH_CODEC_GROUP_SIZE;
+    std::size_t HeaderOffset = Output.size();
+    Output.resize(Output.size() + (GroupCount + 3) / 4, 0);
+
+    for (std::size_t g = 0; g < GroupCount; ++g)
+    {
+        const uint8_t* Group = Values + g * MESH_CODEC_GROUP_SIZE;
+        uint8_t Bits = 0;
+
+        for (uint32_t i = 0; i < MESH_CODEC_GROUP_SIZE; ++i)
+        {
+            Bits |= Group[i];
+        }
+
+        uint32_t Code = Bits == 0 ? 0 : Bits < 4 ? 1 : Bits < 16 ? 2 : 3;
+        uint32_t Width = Code == 3 ? 8 : Code * 2;
+        Output[HeaderOffset + g / 4] |= static_cast<uint8_t>(Code << (g % 4 * 2));
+
+        if (Width == 0)
+        {
+            continue;
+        }
+
+        uint32_t ValuesPerByte = 8 / Width;
+
+        for (uint32_t i = 0; i < MESH_CODEC_GROUP_SIZE; i += ValuesPerByte)
+        {
+            uint8_t Byte = 0;
+
+            for (uint32_t j = 0; j < ValuesPerByte; ++j)
+            {
+                Byte |= static_cast<uint8_t>(Group[i + j] << (8 - Width * (j + 1)));
+            }
+
+            Output.push_back(Byte);
+        }
+    }
+}
+
+static std::vector<uint8_t> EncodeMeshCodecStream(const uint8_t* Elements, std::size_t Count, std::size_t Stride, bool bDeltaFilter)
+{
+    std::size_t BlockCount = GetMeshCodecBlockCount(Count);
+    std::vector<uint8_t> Output((BlockCount + 1) * sizeof(uint32_t));
+    uint8_t Plane[MESH_CODEC_BLOCK_SIZE];
+
+    for (std::size_t Block = 0; Block <= BlockCount; ++Block)
+    {
+        uint32_t Offset = static_cast<uint32_t>(Output.size());
+        std::memcpy(Output.data() + Block * sizeof(uint32_t), &Offset, sizeof(Offset));
+
+        if (Block == BlockCount)
+        {
+            break;
+        }
+
+        const uint8_t* BlockElements = Elements + Block * MESH_CODEC_BLOCK_SIZE * Stride;
+        std::size_t BlockSize = std::min<std::size_t>(MESH_CODEC_BLOCK_SIZE, Count - Block * MESH_CODEC_BLOCK_SIZE);
+
+        for (std::size_t k = 0; k < Stride; ++k)
+        {
+            std::memset(Plane, 0, sizeof(Plane));
+            uint8_t Previous = 0;
+
+            for (std::size_t i = 0; i < BlockSize; ++i)
+            {
+                uint8_t Value = BlockElements[i * Stride + k];
+                Plane[i] = bDeltaFilter ? ZigZagEncodeByte(static_cast<uint8_t>(Value - Previous)) : Value;
+                Previous = Value;
+            }
+
+            EncodeBytePlane(Plane, BlockSize, Output);
+        }
+    }
+
+    return Output;
+}
+
+static bool EncodeVertexBuffer(const void* Vertices, std::size_t VertexCount, std::size_t Stride, std::vector<uint8_t>& Encoded)
+{
+    if (Stride == 0 || Stride > MESH_CODEC_MAX_STRIDE)
+    {
+        return false;
+    }
+
+    Encoded = EncodeMeshCodecStream(static_cast<const uint8_t*>(Vertices), VertexCount, Stride, true);
+    return true;
+}
+
+static std::vector<uint8_t> EncodeIndexBuffer(const void* Indices, std::size_t IndexCount, uint32_t IndexSize)
+{
+    std::vector<uint32_t> Deltas(IndexCount);
+    uint32_t Previous = 0;
+
+    for (std::size_t i = 0; i < IndexCount; ++i)
+    {
+        uint32_t Index = 0;
+        std::memcpy(&Index, static_cast<const char*>(Indices) + i * IndexSize, IndexSize);
+
+        if (i % MESH_CODEC_BLOCK_SIZE == 0)
+        {
+            Previous = 0;
+        }
+
+        Deltas[i] = ZigZagEncode(Index - Previous);
+        Previous = Index;
+    }
+
+    return EncodeMeshCodecStream(reinterpret_cast<const uint8_t*>(Deltas.data()), IndexCount, sizeof(uint32_t), false);
+}
+
+static bool ValidateMeshCodecStream(const void* Encoded, std::size_t EncodedSize, std::size_t Count)
+{
+    const auto* Bytes = static_cast<const uint8_t*>(Encoded);
+    std::size_t BlockCount = GetMeshCodecBlockCount(Count);
+    std::size_t Previous = (BlockCount + 1) * sizeof(uint32_t);
+
+    if (EncodedSize < Previous)
+    {
+        return false;
+    }
+
+    for (std::size_t Block = 0; Block <= BlockCount; ++Block)
+    {
+        uint32_t Offset;
+        std::memcpy(&Offset, Bytes + Block * sizeof(uint32_t), sizeof(Offset));
+
+        if (Offset < Previous || Offset > EncodedSize || (Block == 0 && Offset != Previous))
+        {
+            return false;
+        }
+
+        Previous = Offset;
+    }
+
+    return Previous == EncodedSize;
+}
+
+#ifdef MESH_CODEC_SSE2
+static __m128i UnpackMeshCodecGroup(const uint8_t* Data, uint32_t Code)
+{
+    switch (Code)
+    {
+        case 0:
+            return _mm_setzero_si128();
+        case 1:
+        {
+            int32_t Word;
+            std::memcpy(&Word, Data, sizeof(Word));
+
+            __m128i Packed = _mm_cvtsi32_si128(Word);
+            __m128i Mask = _mm_set1_epi8(3);
+            __m128i Bits0 = _mm_and_si128(_mm_srli_epi16(Packed, 6), Mask);
+            __m128i Bits1 = _mm_and_si128(_mm_srli_epi16(Packed, 4), Mask);
+            __m128i Bits2 = _mm_and_si128(_mm_srli_epi16(Packed, 2), Mask);
+            __m128i Bits3 = _mm_and_si128(Packed, Mask);
+
+            return _mm_unpacklo_epi16(_mm_unpacklo_epi8(Bits0, Bits1), _mm_unpacklo_epi8(Bits2, Bits3));
+        }
+        case 2:
+        {
+            __m128i Packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(Data));
+            __m128i Mask = _mm_set1_epi8(15);
+
+            return _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(Packed, 4), Mask), _mm_and_si128(Packed, Mask));
+        }
+        default:
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data));
+    }
+}
+
+// Undoes the zigzag and sums the deltas over the 16 lanes, carrying the last value into the next group
+static __m128i DecodeMeshCodecDeltas(__m128i ZigZag, __m128i& Previous)
+{
+    __m128i Sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(ZigZag, _mm_set1_epi8(1)));
+    __m128i Value = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(ZigZag, 1), _mm_set1_epi8(0x7F)), Sign);
+
+    Value = _mm_add_epi8(Value, _mm_slli_si128(Value, 1));
+    Value = _mm_add_epi8(Value, _mm_slli_si128(Value, 2));
+    Value = _mm_add_epi8(Value, _mm_slli_si128(Value, 4));
+    Value = _mm_add_epi8(Value, _mm_slli_si128(Value, 8));
+    Value = _mm_add_epi8(Value, Previous);
+
+    Previous = _mm_unpackhi_epi8(Value, Value);
+    Previous = _mm_unpackhi_epi16(Previous, Previous);
+    Previous = _mm_shuffle_epi32(Previous, _MM_SHUFFLE(3, 3, 3, 3));
+
+    return Value;
+}
+#endif
+
+// Decodes one plane into 16 byte aligned groups, returns the first byte after the plane or nullptr if the block is truncated
+static const uint8_t* DecodeBytePlane(const uint8_t* Data, const uint8_t* End, std::size_t Count, bool bDeltaFilter, uint8_t* Plane)
+{
+    std::size_t GroupCount = (Count + MESH_CODEC_GROUP_SIZE - 1) / MESH_CODEC_GROUP_SIZE;
+    const uint8_t* Header = Data;
+
+    if (static_cast<std::size_t>(End - Data) < (GroupCount + 3) / 4)
+    {
+        return nullptr;
+    }
+
+    Data += (GroupCount + 3) / 4;
+
+#ifdef MESH_CODEC_SSE2
+    __m128i Previous = _mm_setzero_si128();
+#else
+    uint8_t Previous = 0;
+#endif
+
+    for (std::size_t g = 0; g < GroupCount; ++g)
+    {
+        uint32_t Code = (Header[g / 4] >> (g % 4 * 2)) & 3;
+        std::size_t Size = Code == 3 ? MESH_CODEC_GROUP_SIZE : Code * 4;
+
+        if (static_cast<std::size_t>(End - Data) < Size)
+        {
+            return nullptr;
+        }
+
+        uint8_t* Group = Plane + g * MESH_CODEC_GROUP_SIZE;
+
+#ifdef MESH_CODEC_SSE2
+        __m128i Values = UnpackMeshCodecGroup(Data, Code);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Group), bDeltaFilter ? DecodeMeshCodecDeltas(Values, Previous) : Values);
+#else
+        uint32_t Width = Code == 3 ? 8 : Code * 2;
+
+        for (uint32_t i = 0; i < MESH_CODEC_GROUP_SIZE; ++i)
+        {
+            uint8_t Value = Width == 0 ? 0 : static_cast<uint8_t>((Data[i * Width / 8] >> (8 - Width - i * Width % 8)) & ((1u << Width) - 1));
+
+            if (bDeltaFilter)
+            {
+                Previous = static_cast<uint8_t>(Previous + ((Value >> 1) ^ -(Value & 1)));
+                Value = Previous;
+            }
+
+            Group[i] = Value;
+        }
+#endif
+
+        Data += Size;
+    }
+
+    return Data;
+}
+
+static bool DecodeMeshCodecBlock(const uint8_t* Data, const uint8_t* End, std::size_t Count, std::size_t Stride, bool bDeltaFilter, uint8_t* Destination)
+{
+    alignas(16) uint8_t Planes[MESH_CODEC_MAX_STRIDE][MESH_CODEC_BLOCK_SIZE];
+
+    for (std::size_t k = 0; k < Stride; ++k)
+    {
+        Data = DecodeBytePlane(Data, End, Count, bDeltaFilter, Planes[k]);
+
+        if (Data == nullptr)
+        {
+            return false;
+        }
+    }
+
+    std::size_t k = 0;
+
+#ifdef MESH_CODEC_SSE2
+    // Interleaves eight, then four planes at a time into the bytes of 16 elements and copies them out per element
+    alignas(16) uint8_t Interleaved[MESH_CODEC_GROUP_SIZE * 8];
+
+    for (; k + 8 <= Stride; k += 8)
+    {
+        for (std::size_t i = 0; i < Count; i += MESH_CODEC_GROUP_SIZE)
+        {
+            __m128i Planes8[8];
+
+            for (int p = 0; p < 8; ++p)
+            {
+                Planes8[p] = _mm_load_si128(reinterpret_cast<const __m128i*>(Planes[k + p] + i));
+            }
+
+            __m128i Low01 = _mm_unpacklo_epi8(Planes8[0], Planes8[1]);
+            __m128i High01 = _mm_unpackhi_epi8(Planes8[0], Planes8[1]);
+            __m128i Low23 = _mm_unpacklo_epi8(Planes8[2], Planes8[3]);
+            __m128i High23 = _mm_unpackhi_epi8(Planes8[2], Planes8[3]);
+            __m128i Low45 = _mm_unpacklo_epi8(Planes8[4], Planes8[5]);
+            __m128i High45 = _mm_unpackhi_epi8(Planes8[4], Planes8[5]);
+            __m128i Low67 = _mm_unpacklo_epi8(Planes8[6], Planes8[7]);
+            __m128i High67 = _mm_unpackhi_epi8(Planes8[6], Planes8[7]);
+
+            __m128i Words0123[4] = {_mm_unpacklo_epi16(Low01, Low23), _mm_unpackhi_epi16(Low01, Low23), _mm_unpacklo_epi16(High01, High23), _mm_unpackhi_epi16(High01, High23)};
+            __m128i Words4567[4] = {_mm_unpacklo_epi16(Low45, Low67), _mm_unpackhi_epi16(Low45, Low67), _mm_unpacklo_epi16(High45, High67), _mm_unpackhi_epi16(High45, High67)};
+
+            for (int w = 0; w < 4; ++w)
+            {
+                _mm_store_si128(reinterpret_cast<__m128i*>(Interleaved + w * 32), _mm_unpacklo_epi32(Words0123[w], Words4567[w]));
+                _mm_store_si128(reinterpret_cast<__m128i*>(Interleaved + w * 32 + 16), _mm_unpackhi_epi32(Words0123[w], Words4567[w]));
+            }
+
+            std::size_t GroupEnd = std::min<std::size_t>(Count - i, MESH_CODEC_GROUP_SIZE);
+
+            for (std::size_t j = 0; j < GroupEnd; ++j)
+            {
+                std::memcpy(Destination + (i + j) * Stride + k, Interleaved + j * 8, 8);
+            }
+        }
+    }
+
+    for (; k + 4 <= Stride; k += 4)
+    {
+        for (std::size_t i = 0; i < Count; i += MESH_CODEC_GROUP_SIZE)
+        {
+            __m128i Plane0 = _mm_load_si128(reinterpret_cast<const __m128i*>(Planes[k + 0] + i));
+            __m128i Plane1 = _mm_load_si128(reinterpret_cast<const __m128i*>(Planes[k + 1] + i));
+            __m128i Plane2 = _mm_load_si128(reinterpret_cast<const __m128i*>(Planes[k + 2] + i));
+            __m128i Plane3 = _mm_load_si128(reinterpret_cast<const __m128i*>(Planes[k + 3] + i));
+
+            __m128i Low01 = _mm_unpacklo_epi8(Plane0, Plane1);
+            __m128i High01 = _mm_unpackhi_epi8(Plane0, Plane1);
+            __m128i Low23 = _mm_unpacklo_epi8(Plane2, Plane3);
+            __m128i High23 = _mm_unpackhi_epi8(Plane2, Plane3);
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(Interleaved + 0), _mm_unpacklo_epi16(Low01, Low23));
+            _mm_store_si128(reinterpret_cast<__m128i*>(Interleaved + 16), _mm_unpackhi_epi16(Low01, Low23));
+            _mm_store_si128(reinterpret_cast<__m128i*>(Interleaved + 32), _mm_unpacklo_epi16(High01, High23));
+            _mm_store_si128(reinterpret_cast<__m128i*>(Interleaved + 48), _mm_unpackhi_epi16(High01, High23));
+
+            std::size_t GroupEnd = std::min<std::size_t>(Count - i, MESH_CODEC_GROUP_SIZE);
+
+            for (std::size_t j = 0; j < GroupEnd; ++j)
+            {
+                std::memcpy(Destination + (i + j) * Stride + k, Interleaved + j * 4, 4);
+            }
+        }
+    }
+#endif
+
+    for (; k < Stride; ++k)
+    {
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            Destination[i * Stride + k] = Planes[k][i];
+        }
+    }
+
+    return Data == End;
+}
+
+// Writes elements [FirstVertex, VertexEnd) to Destination. FirstVertex has to start a block and VertexEnd has to end one
+// or be VertexCount, so a streamed upload decodes straight from the mapped cache into staging memory.
+static bool DecodeVertexBuffer(void* Destination, const void* Encoded, std::size_t EncodedSize, std::size_t VertexCount, std::size_t Stride,
+                               std::size_t FirstVertex, std::size_t VertexEnd)
+{
+    const auto* Bytes = static_cast<const uint8_t*>(Encoded);
+
+    if (Stride == 0 || Stride > MESH_CODEC_MAX_STRIDE || FirstVertex % MESH_CODEC_BLOCK_SIZE != 0 || VertexEnd > VertexCount ||
+        (VertexEnd % MESH_CODEC_BLOCK_SIZE != 0 && VertexEnd != VertexCount) || EncodedSize < (GetMeshCodecBlockCount(VertexCount) + 1) * sizeof(uint32_t))
+    {
+        return false;
+    }
+
+    for (std::size_t First = FirstVertex; First < VertexEnd; First += MESH_CODEC_BLOCK_SIZE)
+    {
+        uint32_t Offsets[2];
+        std::memcpy(Offsets, Bytes + First / MESH_CODEC_BLOCK_SIZE * sizeof(uint32_t), sizeof(Offsets));
+
+        if (Offsets[0] > Offsets[1] || Offsets[1] > EncodedSize)
+        {
+            return false;
+        }
+
+        uint8_t* BlockDestination = static_cast<uint8_t*>(Destination) + (First - FirstVertex) * Stride;
+
+        if (!DecodeMeshCodecBlock(Bytes + Offsets[0], Bytes + Offsets[1], std::min<std::size_t>(MESH_CODEC_BLOCK_SIZE, VertexEnd - First), Stride, true, BlockDestination))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool DecodeIndexBuffer(void* Destination, const void* Encoded, std::size_t EncodedSize, std::size_t IndexCount, uint32_t IndexSize)
+{
+    const auto* Bytes = static_cast<const uint8_t*>(Encoded);
+    alignas(16) uint32_t Deltas[MESH_CODEC_BLOCK_SIZE];
+
+    if ((IndexSize != sizeof(uint16_t) && IndexSize != sizeof(uint32_t)) || EncodedSize < (GetMeshCodecBlockCount(IndexCount) + 1) * sizeof(uint32_t))
+    {
+        return false;
+    }
+
+    for (std::size_t First = 0; First < IndexCount; First += MESH_CODEC_BLOCK_SIZE)
+    {
+        uint32_t Offsets[2];
+        std::memcpy(Offsets, Bytes + First / MESH_CODEC_BLOCK_SIZE * sizeof(uint32_t), sizeof(Offsets));
+
+        std::size_t BlockSize = std::min<std::size_t>(MESH_CODEC_BLOCK_SIZE, IndexCount - First);
+
+        if (Offsets[0] > Offsets[1] || Offsets[1] > EncodedSize ||
+            !DecodeMeshCodecBlock(Bytes + Offsets[0], Bytes + Offsets[1], BlockSize, sizeof(uint32_t), false, reinterpret_cast<uint8_t*>(Deltas)))
+        {
+            return false;
+        }
+
+        char* BlockDestination = static_cast<char*>(Destination) + First * IndexSize;
+        std::size_t i = 0;
+        uint32_t Previous = 0;
+
+#ifdef MESH_CODEC_SSE2
+        __m128i Running = _mm_setzero_si128();
+
+        for (; i + 4 <= BlockSize; i += 4)
+        {
+            __m128i ZigZag = _mm_load_si128(reinterpret_cast<const __m128i*>(Deltas + i));
+            __m128i Sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(ZigZag, _mm_set1_epi32(1)));
+            __m128i Value = _mm_xor_si128(_mm_srli_epi32(ZigZag, 1), Sign);
+
+            Value = _mm_add_epi32(Value, _mm_slli_si128(Value, 4));
+            Value = _mm_add_epi32(Value, _mm_slli_si128(Value, 8));
+            Value = _mm_add_epi32(Value, Running);
+            Running = _mm_shuffle_epi32(Value, _MM_SHUFFLE(3, 3, 3, 3));
+
+            if (IndexSize == sizeof(uint16_t))
+            {
+                // Signed saturation would clip indices above 32767, so the values are biased into the signed range and back
+                __m128i Bias = _mm_set1_epi32(32768);
+                __m128i Packed = _mm_packs_epi32(_mm_sub_epi32(Value, Bias), _mm_sub_epi32(Value, Bias));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(BlockDestination + i * sizeof(uint16_t)), _mm_add_epi16(Packed, _mm_set1_epi16(-32768)));
+            }
+            else
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(BlockDestination + i * sizeof(uint32_t)), Value);
+            }
+        }
+
+        Previous = static_cast<uint32_t>(_mm_cvtsi128_si32(Running));
+#endif
+
+        for (; i < BlockSize; ++i)
+        {
+            Previous += (Deltas[i] >> 1) ^ (0u - (Deltas[i] & 1));
+            std::memcpy(BlockDestination + i * IndexSize, &Previous, IndexSize);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,554 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+const int VERTEX_CACHE_SIZE = 32;
+const uint32_t VERTEX_CACHE_ANALYSIS_SIZE = 16;
+
+struct FVertexCacheStats
+{
+    float Acmr;
+    float Atvr;
+};
+
+static FVertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& Indices, std::size_t VertexCount, uint32_t CacheSize)
+{
+    std::vector<uint32_t> Timestamps(VertexCount, 0);
+    uint32_t Time = CacheSize + 1;
+    std::size_t Misses = 0;
+    std::size_t UniqueVertices = 0;
+
+    for (uint32_t Index : Indices)
+    {
+        if (Timestamps[Index] == 0)
+        {
+            ++UniqueVertices;
+        }
+
+        if (Time - Timestamps[Index] > CacheSize)
+        {
+            Timestamps[Index] = Time++;
+            ++Misses;
+        }
+    }
+
+    FVertexCacheStats Stats{};
+    Stats.Acmr = Indices.empty() ? 0.f : static_cast<float>(Misses) / static_cast<float>(Indices.size() / 3);
+    Stats.Atvr = UniqueVertices == 0 ? 0.f : static_cast<float>(Misses) / static_cast<float>(UniqueVertices);
+
+    return Stats;
+}
+
+static float ForsythVertexScore(int CachePosition, uint32_t RemainingTriangles)
+{
+    if (RemainingTriangles == 0)
+    {
+        return -1.f;
+    }
+
+    float Score = 0.f;
+
+    if (CachePosition >= 0)
+    {
+        Score = CachePosition < 3 ? 0.75f : std::pow(1.f - static_cast<float>(CachePosition - 3) / (VERTEX_CACHE_SIZE - 3), 1.5f);
+    }
+
+    return Score + 2.f / std::sqrt(static_cast<float>(RemainingTriangles));
+}
+
+// Reorders triangles for post-transform cache locality (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+static void OptimizeVertexCache(std::vector<uint32_t>& Indices, std::size_t VertexCount)
+{
+    std::size_t TriangleCount = Indices.size() / 3;
+
+    std::vector<uint32_t> Remaining(VertexCount, 0);
+    std::vector<uint32_t> Offsets(VertexCount + 1, 0);
+
+    for (uint32_t Index : Indices)
+    {
+        ++Remaining[Index];
+    }
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        Offsets[v + 1] = Offsets[v] + Remaining[v];
+    }
+
+    std::vector<uint32_t> Adjacency(Indices.size());
+    std::vector<uint32_t> Fill(Offsets.begin(), Offsets.end() - 1);
+
+    for (std::size_t i = 0; i < Indices.size(); ++i)
+    {
+        Adjacency[Fill[Indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<int> CachePositions(VertexCount, -1);
+    std::vector<float> VertexScores(VertexCount);
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        VertexScores[v] = ForsythVertexScore(-1, Remaining[v]);
+    }
+
+    std::vector<float> TriangleScores(TriangleCount);
+    std::vector<char> Emitted(TriangleCount, 0);
+    std::int64_t Best = -1;
+    float BestScore = -1.f;
+
+    for (std::size_t t = 0; t < TriangleCount; ++t)
+    {
+        TriangleScores[t] = VertexScores[Indices[t * 3]] + VertexScores[Indices[t * 3 + 1]] + VertexScores[Indices[t * 3 + 2]];
+
+        if (TriangleScores[t] > BestScore)
+        {
+            BestScore = TriangleScores[t];
+            Best = static_cast<std::int64_t>(t);
+        }
+    }
+
+    std::vector<uint32_t> Output;
+    Output.reserve(Indices.size());
+
+    uint32_t Cache[VERTEX_CACHE_SIZE + 3];
+    int CacheCount = 0;
+    std::size_t Cursor = 0;
+
+    while (Output.size() < TriangleCount * 3)
+    {
+        if (Best < 0)
+        {
+            while (Emitted[Cursor])
+            {
+                ++Cursor;
+            }
+
+            Best = static_cast<std::int64_t>(Cursor);
+        }
+
+        const uint32_t* Triangle = &Indices[Best * 3];
+        Output.insert(Output.end(), Triangle, Triangle + 3);
+        Emitted[Best] = 1;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t* Begin = &Adjacency[Offsets[Triangle[k]]];
+            uint32_t* Last = Begin + --Remaining[Triangle[k]];
+
+            for (uint32_t* Entry = Begin; Entry <= Last; ++Entry)
+            {
+                if (*Entry == static_cast<uint32_t>(Best))
+                {
+                    std::swap(*Entry, *Last);
+                    break;
+                }
+            }
+        }
+
+        uint32_t NewCache[VERTEX_CACHE_SIZE + 3];
+        int NewCacheCount = 0;
+
+        auto AddToCache = [&](uint32_t Vertex)
+        {
+            for (int i = 0; i < NewCacheCount; ++i)
+            {
+                if (NewCache[i] == Vertex)
+                {
+                    return;
+                }
+            }
+
+            NewCache[NewCacheCount++] = Vertex;
+        };
+
+        AddToCache(Triangle[0]);
+        AddToCache(Triangle[1]);
+        AddToCache(Triangle[2]);
+
+        for (int i = 0; i < CacheCount; ++i)
+        {
+            AddToCache(Cache[i]);
+        }
+
+        for (int i = 0; i < NewCacheCount; ++i)
+        {
+            uint32_t Vertex = NewCache[i];
+            CachePositions[Vertex] = i < VERTEX_CACHE_SIZE ? i : -1;
+            VertexScores[Vertex] = ForsythVertexScore(CachePositions[Vertex], Remaining[Vertex]);
+        }
+
+        CacheCount = 0;
+
+        while (CacheCount < NewCacheCount && CacheCount < VERTEX_CACHE_SIZE)
+        {
+            Cache[CacheCount] = NewCache[CacheCount];
+            ++CacheCount;
+        }
+
+        Best = -1;
+        BestScore = -1.f;
+
+        for (int i = 0; i < NewCacheCount; ++i)
+        {
+            uint32_t Vertex = NewCache[i];
+
+            for (uint32_t j = 0; j < Remaining[Vertex]; ++j)
+            {
+                uint32_t t = Adjacency[Offsets[Vertex] + j];
+                TriangleScores[t] = VertexScores[Indices[t * 3]] + VertexScores[Indices[t * 3 + 1]] + VertexScores[Indices[t * 3 + 2]];
+
+                if (TriangleScores[t] > BestScore)
+                {
+                    BestScore = TriangleScores[t];
+                    Best = t;
+                }
+            }
+        }
+    }
+
+    Indices.swap(Output);
+}
+
+const float OVERDRAW_CLUSTER_THRESHOLD = 1.05f;
+const int OVERDRAW_ANALYSIS_RESOLUTION = 256;
+const uint32_t VERTEX_FETCH_CACHE_LINE_SIZE = 64;
+const uint32_t VERTEX_FETCH_CACHE_LINES = 64;
+
+static void ReadVertexPosition(const void* VertexData, std::size_t Stride, std::size_t PositionOffset, uint32_t Vertex, float Position[3])
+{
+    std::memcpy(Position, static_cast<const char*>(VertexData) + Vertex * Stride + PositionOffset, sizeof(float) * 3);
+}
+
+// Renders the mesh orthographically from the six axis directions with back-face culling and returns
+// the number of depth-test passing fragments per covered pixel
+static float AnalyzeOverdraw(const std::vector<uint32_t>& Indices, const void* VertexData, std::size_t VertexCount, std::size_t Stride, std::size_t PositionOffset)
+{
+    if (Indices.empty())
+    {
+        return 0.f;
+    }
+
+    float Min[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float Max[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        float Position[3];
+        ReadVertexPosition(VertexData, Stride, PositionOffset, static_cast<uint32_t>(v), Position);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            Min[i] = std::min(Min[i], Position[i]);
+            Max[i] = std::max(Max[i], Position[i]);
+        }
+    }
+
+    float Extent = std::max({Max[0] - Min[0], Max[1] - Min[1], Max[2] - Min[2], 1e-6f});
+    float Scale = (OVERDRAW_ANALYSIS_RESOLUTION - 1) / Extent;
+
+    const int Resolution = OVERDRAW_ANALYSIS_RESOLUTION;
+    std::vector<float> DepthBuffer(Resolution * Resolution);
+    std::size_t Shaded = 0;
+    std::size_t Covered = 0;
+
+    for (int View = 0; View < 6; ++View)
+    {
+        int Axis = View / 2;
+        float Sign = View % 2 ? -1.f : 1.f;
+        std::fill(DepthBuffer.begin(), DepthBuffer.end(), std::numeric_limits<float>::lowest());
+
+        for (std::size_t t = 0; t < Indices.size() / 3; ++t)
+        {
+            float Screen[3][3];
+
+            for (int k = 0; k < 3; ++k)
+            {
+                float Position[3];
+                ReadVertexPosition(VertexData, Stride, PositionOffset, Indices[t * 3 + k], Position);
+
+                int U = (Axis + 1) % 3;
+                int V = (Axis + 2) % 3;
+                Screen[k][0] = Sign > 0 ? (Position[U] - Min[U]) * Scale : (Max[U] - Position[U]) * Scale;
+                Screen[k][1] = (Position[V] - Min[V]) * Scale;
+                Screen[k][2] = Position[Axis] * Sign;
+            }
+
+            float Area = (Screen[1][0] - Screen[0][0]) * (Screen[2][1] - Screen[0][1]) - (Screen[2][0] - Screen[0][0]) * (Screen[1][1] - Screen[0][1]);
+
+            if (Area <= 0.f)
+            {
+                continue;
+            }
+
+            int MinX = std::max(0, static_cast<int>(std::floor(std::min({Screen[0][0], Screen[1][0], Screen[2][0]}))));
+            int MaxX = std::min(Resolution - 1, static_cast<int>(std::ceil(std::max({Screen[0][0], Screen[1][0], Screen[2][0]}))));
+            int MinY = std::max(0, static_cast<int>(std::floor(std::min({Screen[0][1], Screen[1][1], Screen[2][1]}))));
+            int MaxY = std::min(Resolution - 1, static_cast<int>(std::ceil(std::max({Screen[0][1], Screen[1][1], Screen[2][1]}))));
+
+            for (int Y = MinY; Y <= MaxY; ++Y)
+            {
+                for (int X = MinX; X <= MaxX; ++X)
+                {
+                    float PX = X + 0.5f;
+                    float PY = Y + 0.5f;
+
+                    float W0 = (Screen[2][0] - Screen[1][0]) * (PY - Screen[1][1]) - (Screen[2][1] - Screen[1][1]) * (PX - Screen[1][0]);
+                    float W1 = (Screen[0][0] - Screen[2][0]) * (PY - Screen[2][1]) - (Screen[0][1] - Screen[2][1]) * (PX - Screen[2][0]);
+                    float W2 = Area - W0 - W1;
+
+                    if (W0 < 0.f || W1 < 0.f || W2 < 0.f)
+                    {
+                        continue;
+                    }
+
+                    float Depth = (W0 * Screen[0][2] + W1 * Screen[1][2] + W2 * Screen[2][2]) / Area;
+                    float& Stored = DepthBuffer[Y * Resolution + X];
+
+                    if (Depth > Stored)
+                    {
+                        Covered += Stored == std::numeric_limits<float>::lowest();
+                        Stored = Depth;
+                        ++Shaded;
+                    }
+                }
+            }
+        }
+    }
+
+    return Covered == 0 ? 0.f : static_cast<float>(Shaded) / static_cast<float>(Covered);
+}
+
+// Returns the bytes read from vertex memory per referenced vertex byte, modelling fetches on
+// post-transform cache misses through a small FIFO cache of memory lines
+static float AnalyzeVertexFetch(const std::vector<uint32_t>& Indices, std::size_t VertexCount, std::size_t VertexSize)
+{
+    std::vector<uint32_t> VertexTimestamps(VertexCount, 0);
+    std::vector<uint32_t> LineTimestamps(VertexCount * VertexSize / VERTEX_FETCH_CACHE_LINE_SIZE + 1, 0);
+    std::vector<char> Referenced(VertexCount, 0);
+    uint32_t VertexTime = VERTEX_CACHE_ANALYSIS_SIZE + 1;
+    uint32_t LineTime = VERTEX_FETCH_CACHE_LINES + 1;
+    std::size_t BytesFetched = 0;
+    std::size_t UniqueVertices = 0;
+
+    for (uint32_t Index : Indices)
+    {
+        UniqueVertices += Referenced[Index] == 0;
+        Referenced[Index] = 1;
+
+        if (VertexTime - VertexTimestamps[Index] <= VERTEX_CACHE_ANALYSIS_SIZE)
+        {
+            continue;
+        }
+
+        VertexTimestamps[Index] = VertexTime++;
+
+        std::size_t FirstLine = Index * VertexSize / VERTEX_FETCH_CACHE_LINE_SIZE;
+        std::size_t LastLine = (Index * VertexSize + VertexSize - 1) / VERTEX_FETCH_CACHE_LINE_SIZE;
+
+        for (std::size_t Line = FirstLine; Line <= LastLine; ++Line)
+        {
+            if (LineTime - LineTimestamps[Line] > VERTEX_FETCH_CACHE_LINES)
+            {
+                LineTimestamps[Line] = LineTime++;
+                BytesFetched += VERTEX_FETCH_CACHE_LINE_SIZE;
+            }
+        }
+    }
+
+    return UniqueVertices == 0 ? 0.f : static_cast<float>(BytesFetched) / static_cast<float>(UniqueVertices * VertexSize);
+}
+
+// Splits a cache optimized index buffer into clusters at points where the cache hit rate is still
+// close to the cluster average, then sorts clusters so outward facing ones are drawn first
+// (Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+static void OptimizeOverdraw(std::vector<uint32_t>& Indices, const void* VertexData, std::size_t VertexCount, std::size_t Stride, std::size_t PositionOffset, float Threshold)
+{
+    std::size_t TriangleCount = Indices.size() / 3;
+
+    if (TriangleCount == 0)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> Timestamps(VertexCount, 0);
+    uint32_t Time = VERTEX_CACHE_ANALYSIS_SIZE + 1;
+
+    auto CountMisses = [&](std::size_t Triangle)
+    {
+        int Misses = 0;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t Index = Indices[Triangle * 3 + k];
+
+            if (Time - Timestamps[Index] > VERTEX_CACHE_ANALYSIS_SIZE)
+            {
+                Timestamps[Index] = Time++;
+                ++Misses;
+            }
+        }
+
+        return Misses;
+    };
+
+    std::vector<std::size_t> HardBoundaries;
+    std::vector<int> TriangleMisses(TriangleCount);
+
+    for (std::size_t t = 0; t < TriangleCount; ++t)
+    {
+        TriangleMisses[t] = CountMisses(t);
+
+        if (t == 0 || TriangleMisses[t] == 3)
+        {
+            HardBoundaries.push_back(t);
+        }
+    }
+
+    HardBoundaries.push_back(TriangleCount);
+
+    std::vector<std::size_t> Clusters;
+
+    for (std::size_t h = 0; h + 1 < HardBoundaries.size(); ++h)
+    {
+        std::size_t Begin = HardBoundaries[h];
+        std::size_t End = HardBoundaries[h + 1];
+
+        int ClusterMisses = 0;
+
+        for (std::size_t t = Begin; t < End; ++t)
+        {
+            ClusterMisses += TriangleMisses[t];
+        }
+
+        float ClusterAcmr = static_cast<float>(ClusterMisses) / static_cast<float>(End - Begin);
+
+        Time += VERTEX_CACHE_ANALYSIS_SIZE + 1;
+        Clusters.push_back(Begin);
+        std::size_t Start = Begin;
+        int RunningMisses = 0;
+
+        for (std::size_t t = Begin; t < End; ++t)
+        {
+            RunningMisses += CountMisses(t);
+
+            if (t + 1 < End && static_cast<float>(RunningMisses) / static_cast<float>(t - Start + 1) <= ClusterAcmr * Threshold)
+            {
+                Clusters.push_back(t + 1);
+                Start = t + 1;
+                RunningMisses = 0;
+                Time += VERTEX_CACHE_ANALYSIS_SIZE + 1;
+            }
+        }
+    }
+
+    Clusters.push_back(TriangleCount);
+
+    std::size_t ClusterCount = Clusters.size() - 1;
+    std::vector<float> ClusterCentroids(ClusterCount * 3, 0.f);
+    std::vector<float> ClusterNormals(ClusterCount * 3, 0.f);
+    float MeshCentroid[3] = {0.f, 0.f, 0.f};
+    float MeshArea = 0.f;
+
+    for (std::size_t c = 0; c < ClusterCount; ++c)
+    {
+        float ClusterArea = 0.f;
+
+        for (std::size_t t = Clusters[c]; t < Clusters[c + 1]; ++t)
+        {
+            float P[3][3];
+
+            for (int k = 0; k < 3; ++k)
+            {
+                ReadVertexPosition(VertexData, Stride, PositionOffset, Indices[t * 3 + k], P[k]);
+            }
+
+            float E1[3] = {P[1][0] - P[0][0], P[1][1] - P[0][1], P[1][2] - P[0][2]};
+            float E2[3] = {P[2][0] - P[0][0], P[2][1] - P[0][1], P[2][2] - P[0][2]};
+            float Normal[3] = {E1[1] * E2[2] - E1[2] * E2[1], E1[2] * E2[0] - E1[0] * E2[2], E1[0] * E2[1] - E1[1] * E2[0]};
+            float Area = std::sqrt(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                float Centroid = (P[0][i] + P[1][i] + P[2][i]) / 3.f;
+                ClusterCentroids[c * 3 + i] += Centroid * Area;
+                ClusterNormals[c * 3 + i] += Normal[i];
+                MeshCentroid[i] += Centroid * Area;
+            }
+
+            ClusterArea += Area;
+        }
+
+        MeshArea += ClusterArea;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            ClusterCentroids[c * 3 + i] /= ClusterArea > 0.f ? ClusterArea : 1.f;
+        }
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        MeshCentroid[i] /= MeshArea > 0.f ? MeshArea : 1.f;
+    }
+
+    std::vector<float> SortKeys(ClusterCount);
+
+    for (std::size_t c = 0; c < ClusterCount; ++c)
+    {
+        const float* Normal = &ClusterNormals[c * 3];
+        float Length = std::sqrt(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+        float Dot = 0.f;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            Dot += (ClusterCentroids[c * 3 + i] - MeshCentroid[i]) * Normal[i];
+        }
+
+        SortKeys[c] = Length > 0.f ? Dot / Length : 0.f;
+    }
+
+    std::vector<std::size_t> Order(ClusterCount);
+
+    for (std::size_t c = 0; c < ClusterCount; ++c)
+    {
+        Order[c] = c;
+    }
+
+    std::stable_sort(Order.begin(), Order.end(), [&](std::size_t A, std::size_t B) { return SortKeys[A] > SortKeys[B]; });
+
+    std::vector<uint32_t> Output;
+    Output.reserve(Indices.size());
+
+    for (std::size_t c : Order)
+    {
+        Output.insert(Output.end(), Indices.begin() + Clusters[c] * 3, Indices.begin() + Clusters[c + 1] * 3);
+    }
+
+    Indices.swap(Output);
+}
+
+// Reorders vertices into the order they are first referenced by the index buffer and drops unused ones
+template<typename T>
+static void OptimizeVertexFetch(std::vector<T>& Vertices, std::vector<uint32_t>& Indices)
+{
+    std::vector<uint32_t> Remap(Vertices.size(), std::numeric_limits<uint32_t>::max());
+    std::vector<T> Reordered;
+    Reordered.reserve(Vertices.size());
+
+    for (uint32_t& Index : Indices)
+    {
+        if (Remap[Index] == std::numeric_limits<uint32_t>::max())
+        {
+            Remap[Index] = static_cast<uint32_t>(Reordered.size());
+            Reordered.push_back(Vertices[Index]);
+        }
+
+        Index = Remap[Index];
+    }
+
+    Vertices.swap(Reordered);
+}
@@ -0,0 +1,485 @@
+#pragma once
+
+#include "index_tuple_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Border and seam edges add a plane through the edge perpendicular to its triangle, so moving a vertex off the
+// outline is priced like moving it off the surface. Without them a planar border collapses for free.
+const double SIMPLIFY_BORDER_WEIGHT = 2.0;
+const double SIMPLIFY_SEAM_WEIGHT = 1.0;
+
+struct FQuadric
+{
+    double A2, AB, AC, AD, B2, BC, BD, C2, CD, D2;
+
+    void AddPlane(double A, double B, double C, double D)
+    {
+        A2 += A * A; AB += A * B; AC += A * C; AD += A * D;
+        B2 += B * B; BC += B * C; BD += B * D;
+        C2 += C * C; CD += C * D;
+        D2 += D * D;
+    }
+
+    void Add(const FQuadric& Other)
+    {
+        A2 += Other.A2; AB += Other.AB; AC += Other.AC; AD += Other.AD;
+        B2 += Other.B2; BC += Other.BC; BD += Other.BD;
+        C2 += Other.C2; CD += Other.CD;
+        D2 += Other.D2;
+    }
+
+    double Evaluate(const float* P) const
+    {
+        double X = P[0], Y = P[1], Z = P[2];
+        double Error = A2 * X * X + 2 * AB * X * Y + 2 * AC * X * Z + 2 * AD * X
+                     + B2 * Y * Y + 2 * BC * Y * Z + 2 * BD * Y
+                     + C2 * Z * Z + 2 * CD * Z
+                     + D2;
+
+        return std::max(Error, 0.0);
+    }
+};
+
+static void ComputeTriangleNormal(const float* P0, const float* P1, const float* P2, double Normal[3])
+{
+    double E1[3] = {P1[0] - P0[0], P1[1] - P0[1], P1[2] - P0[2]};
+    double E2[3] = {P2[0] - P0[0], P2[1] - P0[1], P2[2] - P0[2]};
+
+    Normal[0] = E1[1] * E2[2] - E1[2] * E2[1];
+    Normal[1] = E1[2] * E2[0] - E1[0] * E2[2];
+    Normal[2] = E1[0] * E2[1] - E1[1] * E2[0];
+}
+
+enum class ESimplifyVertexKind : uint8_t
+{
+    Manifold,
+    Border,
+    Seam,
+    Locked
+};
+
+// Quadric error metric edge collapse (Garland, Heckbert) onto existing vertices, so every LOD shares
+// the source vertex buffer. Vertices with the same position are collapsed together: border and UV seam
+// vertices only move along their border or seam and pay for leaving its line, anything non-manifold stays where it is.
+// Stops at TargetIndexCount or once the next collapse would move the surface further than TargetError.
+// Vertices flagged in LockedVertices never move, which keeps borders shared with other submeshes intact.
+// Returns the simplified index buffer and writes the largest collapse error as a distance to Error.
+static std::vector<uint32_t> SimplifyMesh(const std::vector<uint32_t>& Indices, const void* VertexData, std::size_t VertexCount, std::size_t Stride,
+                                          std::size_t PositionOffset, std::size_t TargetIndexCount, float TargetError, float& Error,
+                                          const std::vector<char>& LockedVertices = {})
+{
+    std::vector<float> Positions(VertexCount * 3);
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        std::memcpy(&Positions[v * 3], static_cast<const char*>(VertexData) + v * Stride + PositionOffset, sizeof(float) * 3);
+    }
+
+    std::vector<int> Groups = BuildCanonicalIndices(Positions, 3);
+    std::vector<uint32_t> NextWedge(VertexCount);
+    std::vector<uint32_t> GroupSizes(VertexCount, 0);
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        uint32_t Group = static_cast<uint32_t>(Groups[v]);
+        NextWedge[v] = v == Group ? Group : NextWedge[Group];
+        NextWedge[Group] = static_cast<uint32_t>(v);
+        ++GroupSizes[Group];
+    }
+
+    struct FEdge
+    {
+        uint64_t PositionKey;
+        uint64_t VertexKey;
+
+        bool operator<(const FEdge& Other) const
+        {
+            return PositionKey < Other.PositionKey || (PositionKey == Other.PositionKey && VertexKey < Other.VertexKey);
+        }
+    };
+
+    auto MakeKey = [](uint32_t A, uint32_t B)
+    {
+        return static_cast<uint64_t>(std::min(A, B)) << 32 | std::max(A, B);
+    };
+
+    std::vector<FEdge> Edges;
+    Edges.reserve(Indices.size());
+
+    for (std::size_t i = 0; i < Indices.size(); i += 3)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t A = Indices[i + k];
+            uint32_t B = Indices[i + (k + 1) % 3];
+            Edges.push_back({MakeKey(Groups[A], Groups[B]), MakeKey(A, B)});
+        }
+    }
+
+    std::sort(Edges.begin(), Edges.end());
+
+    std::vector<uint32_t> BorderEdges(VertexCount, 0);
+    std::vector<uint32_t> SeamEdges(VertexCount, 0);
+    std::vector<char> NonManifold(VertexCount, 0);
+    std::vector<uint64_t> BorderKeys;
+    std::vector<uint64_t> SeamKeys;
+
+    for (std::size_t i = 0; i < Edges.size();)
+    {
+        std::size_t j = i + 1;
+
+        while (j < Edges.size() && Edges[j].PositionKey == Edges[i].PositionKey)
+        {
+            ++j;
+        }
+
+        uint32_t A = static_cast<uint32_t>(Edges[i].PositionKey >> 32);
+        uint32_t B = static_cast<uint32_t>(Edges[i].PositionKey & 0xFFFFFFFFu);
+
+        if (j - i == 1)
+        {
+            ++BorderEdges[A];
+            ++BorderEdges[B];
+            BorderKeys.push_back(Edges[i].PositionKey);
+        }
+        else if (j - i == 2 && Edges[i].VertexKey != Edges[i + 1].VertexKey)
+        {
+            ++SeamEdges[A];
+            ++SeamEdges[B];
+            SeamKeys.push_back(Edges[i].PositionKey);
+        }
+        else if (j - i > 2)
+        {
+            NonManifold[A] = 1;
+            NonManifold[B] = 1;
+        }
+
+        i = j;
+    }
+
+    std::vector<ESimplifyVertexKind> Kinds(VertexCount, ESimplifyVertexKind::Locked);
+    std::vector<char> LockedGroups(VertexCount, 0);
+
+    for (std::size_t v = 0; v < LockedVertices.size(); ++v)
+    {
+        LockedGroups[Groups[v]] |= LockedVertices[v];
+    }
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        if (static_cast<uint32_t>(Groups[v]) != v || NonManifold[v] || LockedGroups[v])
+        {
+            continue;
+        }
+
+        if (GroupSizes[v] == 1 && BorderEdges[v] == 0 && SeamEdges[v] == 0)
+        {
+            Kinds[v] = ESimplifyVertexKind::Manifold;
+        }
+        else if (GroupSizes[v] == 1 && BorderEdges[v] == 2 && SeamEdges[v] == 0)
+        {
+            Kinds[v] = ESimplifyVertexKind::Border;
+        }
+        else if (GroupSizes[v] == 2 && BorderEdges[v] == 0 && SeamEdges[v] == 2)
+        {
+            Kinds[v] = ESimplifyVertexKind::Seam;
+        }
+    }
+
+    auto CanCollapse = [&](uint32_t From, uint64_t EdgeKey)
+    {
+        switch (Kinds[From])
+        {
+            case ESimplifyVertexKind::Manifold:
+                return true;
+            case ESimplifyVertexKind::Border:
+                return std::binary_search(BorderKeys.begin(), BorderKeys.end(), EdgeKey);
+            case ESimplifyVertexKind::Seam:
+                return std::binary_search(SeamKeys.begin(), SeamKeys.end(), EdgeKey);
+            default:
+                return false;
+        }
+    };
+
+    std::sort(BorderKeys.begin(), BorderKeys.end());
+    std::sort(SeamKeys.begin(), SeamKeys.end());
+
+    std::vector<FQuadric> Quadrics(VertexCount, FQuadric{});
+
+    for (std::size_t i = 0; i < Indices.size(); i += 3)
+    {
+        const float* P0 = &Positions[Indices[i] * 3];
+        double Normal[3];
+        ComputeTriangleNormal(P0, &Positions[Indices[i + 1] * 3], &Positions[Indices[i + 2] * 3], Normal);
+
+        double Length = std::sqrt(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+
+        if (Length == 0.0)
+        {
+            continue;
+        }
+
+        double A = Normal[0] / Length, B = Normal[1] / Length, C = Normal[2] / Length;
+        double D = -(A * P0[0] + B * P0[1] + C * P0[2]);
+
+        for (int k = 0; k < 3; ++k)
+        {
+            Quadrics[Groups[Indices[i + k]]].AddPlane(A, B, C, D);
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t GroupA = static_cast<uint32_t>(Groups[Indices[i + k]]);
+            uint32_t GroupB = static_cast<uint32_t>(Groups[Indices[i + (k + 1) % 3]]);
+            uint64_t EdgeKey = MakeKey(GroupA, GroupB);
+            double Weight = std::binary_search(BorderKeys.begin(), BorderKeys.end(), EdgeKey) ? SIMPLIFY_BORDER_WEIGHT :
+                            std::binary_search(SeamKeys.begin(), SeamKeys.end(), EdgeKey) ? SIMPLIFY_SEAM_WEIGHT : 0.0;
+
+            if (Weight == 0.0)
+            {
+                continue;
+            }
+
+            const float* EdgeStart = &Positions[GroupA * 3];
+            const float* EdgeEnd = &Positions[GroupB * 3];
+            double Edge[3] = {EdgeEnd[0] - EdgeStart[0], EdgeEnd[1] - EdgeStart[1], EdgeEnd[2] - EdgeStart[2]};
+            double EdgeNormal[3] = {Edge[1] * C - Edge[2] * B, Edge[2] * A - Edge[0] * C, Edge[0] * B - Edge[1] * A};
+            double PlaneLength = std::sqrt(EdgeNormal[0] * EdgeNormal[0] + EdgeNormal[1] * EdgeNormal[1] + EdgeNormal[2] * EdgeNormal[2]);
+
+            if (PlaneLength == 0.0)
+            {
+                continue;
+            }
+
+            double EdgeA = EdgeNormal[0] / PlaneLength * Weight, EdgeB = EdgeNormal[1] / PlaneLength * Weight, EdgeC = EdgeNormal[2] / PlaneLength * Weight;
+            double EdgeD = -(EdgeA * EdgeStart[0] + EdgeB * EdgeStart[1] + EdgeC * EdgeStart[2]);
+
+            Quadrics[GroupA].AddPlane(EdgeA, EdgeB, EdgeC, EdgeD);
+            Quadrics[GroupB].AddPlane(EdgeA, EdgeB, EdgeC, EdgeD);
+        }
+    }
+
+    struct FCollapse
+    {
+        double Cost;
+        uint32_t From;
+        uint32_t To;
+    };
+
+    std::vector<uint32_t> Result = Indices;
+    std::vector<uint32_t> Remap(VertexCount);
+    std::vector<char> Touched(VertexCount);
+    std::vector<uint32_t> TriangleOffsets(VertexCount + 1);
+    std::vector<uint32_t> VertexTriangles;
+    std::vector<FCollapse> Collapses;
+    double MaxCost = 0.0;
+
+    auto FindWedgeTarget = [&](uint32_t Vertex, uint32_t TargetGroup)
+    {
+        for (uint32_t j = TriangleOffsets[Vertex]; j < TriangleOffsets[Vertex + 1]; ++j)
+        {
+            const uint32_t* Triangle = &Result[VertexTriangles[j] * 3];
+
+            for (int k = 0; k < 3; ++k)
+            {
+                if (static_cast<uint32_t>(Groups[Triangle[k]]) == TargetGroup)
+                {
+                    return Triangle[k];
+                }
+            }
+        }
+
+        return static_cast<uint32_t>(VertexCount);
+    };
+
+    while (Result.size() > TargetIndexCount)
+    {
+        std::fill(TriangleOffsets.begin(), TriangleOffsets.end(), 0);
+
+        for (uint32_t Index : Result)
+        {
+            ++TriangleOffsets[Index + 1];
+        }
+
+        for (std::size_t v = 0; v < VertexCount; ++v)
+        {
+            TriangleOffsets[v + 1] += TriangleOffsets[v];
+        }
+
+        VertexTriangles.resize(Result.size());
+        std::vector<uint32_t> Fill(TriangleOffsets.begin(), TriangleOffsets.end() - 1);
+
+        for (std::size_t i = 0; i < Result.size(); ++i)
+        {
+            VertexTriangles[Fill[Result[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        Collapses.clear();
+
+        for (std::size_t i = 0; i < Result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t A = static_cast<uint32_t>(Groups[Result[i + k]]);
+                uint32_t B = static_cast<uint32_t>(Groups[Result[i + (k + 1) % 3]]);
+
+                if (A > B)
+                {
+                    continue;
+                }
+
+                uint64_t EdgeKey = MakeKey(A, B);
+                FQuadric Combined = Quadrics[A];
+                Combined.Add(Quadrics[B]);
+
+                double CostToB = CanCollapse(A, EdgeKey) ? Combined.Evaluate(&Positions[B * 3]) : -1.0;
+                double CostToA = CanCollapse(B, EdgeKey) ? Combined.Evaluate(&Positions[A * 3]) : -1.0;
+
+                if (CostToB >= 0.0 && (CostToA < 0.0 || CostToB <= CostToA))
+                {
+                    Collapses.push_back({CostToB, A, B});
+                }
+                else if (CostToA >= 0.0)
+                {
+                    Collapses.push_back({CostToA, B, A});
+                }
+            }
+        }
+
+        std::sort(Collapses.begin(), Collapses.end(), [](const FCollapse& L, const FCollapse& R) { return L.Cost < R.Cost; });
+
+        for (std::size_t v = 0; v < VertexCount; ++v)
+        {
+            Remap[v] = static_cast<uint32_t>(v);
+        }
+
+        std::fill(Touched.begin(), Touched.end(), 0);
+
+        std::size_t TriangleCount = Result.size() / 3;
+        std::size_t CollapseCount = 0;
+
+        // Collapses that only become possible after this pass may be cheaper than the ones left at the
+        // end of the sorted list, so each pass only goes a bit past the cost it would need to hit the target
+        std::size_t CollapseGoal = (Result.size() - TargetIndexCount) / 6;
+        double CostLimit = Collapses.empty() ? 0.0 : Collapses[std::min(CollapseGoal, Collapses.size() - 1)].Cost * 1.5;
+        CostLimit = std::min(CostLimit, static_cast<double>(TargetError) * TargetError);
+
+        for (const FCollapse& Collapse : Collapses)
+        {
+            if (TriangleCount * 3 <= TargetIndexCount || Collapse.Cost > CostLimit)
+            {
+                break;
+            }
+
+            if (Touched[Collapse.From] || Touched[Collapse.To])
+            {
+                continue;
+            }
+
+            uint32_t Wedges[2];
+            uint32_t Targets[2];
+            uint32_t WedgeCount = 0;
+            bool bValid = true;
+
+            for (uint32_t Vertex = Collapse.From; bValid; )
+            {
+                Wedges[WedgeCount] = Vertex;
+                Targets[WedgeCount] = FindWedgeTarget(Vertex, Collapse.To);
+                bValid = Targets[WedgeCount] < VertexCount;
+                ++WedgeCount;
+
+                Vertex = NextWedge[Vertex];
+
+                if (Vertex == Collapse.From)
+                {
+                    break;
+                }
+            }
+
+            std::size_t RemovedTriangles = 0;
+
+            for (uint32_t w = 0; w < WedgeCount && bValid; ++w)
+            {
+                for (uint32_t j = TriangleOffsets[Wedges[w]]; j < TriangleOffsets[Wedges[w] + 1] && bValid; ++j)
+                {
+                    const uint32_t* Triangle = &Result[VertexTriangles[j] * 3];
+
+                    if (Triangle[0] == Targets[w] || Triangle[1] == Targets[w] || Triangle[2] == Targets[w])
+                    {
+                        ++RemovedTriangles;
+                        continue;
+                    }
+
+                    const float* Before[3];
+                    const float* After[3];
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        Before[k] = &Positions[Triangle[k] * 3];
+                        After[k] = Triangle[k] == Wedges[w] ? &Positions[Targets[w] * 3] : Before[k];
+                    }
+
+                    double NormalBefore[3], NormalAfter[3];
+                    ComputeTriangleNormal(Before[0], Before[1], Before[2], NormalBefore);
+                    ComputeTriangleNormal(After[0], After[1], After[2], NormalAfter);
+
+                    bValid = NormalBefore[0] * NormalAfter[0] + NormalBefore[1] * NormalAfter[1] + NormalBefore[2] * NormalAfter[2] > 0.0;
+                }
+            }
+
+            if (!bValid)
+            {
+                continue;
+            }
+
+            for (uint32_t w = 0; w < WedgeCount; ++w)
+            {
+                Remap[Wedges[w]] = Targets[w];
+
+                for (uint32_t j = TriangleOffsets[Wedges[w]]; j < TriangleOffsets[Wedges[w] + 1]; ++j)
+                {
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        Touched[Groups[Result[VertexTriangles[j] * 3 + k]]] = 1;
+                    }
+                }
+            }
+
+            Quadrics[Collapse.To].Add(Quadrics[Collapse.From]);
+            MaxCost = std::max(MaxCost, Collapse.Cost);
+            TriangleCount -= RemovedTriangles;
+            ++CollapseCount;
+        }
+
+        if (CollapseCount == 0)
+        {
+            break;
+        }
+
+        std::size_t Write = 0;
+
+        for (std::size_t i = 0; i < Result.size(); i += 3)
+        {
+            uint32_t A = Remap[Result[i]];
+            uint32_t B = Remap[Result[i + 1]];
+            uint32_t C = Remap[Result[i + 2]];
+
+            if (A != B && B != C && A != C)
+            {
+                Result[Write++] = A;
+                Result[Write++] = B;
+                Result[Write++] = C;
+            }
+        }
+
+        Result.resize(Write);
+    }
+
+    Error = static_cast<float>(std::sqrt(MaxCost));
+    return Result;
+}
@@ -0,0 +1,323 @@
+#pragma once
+
+#include "index_tuple_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+const uint32_t MESHLET_MAX_VERTICES = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+const float MESHLET_CONE_WEIGHT = 0.5f;
+
+struct FMeshlet
+{
+    float Center[3];
+    float Radius;
+    float ConeAxis[3];
+    float ConeCutoff;
+    uint32_t VertexOffset;
+    uint32_t TriangleOffset;
+    uint32_t VertexCount;
+    uint32_t TriangleCount;
+};
+
+struct FMeshletData
+{
+    std::vector<FMeshlet> Meshlets;
+    std::vector<uint32_t> Vertices;
+    std::vector<uint8_t> Triangles;
+};
+
+// A cluster is entirely back facing from CameraPosition when
+// dot(Center - CameraPosition, ConeAxis) >= ConeCutoff * length(Center - CameraPosition) + Radius
+static void ComputeTriangleUnitNormal(const float P0[3], const float P1[3], const float P2[3], float Normal[3])
+{
+    float E1[3] = {P1[0] - P0[0], P1[1] - P0[1], P1[2] - P0[2]};
+    float E2[3] = {P2[0] - P0[0], P2[1] - P0[1], P2[2] - P0[2]};
+    Normal[0] = E1[1] * E2[2] - E1[2] * E2[1];
+    Normal[1] = E1[2] * E2[0] - E1[0] * E2[2];
+    Normal[2] = E1[0] * E2[1] - E1[1] * E2[0];
+
+    float Length = std::sqrt(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Normal[i] = Length > 0.f ? Normal[i] / Length : 0.f;
+    }
+}
+
+static void ComputeMeshletBounds(FMeshlet& Meshlet, const FMeshletData& Data, const void* VertexData, std::size_t Stride, std::size_t PositionOffset)
+{
+    auto ReadPosition = [&](uint32_t LocalVertex, float Position[3])
+    {
+        std::memcpy(Position, static_cast<const char*>(VertexData) + Data.Vertices[Meshlet.VertexOffset + LocalVertex] * Stride + PositionOffset, sizeof(float) * 3);
+    };
+
+    float Min[3] = {INFINITY, INFINITY, INFINITY};
+    float Max[3] = {-INFINITY, -INFINITY, -INFINITY};
+
+    for (uint32_t v = 0; v < Meshlet.VertexCount; ++v)
+    {
+        float Position[3];
+        ReadPosition(v, Position);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            Min[i] = std::min(Min[i], Position[i]);
+            Max[i] = std::max(Max[i], Position[i]);
+        }
+    }
+
+    float RadiusSquared = 0.f;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Meshlet.Center[i] = (Min[i] + Max[i]) * 0.5f;
+    }
+
+    for (uint32_t v = 0; v < Meshlet.VertexCount; ++v)
+    {
+        float Position[3];
+        ReadPosition(v, Position);
+
+        float DX = Position[0] - Meshlet.Center[0], DY = Position[1] - Meshlet.Center[1], DZ = Position[2] - Meshlet.Center[2];
+        RadiusSquared = std::max(RadiusSquared, DX * DX + DY * DY + DZ * DZ);
+    }
+
+    Meshlet.Radius = std::sqrt(RadiusSquared);
+
+    std::vector<float> Normals(Meshlet.TriangleCount * 3, 0.f);
+    float Axis[3] = {0.f, 0.f, 0.f};
+
+    for (uint32_t t = 0; t < Meshlet.TriangleCount; ++t)
+    {
+        float P[3][3];
+
+        for (int k = 0; k < 3; ++k)
+        {
+            ReadPosition(Data.Triangles[Meshlet.TriangleOffset + t * 3 + k], P[k]);
+        }
+
+        float* Normal = &Normals[t * 3];
+        ComputeTriangleUnitNormal(P[0], P[1], P[2], Normal);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            Axis[i] += Normal[i];
+        }
+    }
+
+    float AxisLength = std::sqrt(Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2]);
+    float MinDot = 1.f;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Meshlet.ConeAxis[i] = AxisLength > 0.f ? Axis[i] / AxisLength : 0.f;
+    }
+
+    for (uint32_t t = 0; t < Meshlet.TriangleCount; ++t)
+    {
+        const float* Normal = &Normals[t * 3];
+
+        // Degenerate triangles have no facing and can not widen the cone
+        if (Normal[0] != 0.f || Normal[1] != 0.f || Normal[2] != 0.f)
+        {
+            MinDot = std::min(MinDot, Normal[0] * Meshlet.ConeAxis[0] + Normal[1] * Meshlet.ConeAxis[1] + Normal[2] * Meshlet.ConeAxis[2]);
+        }
+    }
+
+    // A cone of 90 degrees or more can not be back facing as a whole, a cutoff of 1 never passes the test
+    Meshlet.ConeCutoff = AxisLength > 0.f && MinDot > 0.f ? std::sqrt(1.f - MinDot * MinDot) : 1.f;
+}
+
+// Greedily grows each cluster with the adjacent triangle that adds the fewest new vertices,
+// weighted against triangles that widen the normal cone of the cluster. Adjacency goes through
+// vertex positions so clusters keep growing across UV seams.
+static FMeshletData BuildMeshlets(const uint32_t* Indices, std::size_t IndexCount, const void* VertexData, std::size_t VertexCount, std::size_t Stride, std::size_t PositionOffset)
+{
+    FMeshletData Data;
+    std::size_t TriangleCount = IndexCount / 3;
+
+    std::vector<float> Positions(VertexCount * 3);
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        std::memcpy(&Positions[v * 3], static_cast<const char*>(VertexData) + v * Stride + PositionOffset, sizeof(float) * 3);
+    }
+
+    std::vector<int> Groups = BuildCanonicalIndices(Positions, 3);
+    std::vector<uint32_t> TriangleOffsets(VertexCount + 1, 0);
+
+    for (std::size_t i = 0; i < IndexCount; ++i)
+    {
+        ++TriangleOffsets[Groups[Indices[i]] + 1];
+    }
+
+    for (std::size_t v = 0; v < VertexCount; ++v)
+    {
+        TriangleOffsets[v + 1] += TriangleOffsets[v];
+    }
+
+    std::vector<uint32_t> VertexTriangles(IndexCount);
+    std::vector<uint32_t> Fill(TriangleOffsets.begin(), TriangleOffsets.end() - 1);
+
+    for (std::size_t i = 0; i < IndexCount; ++i)
+    {
+        VertexTriangles[Fill[Groups[Indices[i]]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<float> TriangleNormals(TriangleCount * 3);
+
+    for (std::size_t t = 0; t < TriangleCount; ++t)
+    {
+        float P[3][3];
+
+        for (int k = 0; k < 3; ++k)
+        {
+            std::memcpy(P[k], &Positions[Indices[t * 3 + k] * 3], sizeof(float) * 3);
+        }
+
+        ComputeTriangleUnitNormal(P[0], P[1], P[2], &TriangleNormals[t * 3]);
+    }
+
+    std::vector<char> Emitted(TriangleCount, 0);
+    float NormalSum[3] = {0.f, 0.f, 0.f};
+    std::vector<uint8_t> LocalIndices(VertexCount, 0xFF);
+    std::size_t Cursor = 0;
+    FMeshlet Meshlet{};
+
+    auto FinishMeshlet = [&]()
+    {
+        if (Meshlet.TriangleCount == 0)
+        {
+            return;
+        }
+
+        for (uint32_t v = 0; v < Meshlet.VertexCount; ++v)
+        {
+            LocalIndices[Data.Vertices[Meshlet.VertexOffset + v]] = 0xFF;
+        }
+
+        ComputeMeshletBounds(Meshlet, Data, VertexData, Stride, PositionOffset);
+        Data.Meshlets.push_back(Meshlet);
+
+        while (Data.Triangles.size() % 4 != 0)
+        {
+            Data.Triangles.push_back(0);
+        }
+
+        Meshlet = FMeshlet{};
+        NormalSum[0] = NormalSum[1] = NormalSum[2] = 0.f;
+        Meshlet.VertexOffset = static_cast<uint32_t>(Data.Vertices.size());
+        Meshlet.TriangleOffset = static_cast<uint32_t>(Data.Triangles.size());
+    };
+
+    auto CountNewVertices = [&](std::size_t Triangle)
+    {
+        uint32_t NewVertices = 0;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            NewVertices += LocalIndices[Indices[Triangle * 3 + k]] == 0xFF;
+        }
+
+        return NewVertices;
+    };
+
+    for (std::size_t Emit = 0; Emit < TriangleCount; ++Emit)
+    {
+        std::size_t Best = TriangleCount;
+        uint32_t BestNewVertices = 4;
+        float BestScore = INFINITY;
+        float NormalLength = std::sqrt(NormalSum[0] * NormalSum[0] + NormalSum[1] * NormalSum[1] + NormalSum[2] * NormalSum[2]);
+
+        for (uint32_t v = 0; v < Meshlet.VertexCount; ++v)
+        {
+            uint32_t Vertex = static_cast<uint32_t>(Groups[Data.Vertices[Meshlet.VertexOffset + v]]);
+
+            for (uint32_t j = TriangleOffsets[Vertex]; j < TriangleOffsets[Vertex + 1]; ++j)
+            {
+                uint32_t Triangle = VertexTriangles[j];
+
+                if (Emitted[Triangle])
+                {
+                    continue;
+                }
+
+                uint32_t NewVertices = CountNewVertices(Triangle);
+                const float* Normal = &TriangleNormals[Triangle * 3];
+                float Alignment = NormalLength > 0.f ? (Normal[0] * NormalSum[0] + Normal[1] * NormalSum[1] + Normal[2] * NormalSum[2]) / NormalLength : 1.f;
+                float Score = static_cast<float>(NewVertices) + MESHLET_CONE_WEIGHT * (1.f - Alignment);
+
+                if (Score < BestScore || (Score == BestScore && Triangle < Best))
+                {
+                    Best = Triangle;
+                    BestNewVertices = NewVertices;
+                    BestScore = Score;
+                }
+            }
+        }
+
+        if (Best == TriangleCount)
+        {
+            while (Emitted[Cursor])
+            {
+                ++Cursor;
+            }
+
+            Best = Cursor;
+            BestNewVertices = CountNewVertices(Best);
+        }
+
+        if (Meshlet.VertexCount + BestNewVertices > MESHLET_MAX_VERTICES || Meshlet.TriangleCount + 1 > MESHLET_MAX_TRIANGLES)
+        {
+            FinishMeshlet();
+            --Emit;
+            continue;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t Vertex = Indices[Best * 3 + k];
+
+            if (LocalIndices[Vertex] == 0xFF)
+            {
+                LocalIndices[Vertex] = static_cast<uint8_t>(Meshlet.VertexCount++);
+                Data.Vertices.push_back(Vertex);
+            }
+
+            Data.Triangles.push_back(LocalIndices[Vertex]);
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            NormalSum[i] += TriangleNormals[Best * 3 + i];
+        }
+
+        ++Meshlet.TriangleCount;
+        Emitted[Best] = 1;
+    }
+
+    FinishMeshlet();
+
+    return Data;
+}
+
+static void AppendMeshlets(FMeshletData& Destination, const FMeshletData& Source)
+{
+    uint32_t VertexBase = static_cast<uint32_t>(Destination.Vertices.size());
+    uint32_t TriangleBase = static_cast<uint32_t>(Destination.Triangles.size());
+
+    for (FMeshlet Meshlet : Source.Meshlets)
+    {
+        Meshlet.VertexOffset += VertexBase;
+        Meshlet.TriangleOffset += TriangleBase;
+        Destination.Meshlets.push_back(Meshlet);
+    }
+
+    Destination.Vertices.insert(Destination.Vertices.end(), Source.Vertices.begin(), Source.Vertices.end());
+    Destination.Triangles.insert(Destination.Triangles.end(), Source.Triangles.begin(), Source.Triangles.end());
+}
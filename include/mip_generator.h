@@ -0,0 +1,193 @@
+#pragma once
+
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MIP_GENERATOR_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define MIP_GENERATOR_NEON
+#include <arm_neon.h>
+#endif
+
+const std::size_t MIP_GENERATOR_MIN_TEXELS_PER_THREAD = 1 << 15;
+
+// RGBA with 16 bits per channel, color in linear space. The whole chain is filtered at this precision
+// and only quantized back to sRGB8 per level, so rounding does not accumulate down the chain.
+struct FLinearMip
+{
+    uint32_t Width;
+    uint32_t Height;
+    std::vector<uint16_t> Texels;
+};
+
+static const std::array<uint16_t, 256>& GetSrgbToLinear16Table()
+{
+    static const std::array<uint16_t, 256> Table = []()
+    {
+        std::array<uint16_t, 256> Values{};
+
+        for (int i = 0; i < 256; ++i)
+        {
+            double Value = i / 255.;
+            Value = Value <= 0.04045 ? Value / 12.92 : std::pow((Value + 0.055) / 1.055, 2.4);
+            Values[i] = static_cast<uint16_t>(Value * 65535. + 0.5);
+        }
+
+        return Values;
+    }();
+
+    return Table;
+}
+
+static const std::vector<uint8_t>& GetLinear16ToSrgbTable()
+{
+    static const std::vector<uint8_t> Table = []()
+    {
+        std::vector<uint8_t> Values(65536);
+
+        for (int i = 0; i < 65536; ++i)
+        {
+            double Value = i / 65535.;
+            Value = Value <= 0.0031308 ? Value * 12.92 : 1.055 * std::pow(Value, 1. / 2.4) - 0.055;
+            Values[i] = static_cast<uint8_t>(Value * 255. + 0.5);
+        }
+
+        return Values;
+    }();
+
+    return Table;
+}
+
+// Splits [0, RowCount) into one band per thread, small levels stay on the calling thread
+template<typename FunctionType>
+static void ParallelForRows(uint32_t RowCount, std::size_t TexelsPerRow, FunctionType Function)
+{
+    std::size_t MaxThreads = std::max<std::size_t>(1, RowCount * TexelsPerRow / MIP_GENERATOR_MIN_TEXELS_PER_THREAD);
+    std::size_t ThreadCount = std::min<std::size_t>({std::max(1u, std::thread::hardware_concurrency()), MaxThreads, RowCount});
+
+    std::vector<std::thread> Workers;
+
+    for (std::size_t i = 1; i < ThreadCount; ++i)
+    {
+        Workers.emplace_back(Function, static_cast<uint32_t>(RowCount * i / ThreadCount), static_cast<uint32_t>(RowCount * (i + 1) / ThreadCount));
+    }
+
+    Function(0, static_cast<uint32_t>(RowCount / ThreadCount));
+
+    for (auto& Worker : Workers)
+    {
+        Worker.join();
+    }
+}
+
+static void DecodeSrgbRows(const uint8_t* Pixels, FLinearMip& Mip, uint32_t FirstRow, uint32_t EndRow)
+{
+    const std::array<uint16_t, 256>& ToLinear = GetSrgbToLinear16Table();
+
+    for (std::size_t i = static_cast<std::size_t>(FirstRow) * Mip.Width * 4; i < static_cast<std::size_t>(EndRow) * Mip.Width * 4; i += 4)
+    {
+        Mip.Texels[i + 0] = ToLinear[Pixels[i + 0]];
+        Mip.Texels[i + 1] = ToLinear[Pixels[i + 1]];
+        Mip.Texels[i + 2] = ToLinear[Pixels[i + 2]];
+        Mip.Texels[i + 3] = static_cast<uint16_t>(Pixels[i + 3] * 257);
+    }
+}
+
+static void EncodeSrgbRows(const FLinearMip& Mip, uint8_t* Pixels, uint32_t FirstRow, uint32_t EndRow)
+{
+    const std::vector<uint8_t>& ToSrgb = GetLinear16ToSrgbTable();
+
+    for (std::size_t i = static_cast<std::size_t>(FirstRow) * Mip.Width * 4; i < static_cast<std::size_t>(EndRow) * Mip.Width * 4; i += 4)
+    {
+        Pixels[i + 0] = ToSrgb[Mip.Texels[i + 0]];
+        Pixels[i + 1] = ToSrgb[Mip.Texels[i + 1]];
+        Pixels[i + 2] = ToSrgb[Mip.Texels[i + 2]];
+        Pixels[i + 3] = static_cast<uint8_t>((Mip.Texels[i + 3] * 255u + 32767u) / 65535u);
+    }
+}
+
+static uint16_t AverageLinear(uint16_t A, uint16_t B)
+{
+    return static_cast<uint16_t>((A + B + 1) >> 1);
+}
+
+// 2x2 box filter, rows are averaged first and then columns, rounding like the SIMD averages do.
+// Odd source sizes drop their last row or column, the same footprint vkCmdBlitImage uses for halving.
+static void DownsampleRows(const FLinearMip& Source, FLinearMip& Mip, uint32_t FirstRow, uint32_t EndRow)
+{
+    for (uint32_t y = FirstRow; y < EndRow; ++y)
+    {
+        const uint16_t* Row0 = &Source.Texels[static_cast<std::size_t>(std::min(y * 2, Source.Height - 1)) * Source.Width * 4];
+        const uint16_t* Row1 = &Source.Texels[static_cast<std::size_t>(std::min(y * 2 + 1, Source.Height - 1)) * Source.Width * 4];
+        uint16_t* Destination = &Mip.Texels[static_cast<std::size_t>(y) * Mip.Width * 4];
+        uint32_t x = 0;
+
+        // Two destination texels from four source texels of both rows per step
+#if defined(MIP_GENERATOR_SSE2)
+        for (; x + 2 <= Mip.Width && x * 2 + 4 <= Source.Width; x += 2)
+        {
+            __m128i A = _mm_avg_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Row0 + x * 8)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row1 + x * 8)));
+            __m128i B = _mm_avg_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Row0 + x * 8 + 8)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row1 + x * 8 + 8)));
+            __m128i Result = _mm_avg_epu16(_mm_unpacklo_epi64(A, B), _mm_unpackhi_epi64(A, B));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Destination + x * 4), Result);
+        }
+#elif defined(MIP_GENERATOR_NEON)
+        for (; x + 2 <= Mip.Width && x * 2 + 4 <= Source.Width; x += 2)
+        {
+            uint16x8_t A = vrhaddq_u16(vld1q_u16(Row0 + x * 8), vld1q_u16(Row1 + x * 8));
+            uint16x8_t B = vrhaddq_u16(vld1q_u16(Row0 + x * 8 + 8), vld1q_u16(Row1 + x * 8 + 8));
+            uint16x8_t Result = vrhaddq_u16(vcombine_u16(vget_low_u16(A), vget_low_u16(B)), vcombine_u16(vget_high_u16(A), vget_high_u16(B)));
+            vst1q_u16(Destination + x * 4, Result);
+        }
+#endif
+
+        for (; x < Mip.Width; ++x)
+        {
+            uint32_t X0 = std::min(x * 2, Source.Width - 1);
+            uint32_t X1 = std::min(x * 2 + 1, Source.Width - 1);
+
+            for (int c = 0; c < 4; ++c)
+            {
+                Destination[x * 4 + c] = AverageLinear(AverageLinear(Row0[X0 * 4 + c], Row1[X0 * 4 + c]), AverageLinear(Row0[X1 * 4 + c], Row1[X1 * 4 + c]));
+            }
+        }
+    }
+}
+
+// Full chain for an RGBA8 sRGB image, color channels are filtered in linear space and alpha as is
+static std::vector<FTextureMip> GenerateMipChain(const uint8_t* Pixels, uint32_t Width, uint32_t Height)
+{
+    uint32_t LevelCount = std::min(GetTextureMipLevelCount(Width, Height), TEXTURE_CACHE_MAX_LEVELS);
+
+    std::vector<FTextureMip> Mips(LevelCount);
+    Mips[0] = {Width, Height, std::vector<uint8_t>(Pixels, Pixels + static_cast<std::size_t>(Width) * Height * 4)};
+
+    FLinearMip Source{Width, Height, std::vector<uint16_t>(static_cast<std::size_t>(Width) * Height * 4)};
+    ParallelForRows(Height, Width, [&](uint32_t FirstRow, uint32_t EndRow) { DecodeSrgbRows(Pixels, Source, FirstRow, EndRow); });
+
+    for (uint32_t Level = 1; Level < LevelCount; ++Level)
+    {
+        FLinearMip Mip{std::max(Source.Width / 2, 1u), std::max(Source.Height / 2, 1u), {}};
+        Mip.Texels.resize(static_cast<std::size_t>(Mip.Width) * Mip.Height * 4);
+        Mips[Level] = {Mip.Width, Mip.Height, std::vector<uint8_t>(Mip.Texels.size())};
+
+        ParallelForRows(Mip.Height, Mip.Width, [&](uint32_t FirstRow, uint32_t EndRow)
+        {
+            DownsampleRows(Source, Mip, FirstRow, EndRow);
+            EncodeSrgbRows(Mip, Mips[Level].Data.data(), FirstRow, EndRow);
+        });
+
+        Source = std::move(Mip);
+    }
+
+    return Mips;
+}
@@ -0,0 +1,495 @@
+#pragma once
+
+#include "index_tuple_map.h"
+#include "mapped_file.h"
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "meshlet_builder.h"
+#include "obj_parser.h"
+#include "vertex_format.h"
+#include "vertex_quantization.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const std::size_t MAX_16BIT_INDEXED_VERTICES = 1 << 16;
+const uint32_t MODEL_LOD_COUNT = 4;
+const float LOD_TARGET_ERROR = 0.05f;
+const float LOD_MIN_REDUCTION = 0.85f;
+
+struct FCookedModel
+{
+    std::vector<Vertex> Vertices;
+    std::vector<uint32_t> Indices;
+    std::vector<uint16_t> CompactIndices;
+    std::vector<char> PackedVertices;
+    FMeshletData Meshlets;
+    FMeshBounds Bounds{};
+    std::vector<FMeshLod> Lods;
+    std::vector<FMeshSubmesh> Submeshes;
+    std::vector<FMeshMaterial> Materials;
+    uint32_t IndexSize = sizeof(uint32_t);
+};
+
+// Edits to the material libraries change the submeshes and textures, so they are part of the source as well
+static uint64_t HashModelSources(const std::string& ModelPath, bool& bFound)
+{
+    FMappedFile ModelFile(ModelPath);
+    bFound = ModelFile.GetData() != nullptr;
+
+    if (!bFound)
+    {
+        return 0;
+    }
+
+    uint64_t SourceHash = HashBytes(ModelFile.GetData(), ModelFile.GetSize());
+
+    for (const auto& FileName : FindObjMaterialLibraries(ModelFile.GetData(), ModelFile.GetData() + ModelFile.GetSize()))
+    {
+        FMappedFile LibraryFile((std::filesystem::path(ModelPath).parent_path() / FileName).string());
+
+        if (LibraryFile.GetData() != nullptr)
+        {
+            uint64_t Hashes[2] = {SourceHash, HashBytes(LibraryFile.GetData(), LibraryFile.GetSize())};
+            SourceHash = HashBytes(Hashes, sizeof(Hashes));
+        }
+    }
+
+    return SourceHash;
+}
+
+// Stable counting sort of the triangles into one contiguous submesh per material
+static void GroupTrianglesByMaterial(FCookedModel& Model, const std::vector<uint32_t>& TriangleMaterials)
+{
+    std::vector<uint32_t> SubmeshOffsets(Model.Materials.size(), 0);
+
+    for (uint32_t Material : TriangleMaterials)
+    {
+        SubmeshOffsets[Material] += 3;
+    }
+
+    Model.Submeshes.clear();
+    uint32_t FirstIndex = 0;
+
+    for (uint32_t m = 0; m < Model.Materials.size(); ++m)
+    {
+        Model.Submeshes.push_back({FirstIndex, SubmeshOffsets[m], m, 0, 0});
+        SubmeshOffsets[m] = FirstIndex;
+        FirstIndex += Model.Submeshes.back().IndexCount;
+    }
+
+    std::vector<uint32_t> GroupedIndices(Model.Indices.size());
+
+    for (std::size_t t = 0; t < TriangleMaterials.size(); ++t)
+    {
+        uint32_t& Offset = SubmeshOffsets[TriangleMaterials[t]];
+        std::copy(Model.Indices.begin() + t * 3, Model.Indices.begin() + t * 3 + 3, GroupedIndices.begin() + Offset);
+        Offset += 3;
+    }
+
+    Model.Indices.swap(GroupedIndices);
+}
+
+// Materials without a diffuse texture keep an empty path, the runtime draws them with its default texture
+static void ImportModel(FCookedModel& Model, const std::string& ModelPath)
+{
+    tinyobj::attrib_t Attrib;
+    std::vector<tinyobj::shape_t> Shapes;
+    std::vector<tinyobj::material_t> Materials;
+    std::string Warn, Err;
+
+    std::string ModelDirectory = std::filesystem::path(ModelPath).parent_path().generic_string();
+
+    Shapes.resize(1);
+
+    if (!LoadObjParallel(ModelPath, Attrib, Shapes[0], Materials))
+    {
+        Attrib = tinyobj::attrib_t();
+        Shapes.clear();
+        Materials.clear();
+
+        if (!tinyobj::LoadObj(&Attrib, &Shapes, &Materials, &Warn, &Err, ModelPath.c_str(), ModelDirectory.c_str()))
+        {
+            throw std::runtime_error(Warn + Err);
+        }
+    }
+
+    // Materials are keyed by their diffuse texture, in the order the model first uses them
+    std::unordered_map<std::string, uint32_t> MaterialSlots;
+    std::vector<uint32_t> MaterialIdSlots(Materials.size() + 1, UINT32_MAX);
+    Model.Materials.clear();
+
+    auto GetMaterialSlot = [&](int MaterialId)
+    {
+        bool bHasMaterial = MaterialId >= 0 && MaterialId < static_cast<int>(Materials.size());
+        uint32_t& Slot = MaterialIdSlots[bHasMaterial ? MaterialId + 1 : 0];
+
+        if (Slot == UINT32_MAX)
+        {
+            std::string TextureName = bHasMaterial ? Materials[MaterialId].diffuse_texname : std::string();
+            std::string TexturePath = TextureName.empty() ? std::string() : (std::filesystem::path(ModelDirectory) / TextureName).generic_string();
+            auto Result = MaterialSlots.emplace(TexturePath, static_cast<uint32_t>(Model.Materials.size()));
+
+            if (Result.second)
+            {
+                if (TexturePath.size() >= MESH_CACHE_MAX_PATH)
+                {
+                    throw std::runtime_error("Failed to store material texture path " + TexturePath + "!");
+                }
+
+                FMeshMaterial Material{};
+                memcpy(Material.DiffuseTexture, TexturePath.c_str(), TexturePath.size());
+                Model.Materials.push_back(Material);
+            }
+
+            Slot = Result.first->second;
+        }
+
+        return Slot;
+    };
+
+    std::size_t CornerCount = 0;
+
+    for (const auto& Shape : Shapes)
+    {
+        CornerCount += Shape.mesh.indices.size();
+    }
+
+    auto PositionIndices = BuildCanonicalIndices(Attrib.vertices, 3);
+    auto TexCoordIndices = BuildCanonicalIndices(Attrib.texcoords, 2);
+
+    FIndexTupleMap UniqueVertices(CornerCount);
+    std::vector<uint32_t> TriangleMaterials;
+    Model.Indices.reserve(CornerCount);
+    TriangleMaterials.reserve(CornerCount / 3);
+
+    for (const auto& Shape : Shapes)
+    {
+        for (std::size_t Triangle = 0; Triangle < Shape.mesh.indices.size() / 3; ++Triangle)
+        {
+            TriangleMaterials.push_back(GetMaterialSlot(Triangle < Shape.mesh.material_ids.size() ? Shape.mesh.material_ids[Triangle] : -1));
+        }
+
+        for (const auto& Index : Shape.mesh.indices)
+        {
+            // Vertex has no normal, so corners that only differ in normal_index share one vertex.
+            // Positions and texcoords are keyed by their first index with identical values, which
+            // matches deduplicating on the vertex values themselves.
+            auto Result = UniqueVertices.FindOrInsert({PositionIndices[Index.vertex_index], -1, TexCoordIndices[Index.texcoord_index]}, static_cast<uint32_t>(Model.Vertices.size()));
+
+            if (Result.second)
+            {
+                Vertex Vert{};
+
+                Vert.Pos = {
+                        Attrib.vertices[3 * Index.vertex_index + 0],
+                        Attrib.vertices[3 * Index.vertex_index + 1],
+                        Attrib.vertices[3 * Index.vertex_index + 2]
+                };
+
+                Vert.TexCoord = {
+                        Attrib.texcoords[2 * Index.texcoord_index + 0],
+                        1.f - Attrib.texcoords[2 * Index.texcoord_index + 1],
+                };
+
+                Vert.Color = {1.f, 1.f, 1.f};
+
+                Model.Vertices.push_back(Vert);
+            }
+
+            Model.Indices.push_back(Result.first);
+        }
+    }
+
+    GroupTrianglesByMaterial(Model, TriangleMaterials);
+}
+
+static void OptimizeModel(FCookedModel& Model, std::ostream& Log)
+{
+    std::vector<Vertex>& Vertices = Model.Vertices;
+    std::vector<uint32_t>& Indices = Model.Indices;
+    uint32_t PackedStride = GetVertexLayout(MODEL_VERTEX_FORMAT).Stride;
+
+    auto CacheStatsBefore = AnalyzeVertexCache(Indices, Vertices.size(), VERTEX_CACHE_ANALYSIS_SIZE);
+    float OverdrawBefore = AnalyzeOverdraw(Indices, Vertices.data(), Vertices.size(), sizeof(Vertex), offsetof(Vertex, Pos));
+    float OverfetchBefore = AnalyzeVertexFetch(Indices, Vertices.size(), PackedStride);
+
+    // Triangles are only reordered within their submesh, the vertex fetch order spans the whole model
+    for (const auto& Submesh : Model.Submeshes)
+    {
+        std::vector<uint32_t> SubmeshIndices(Indices.begin() + Submesh.FirstIndex, Indices.begin() + Submesh.FirstIndex + Submesh.IndexCount);
+
+        OptimizeVertexCache(SubmeshIndices, Vertices.size());
+        OptimizeOverdraw(SubmeshIndices, Vertices.data(), Vertices.size(), sizeof(Vertex), offsetof(Vertex, Pos), OVERDRAW_CLUSTER_THRESHOLD);
+
+        std::copy(SubmeshIndices.begin(), SubmeshIndices.end(), Indices.begin() + Submesh.FirstIndex);
+    }
+
+    OptimizeVertexFetch(Vertices, Indices);
+
+    auto CacheStatsAfter = AnalyzeVertexCache(Indices, Vertices.size(), VERTEX_CACHE_ANALYSIS_SIZE);
+    float OverdrawAfter = AnalyzeOverdraw(Indices, Vertices.data(), Vertices.size(), sizeof(Vertex), offsetof(Vertex, Pos));
+    float OverfetchAfter = AnalyzeVertexFetch(Indices, Vertices.size(), PackedStride);
+
+    Log << "Vertex cache ACMR " << CacheStatsBefore.Acmr << " -> " << CacheStatsAfter.Acmr
+        << ", ATVR " << CacheStatsBefore.Atvr << " -> " << CacheStatsAfter.Atvr << std::endl;
+    Log << "Overdraw " << OverdrawBefore << " -> " << OverdrawAfter
+        << ", vertex overfetch " << OverfetchBefore << " -> " << OverfetchAfter << std::endl;
+}
+
+// Positions used by more than one submesh, simplifying the submeshes apart must not open cracks between them
+static std::vector<char> FindSubmeshBorderVertices(const FCookedModel& Model)
+{
+    if (Model.Submeshes.size() < 2)
+    {
+        return {};
+    }
+
+    std::vector<float> Positions(Model.Vertices.size() * 3);
+
+    for (std::size_t v = 0; v < Model.Vertices.size(); ++v)
+    {
+        std::memcpy(&Positions[v * 3], &Model.Vertices[v].Pos, sizeof(float) * 3);
+    }
+
+    std::vector<int> Groups = BuildCanonicalIndices(Positions, 3);
+    std::vector<uint32_t> GroupSubmeshes(Model.Vertices.size(), UINT32_MAX);
+    std::vector<char> BorderVertices(Model.Vertices.size(), 0);
+
+    for (uint32_t s = 0; s < Model.Submeshes.size(); ++s)
+    {
+        for (uint32_t i = Model.Submeshes[s].FirstIndex; i < Model.Submeshes[s].FirstIndex + Model.Submeshes[s].IndexCount; ++i)
+        {
+            uint32_t& GroupSubmesh = GroupSubmeshes[Groups[Model.Indices[i]]];
+
+            if (GroupSubmesh != UINT32_MAX && GroupSubmesh != s)
+            {
+                BorderVertices[Groups[Model.Indices[i]]] = 1;
+            }
+
+            GroupSubmesh = s;
+        }
+    }
+
+    return BorderVertices;
+}
+
+static bool HasTriangleArea(const std::vector<uint32_t>& Indices, const std::vector<Vertex>& Vertices)
+{
+    for (std::size_t i = 0; i < Indices.size(); i += 3)
+    {
+        double Normal[3];
+        ComputeTriangleNormal(&Vertices[Indices[i]].Pos.X, &Vertices[Indices[i + 1]].Pos.X, &Vertices[Indices[i + 2]].Pos.X, Normal);
+
+        if (Normal[0] != 0.0 || Normal[1] != 0.0 || Normal[2] != 0.0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void GenerateModelLods(FCookedModel& Model, std::ostream& Log)
+{
+    std::vector<Vertex>& Vertices = Model.Vertices;
+    std::vector<uint32_t>& Indices = Model.Indices;
+    uint32_t SubmeshCount = static_cast<uint32_t>(Model.Submeshes.size());
+    Model.Lods = {{0, static_cast<uint32_t>(Indices.size()), 0.f, 0, SubmeshCount}};
+
+    float TargetError = LOD_TARGET_ERROR * GetMeshBoundsRadius(Model.Bounds);
+    std::vector<char> LockedVertices = FindSubmeshBorderVertices(Model);
+    std::vector<std::vector<uint32_t>> SourceIndices(SubmeshCount);
+
+    for (uint32_t s = 0; s < SubmeshCount; ++s)
+    {
+        SourceIndices[s].assign(Indices.begin() + Model.Submeshes[s].FirstIndex, Indices.begin() + Model.Submeshes[s].FirstIndex + Model.Submeshes[s].IndexCount);
+    }
+
+    while (Model.Lods.size() < MODEL_LOD_COUNT)
+    {
+        std::vector<std::vector<uint32_t>> LodIndices(SubmeshCount);
+        std::size_t SourceIndexCount = 0;
+        std::size_t LodIndexCount = 0;
+        float LodError = 0.f;
+
+        for (uint32_t s = 0; s < SubmeshCount; ++s)
+        {
+            float Error;
+            LodIndices[s] = SimplifyMesh(SourceIndices[s], Vertices.data(), Vertices.size(), sizeof(Vertex), offsetof(Vertex, Pos), SourceIndices[s].size() / 2, TargetError, Error, LockedVertices);
+            SourceIndexCount += SourceIndices[s].size();
+            LodIndexCount += LodIndices[s].size();
+            LodError = std::max(LodError, Error);
+        }
+
+        // A submesh simplified away entirely, or down to triangles without area, would vanish at the distances this LOD
+        // is selected for
+        bool bDegenerate = false;
+
+        for (uint32_t s = 0; s < SubmeshCount; ++s)
+        {
+            bDegenerate = bDegenerate || (!SourceIndices[s].empty() && !HasTriangleArea(LodIndices[s], Vertices));
+        }
+
+        if (bDegenerate || LodIndexCount > SourceIndexCount * LOD_MIN_REDUCTION)
+        {
+            break;
+        }
+
+        FMeshLod Lod{static_cast<uint32_t>(Indices.size()), static_cast<uint32_t>(LodIndexCount), Model.Lods.back().Error + LodError, static_cast<uint32_t>(Model.Submeshes.size()), SubmeshCount};
+
+        for (uint32_t s = 0; s < SubmeshCount; ++s)
+        {
+            OptimizeVertexCache(LodIndices[s], Vertices.size());
+
+            Model.Submeshes.push_back({static_cast<uint32_t>(Indices.size()), static_cast<uint32_t>(LodIndices[s].size()), Model.Submeshes[s].Material, 0, 0});
+            Indices.insert(Indices.end(), LodIndices[s].begin(), LodIndices[s].end());
+        }
+
+        Model.Lods.push_back(Lod);
+        SourceIndices.swap(LodIndices);
+
+        Log << "LOD " << Model.Lods.size() - 1 << ": " << Model.Lods.back().IndexCount / 3 << " triangles, error " << Model.Lods.back().Error << std::endl;
+    }
+}
+
+static void BuildModelMeshlets(FCookedModel& Model, std::ostream& Log)
+{
+    Model.Meshlets = {};
+
+    for (uint32_t s = 0; s < Model.Lods[0].SubmeshCount; ++s)
+    {
+        FMeshSubmesh& Submesh = Model.Submeshes[s];
+        Submesh.FirstMeshlet = static_cast<uint32_t>(Model.Meshlets.Meshlets.size());
+        AppendMeshlets(Model.Meshlets, BuildMeshlets(Model.Indices.data() + Submesh.FirstIndex, Submesh.IndexCount, Model.Vertices.data(), Model.Vertices.size(), sizeof(Vertex), offsetof(Vertex, Pos)));
+        Submesh.MeshletCount = static_cast<uint32_t>(Model.Meshlets.Meshlets.size()) - Submesh.FirstMeshlet;
+    }
+
+    std::size_t ClusterVertices = 0;
+    std::size_t ClusterTriangles = 0;
+    std::size_t ConeCullable = 0;
+
+    for (const auto& Meshlet : Model.Meshlets.Meshlets)
+    {
+        ClusterVertices += Meshlet.VertexCount;
+        ClusterTriangles += Meshlet.TriangleCount;
+        ConeCullable += Meshlet.ConeCutoff < 1.f;
+    }
+
+    double MeshletCount = static_cast<double>(Model.Meshlets.Meshlets.size());
+
+    Log << "Meshlets: " << Model.Meshlets.Meshlets.size() << " clusters, "
+        << ClusterVertices / MeshletCount << " vertices (" << 100. * ClusterVertices / (MeshletCount * MESHLET_MAX_VERTICES) << "% fill), "
+        << ClusterTriangles / MeshletCount << " triangles (" << 100. * ClusterTriangles / (MeshletCount * MESHLET_MAX_TRIANGLES) << "% fill), "
+        << 100. * ConeCullable / MeshletCount << "% with a usable normal cone" << std::endl;
+}
+
+static void CompactModelIndices(FCookedModel& Model)
+{
+    if (Model.Vertices.size() > MAX_16BIT_INDEXED_VERTICES)
+    {
+        Model.IndexSize = sizeof(uint32_t);
+        return;
+    }
+
+    Model.IndexSize = sizeof(uint16_t);
+    Model.CompactIndices.resize(Model.Indices.size());
+
+    for (std::size_t i = 0; i < Model.Indices.size(); ++i)
+    {
+        Model.CompactIndices[i] = static_cast<uint16_t>(Model.Indices[i]);
+    }
+}
+
+static void PackModelVertices(FCookedModel& Model, const FMeshVertexLayout& Layout)
+{
+    FMatrix4 Dequantization = GetPositionDequantization(Model.Bounds);
+    FVector4 TexCoordDequantization = GetTexCoordDequantization(Model.Bounds);
+    Model.PackedVertices.assign(Model.Vertices.size() * Layout.Stride, 0);
+
+    for (std::size_t v = 0; v < Model.Vertices.size(); ++v)
+    {
+        const Vertex& Vert = Model.Vertices[v];
+        char* Packed = Model.PackedVertices.data() + v * Layout.Stride;
+
+        for (uint32_t a = 0; a < Layout.AttributeCount; ++a)
+        {
+            char* Attribute = Packed + Layout.Attributes[a].Offset;
+
+            switch (static_cast<VkFormat>(Layout.Attributes[a].Format))
+            {
+                case VK_FORMAT_R16G16B16A16_SNORM:
+                {
+                    int16_t Position[4] = {
+                            QuantizeSnorm16((Vert.Pos.X - Dequantization.Data[3].X) / Dequantization.Data[0].X),
+                            QuantizeSnorm16((Vert.Pos.Y - Dequantization.Data[3].Y) / Dequantization.Data[1].Y),
+                            QuantizeSnorm16((Vert.Pos.Z - Dequantization.Data[3].Z) / Dequantization.Data[2].Z),
+                            0
+                    };
+                    memcpy(Attribute, Position, sizeof(Position));
+                    break;
+                }
+                case VK_FORMAT_R32G32B32_SFLOAT:
+                    memcpy(Attribute, Layout.Attributes[a].Location == 0 ? &Vert.Pos : &Vert.Color, sizeof(FVector3));
+                    break;
+                case VK_FORMAT_R8G8B8A8_UNORM:
+                {
+                    uint8_t Color[4] = {QuantizeUnorm8(Vert.Color.X), QuantizeUnorm8(Vert.Color.Y), QuantizeUnorm8(Vert.Color.Z), 255};
+                    memcpy(Attribute, Color, sizeof(Color));
+                    break;
+                }
+                case VK_FORMAT_R32G32_SFLOAT:
+                    memcpy(Attribute, &Vert.TexCoord, sizeof(FVector2));
+                    break;
+                case VK_FORMAT_R16G16_SFLOAT:
+                {
+                    uint16_t TexCoord[2] = {FloatToHalf(Vert.TexCoord.X), FloatToHalf(Vert.TexCoord.Y)};
+                    memcpy(Attribute, TexCoord, sizeof(TexCoord));
+                    break;
+                }
+                case VK_FORMAT_R16G16_UNORM:
+                {
+                    uint16_t TexCoord[2] = {
+                            QuantizeUnorm16((Vert.TexCoord.X - TexCoordDequantization.Z) / TexCoordDequantization.X),
+                            QuantizeUnorm16((Vert.TexCoord.Y - TexCoordDequantization.W) / TexCoordDequantization.Y)
+                    };
+                    memcpy(Attribute, TexCoord, sizeof(TexCoord));
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Failed to pack vertex attribute format!");
+            }
+        }
+    }
+}
+
+static bool CookModel(const std::string& ModelPath, const std::string& CookedPath, uint64_t SourceHash, std::ostream& Log)
+{
+    FCookedModel Model;
+    FMeshVertexLayout Layout = GetVertexLayout(MODEL_VERTEX_FORMAT);
+
+    ImportModel(Model, ModelPath);
+    OptimizeModel(Model, Log);
+
+    Model.Bounds = ComputeMeshBounds(Model.Vertices.data(), Model.Vertices.size(), sizeof(Vertex), offsetof(Vertex, Pos));
+    ComputeTexCoordBounds(Model.Bounds, Model.Vertices);
+    GenerateModelLods(Model, Log);
+    BuildModelMeshlets(Model, Log);
+    CompactModelIndices(Model);
+    PackModelVertices(Model, Layout);
+
+    Log << Model.Vertices.size() << " vertices, " << Model.Indices.size() << " indices, " << Model.Materials.size() << " materials, vertex stride "
+        << sizeof(Vertex) << " -> " << Layout.Stride << " bytes" << std::endl;
+
+    const void* IndexData = Model.IndexSize == sizeof(uint16_t) ? static_cast<const void*>(Model.CompactIndices.data()) : Model.Indices.data();
+
+    return WriteMeshCache(CookedPath, SourceHash, Layout, Model.Bounds, Model.Lods, Model.PackedVertices.data(), Model.Vertices.size(), IndexData, Model.Indices.size(), Model.IndexSize,
+                          Model.Meshlets, Model.Submeshes, Model.Materials);
+}
@@ -0,0 +1,659 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "tiny_obj_loader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+const std::size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+
+struct FObjCorner
+{
+    int VertexIndex;
+    int TexCoordIndex;
+    int NormalIndex;
+    uint8_t RelativeMask;
+};
+
+struct FObjMaterialSwitch
+{
+    std::size_t FaceIndex;
+    std::string Name;
+};
+
+struct FObjChunk
+{
+    std::vector<float> Positions;
+    std::vector<float> TexCoords;
+    std::vector<float> Normals;
+    std::vector<FObjCorner> Corners;
+    std::vector<uint32_t> FaceSizes;
+    std::vector<FObjMaterialSwitch> MaterialSwitches;
+    std::vector<std::vector<std::string>> MaterialLibraries;
+    bool bFailed = false;
+};
+
+static bool IsObjSpace(char Character)
+{
+    return Character == ' ' || Character == '\t';
+}
+
+static bool IsObjDigit(char Character)
+{
+    return Character >= '0' && Character <= '9';
+}
+
+// Mirrors tinyobj's tryParseDouble so both loaders produce bit-identical floats
+static bool TryParseObjDouble(const char* Cursor, const char* End, double& Result)
+{
+    static const double FractionTable[] = {1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001};
+
+    if (Cursor >= End)
+    {
+        return false;
+    }
+
+    double Mantissa = 0.0;
+    int Exponent = 0;
+    bool bNegative = false;
+    bool bLeadingDot = false;
+
+    if (*Cursor == '+' || *Cursor == '-')
+    {
+        bNegative = *Cursor == '-';
+        ++Cursor;
+        bLeadingDot = Cursor != End && *Cursor == '.';
+    }
+    else if (*Cursor == '.')
+    {
+        bLeadingDot = true;
+    }
+    else if (!IsObjDigit(*Cursor))
+    {
+        return false;
+    }
+
+    if (!bLeadingDot)
+    {
+        int Read = 0;
+
+        while (Cursor != End && IsObjDigit(*Cursor))
+        {
+            Mantissa *= 10;
+            Mantissa += static_cast<int>(*Cursor - '0');
+            ++Cursor;
+            ++Read;
+        }
+
+        if (Read == 0)
+        {
+            return false;
+        }
+    }
+
+    if (Cursor != End && *Cursor == '.')
+    {
+        ++Cursor;
+        int Read = 1;
+
+        while (Cursor != End && IsObjDigit(*Cursor))
+        {
+            Mantissa += static_cast<int>(*Cursor - '0') * (Read < 8 ? FractionTable[Read] : std::pow(10.0, -Read));
+            ++Read;
+            ++Cursor;
+        }
+    }
+
+    if (Cursor != End && (*Cursor == 'e' || *Cursor == 'E'))
+    {
+        ++Cursor;
+        bool bNegativeExponent = false;
+
+        if (Cursor != End && (*Cursor == '+' || *Cursor == '-'))
+        {
+            bNegativeExponent = *Cursor == '-';
+            ++Cursor;
+        }
+        else if (Cursor == End || !IsObjDigit(*Cursor))
+        {
+            return false;
+        }
+
+        int Read = 0;
+
+        while (Cursor != End && IsObjDigit(*Cursor))
+        {
+            if (Exponent > 214748363)
+            {
+                return false;
+            }
+
+            Exponent = Exponent * 10 + static_cast<int>(*Cursor - '0');
+            ++Cursor;
+            ++Read;
+        }
+
+        if (Read == 0)
+        {
+            return false;
+        }
+
+        Exponent = bNegativeExponent ? -Exponent : Exponent;
+    }
+
+    Result = (bNegative ? -1 : 1) * (Exponent ? std::ldexp(Mantissa * std::pow(5.0, Exponent), Exponent) : Mantissa);
+    return true;
+}
+
+static float ParseObjFloat(const char*& Cursor, const char* LineEnd)
+{
+    while (Cursor < LineEnd && IsObjSpace(*Cursor))
+    {
+        ++Cursor;
+    }
+
+    const char* TokenEnd = Cursor;
+
+    while (TokenEnd < LineEnd && !IsObjSpace(*TokenEnd) && *TokenEnd != '\r')
+    {
+        ++TokenEnd;
+    }
+
+    double Value = 0.0;
+    TryParseObjDouble(Cursor, TokenEnd, Value);
+    Cursor = TokenEnd;
+
+    return static_cast<float>(Value);
+}
+
+static int ParseObjInt(const char*& Cursor, const char* LineEnd)
+{
+    bool bNegative = false;
+
+    if (Cursor < LineEnd && (*Cursor == '-' || *Cursor == '+'))
+    {
+        bNegative = *Cursor == '-';
+        ++Cursor;
+    }
+
+    int Value = 0;
+
+    while (Cursor < LineEnd && IsObjDigit(*Cursor))
+    {
+        Value = Value * 10 + (*Cursor - '0');
+        ++Cursor;
+    }
+
+    return bNegative ? -Value : Value;
+}
+
+static bool ResolveObjIndex(int Index, std::size_t LocalCount, uint8_t RelativeBit, int& Result, uint8_t& RelativeMask)
+{
+    if (Index > 0)
+    {
+        Result = Index - 1;
+        return true;
+    }
+
+    if (Index < 0)
+    {
+        Result = static_cast<int>(LocalCount) + Index;
+        RelativeMask |= RelativeBit;
+        return true;
+    }
+
+    return false;
+}
+
+static void ParseObjFace(const char* Cursor, const char* LineEnd, FObjChunk& Chunk)
+{
+    uint32_t FaceSize = 0;
+
+    while (true)
+    {
+        while (Cursor < LineEnd && (IsObjSpace(*Cursor) || *Cursor == '\r'))
+        {
+            ++Cursor;
+        }
+
+        if (Cursor >= LineEnd)
+        {
+            break;
+        }
+
+        FObjCorner Corner{0, -1, -1, 0};
+
+        if (!ResolveObjIndex(ParseObjInt(Cursor, LineEnd), Chunk.Positions.size() / 3, 1, Corner.VertexIndex, Corner.RelativeMask))
+        {
+            Chunk.bFailed = true;
+            return;
+        }
+
+        if (Cursor < LineEnd && *Cursor == '/')
+        {
+            ++Cursor;
+
+            if (Cursor < LineEnd && *Cursor != '/')
+            {
+                if (!ResolveObjIndex(ParseObjInt(Cursor, LineEnd), Chunk.TexCoords.size() / 2, 2, Corner.TexCoordIndex, Corner.RelativeMask))
+                {
+                    Chunk.bFailed = true;
+                    return;
+                }
+            }
+
+            if (Cursor < LineEnd && *Cursor == '/')
+            {
+                ++Cursor;
+
+                if (!ResolveObjIndex(ParseObjInt(Cursor, LineEnd), Chunk.Normals.size() / 3, 4, Corner.NormalIndex, Corner.RelativeMask))
+                {
+                    Chunk.bFailed = true;
+                    return;
+                }
+            }
+        }
+
+        if (Cursor < LineEnd && !IsObjSpace(*Cursor) && *Cursor != '\r')
+        {
+            Chunk.bFailed = true;
+            return;
+        }
+
+        Chunk.Corners.push_back(Corner);
+        ++FaceSize;
+    }
+
+    if (FaceSize < 3)
+    {
+        Chunk.Corners.resize(Chunk.Corners.size() - FaceSize);
+        return;
+    }
+
+    if (FaceSize > 4)
+    {
+        Chunk.bFailed = true;
+        return;
+    }
+
+    Chunk.FaceSizes.push_back(FaceSize);
+}
+
+static std::string ParseObjName(const char*& Cursor, const char* LineEnd)
+{
+    while (Cursor < LineEnd && IsObjSpace(*Cursor))
+    {
+        ++Cursor;
+    }
+
+    const char* NameEnd = Cursor;
+
+    while (NameEnd < LineEnd && !IsObjSpace(*NameEnd) && *NameEnd != '\r')
+    {
+        ++NameEnd;
+    }
+
+    std::string Name(Cursor, NameEnd);
+    Cursor = NameEnd;
+
+    return Name;
+}
+
+static void ParseObjChunk(const char* Begin, const char* End, FObjChunk& Chunk)
+{
+    const char* Line = Begin;
+
+    while (Line < End && !Chunk.bFailed)
+    {
+        const char* LineEnd = static_cast<const char*>(std::memchr(Line, '\n', End - Line));
+        LineEnd = LineEnd ? LineEnd : End;
+
+        const char* Cursor = Line;
+        Line = LineEnd + 1;
+
+        while (Cursor < LineEnd && IsObjSpace(*Cursor))
+        {
+            ++Cursor;
+        }
+
+        if (LineEnd - Cursor < 2)
+        {
+            continue;
+        }
+
+        if (Cursor[0] == 'v' && IsObjSpace(Cursor[1]))
+        {
+            Cursor += 2;
+            float X = ParseObjFloat(Cursor, LineEnd);
+            float Y = ParseObjFloat(Cursor, LineEnd);
+            float Z = ParseObjFloat(Cursor, LineEnd);
+            Chunk.Positions.insert(Chunk.Positions.end(), {X, Y, Z});
+        }
+        else if (Cursor[0] == 'v' && Cursor[1] == 't' && LineEnd - Cursor > 2 && IsObjSpace(Cursor[2]))
+        {
+            Cursor += 3;
+            float U = ParseObjFloat(Cursor, LineEnd);
+            float V = ParseObjFloat(Cursor, LineEnd);
+            Chunk.TexCoords.insert(Chunk.TexCoords.end(), {U, V});
+        }
+        else if (Cursor[0] == 'v' && Cursor[1] == 'n' && LineEnd - Cursor > 2 && IsObjSpace(Cursor[2]))
+        {
+            Cursor += 3;
+            float X = ParseObjFloat(Cursor, LineEnd);
+            float Y = ParseObjFloat(Cursor, LineEnd);
+            float Z = ParseObjFloat(Cursor, LineEnd);
+            Chunk.Normals.insert(Chunk.Normals.end(), {X, Y, Z});
+        }
+        else if (Cursor[0] == 'f' && IsObjSpace(Cursor[1]))
+        {
+            ParseObjFace(Cursor + 2, LineEnd, Chunk);
+        }
+        else if (LineEnd - Cursor > 6 && std::strncmp(Cursor, "usemtl", 6) == 0 && IsObjSpace(Cursor[6]))
+        {
+            Cursor += 6;
+            Chunk.MaterialSwitches.push_back({Chunk.FaceSizes.size(), ParseObjName(Cursor, LineEnd)});
+        }
+        else if (LineEnd - Cursor > 6 && std::strncmp(Cursor, "mtllib", 6) == 0 && IsObjSpace(Cursor[6]))
+        {
+            // tinyobj resolves usemtl against the libraries read so far, only a leading mtllib is handled here
+            if (!Chunk.MaterialSwitches.empty())
+            {
+                Chunk.bFailed = true;
+                return;
+            }
+
+            Cursor += 6;
+            std::vector<std::string> FileNames;
+
+            for (std::string Name = ParseObjName(Cursor, LineEnd); !Name.empty(); Name = ParseObjName(Cursor, LineEnd))
+            {
+                FileNames.push_back(Name);
+            }
+
+            Chunk.MaterialLibraries.push_back(FileNames);
+        }
+    }
+}
+
+// Lists the mtllib file names of an OBJ without parsing its geometry
+static std::vector<std::string> FindObjMaterialLibraries(const char* Begin, const char* End)
+{
+    std::vector<std::string> FileNames;
+
+    for (const char* Line = Begin; Line < End;)
+    {
+        const char* LineEnd = static_cast<const char*>(std::memchr(Line, '\n', End - Line));
+        LineEnd = LineEnd ? LineEnd : End;
+
+        const char* Cursor = Line;
+        Line = LineEnd + 1;
+
+        while (Cursor < LineEnd && IsObjSpace(*Cursor))
+        {
+            ++Cursor;
+        }
+
+        if (LineEnd - Cursor > 6 && std::strncmp(Cursor, "mtllib", 6) == 0 && IsObjSpace(Cursor[6]))
+        {
+            Cursor += 6;
+
+            for (std::string Name = ParseObjName(Cursor, LineEnd); !Name.empty(); Name = ParseObjName(Cursor, LineEnd))
+            {
+                FileNames.push_back(Name);
+            }
+        }
+    }
+
+    return FileNames;
+}
+
+static void LoadObjMaterialLibraries(const std::string& Path, const std::vector<FObjChunk>& Chunks, std::vector<tinyobj::material_t>& Materials,
+                                     std::map<std::string, int>& MaterialMap)
+{
+    std::string BaseDirectory = std::filesystem::path(Path).parent_path().generic_string();
+    tinyobj::MaterialFileReader Reader(BaseDirectory.empty() ? BaseDirectory : BaseDirectory + "/");
+
+    for (const auto& Chunk : Chunks)
+    {
+        for (const auto& FileNames : Chunk.MaterialLibraries)
+        {
+            for (const auto& FileName : FileNames)
+            {
+                std::string Warn, Err;
+
+                if (Reader(FileName, &Materials, &MaterialMap, &Warn, &Err))
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static bool FixUpObjCorner(FObjCorner& Corner, const std::size_t* Bases, const std::size_t* Counts)
+{
+    int* Indices[] = {&Corner.VertexIndex, &Corner.TexCoordIndex, &Corner.NormalIndex};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (Corner.RelativeMask & (1 << i))
+        {
+            *Indices[i] += static_cast<int>(Bases[i]);
+        }
+
+        if (*Indices[i] >= static_cast<int>(Counts[i]) || (i == 0 && *Indices[i] < 0) || *Indices[i] < -1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Parses Path on all hardware threads into a single triangulated shape with per-triangle material ids.
+// Returns false for anything it does not handle exactly like tinyobj (n-gons above quads, zero or out of
+// range indices, mtllib after usemtl), in which case the caller should fall back to tinyobj::LoadObj.
+static bool LoadObjParallel(const std::string& Path, tinyobj::attrib_t& Attrib, tinyobj::shape_t& Shape, std::vector<tinyobj::material_t>& Materials)
+{
+    FMappedFile File(Path);
+
+    if (File.GetData() == nullptr)
+    {
+        return false;
+    }
+
+    const char* Begin = File.GetData();
+    const char* End = Begin + File.GetSize();
+
+    std::size_t ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t ChunkCount = std::clamp<std::size_t>(File.GetSize() / OBJ_MIN_CHUNK_SIZE, 1, ThreadCount);
+
+    std::vector<const char*> Boundaries(ChunkCount + 1, End);
+    Boundaries[0] = Begin;
+
+    for (std::size_t i = 1; i < ChunkCount; ++i)
+    {
+        const char* Split = std::max(Begin + File.GetSize() * i / ChunkCount, Boundaries[i - 1]);
+        const char* NewLine = static_cast<const char*>(std::memchr(Split, '\n', End - Split));
+        Boundaries[i] = NewLine ? NewLine + 1 : End;
+    }
+
+    std::vector<FObjChunk> Chunks(ChunkCount);
+    std::vector<std::thread> Workers;
+
+    for (std::size_t i = 1; i < ChunkCount; ++i)
+    {
+        Workers.emplace_back(ParseObjChunk, Boundaries[i], Boundaries[i + 1], std::ref(Chunks[i]));
+    }
+
+    ParseObjChunk(Boundaries[0], Boundaries[1], Chunks[0]);
+
+    for (auto& Worker : Workers)
+    {
+        Worker.join();
+    }
+
+    std::vector<std::size_t> PositionBases(ChunkCount), TexCoordBases(ChunkCount), NormalBases(ChunkCount), CornerBases(ChunkCount);
+    std::size_t Counts[3] = {0, 0, 0};
+    std::size_t CornerCount = 0;
+    bool bMaterialSwitched = false;
+
+    for (std::size_t i = 0; i < ChunkCount; ++i)
+    {
+        if (Chunks[i].bFailed || (bMaterialSwitched && !Chunks[i].MaterialLibraries.empty()))
+        {
+            return false;
+        }
+
+        bMaterialSwitched = bMaterialSwitched || !Chunks[i].MaterialSwitches.empty();
+
+        PositionBases[i] = Counts[0];
+        TexCoordBases[i] = Counts[1];
+        NormalBases[i] = Counts[2];
+        CornerBases[i] = CornerCount;
+
+        Counts[0] += Chunks[i].Positions.size() / 3;
+        Counts[1] += Chunks[i].TexCoords.size() / 2;
+        Counts[2] += Chunks[i].Normals.size() / 3;
+        CornerCount += Chunks[i].Corners.size();
+    }
+
+    Attrib.vertices.resize(Counts[0] * 3);
+    Attrib.texcoords.resize(Counts[1] * 2);
+    Attrib.normals.resize(Counts[2] * 3);
+
+    std::vector<FObjCorner> Corners(CornerCount);
+    std::vector<char> ChunkValid(ChunkCount, 1);
+
+    auto MergeChunk = [&](std::size_t i)
+    {
+        const FObjChunk& Chunk = Chunks[i];
+        std::copy(Chunk.Positions.begin(), Chunk.Positions.end(), Attrib.vertices.begin() + PositionBases[i] * 3);
+        std::copy(Chunk.TexCoords.begin(), Chunk.TexCoords.end(), Attrib.texcoords.begin() + TexCoordBases[i] * 2);
+        std::copy(Chunk.Normals.begin(), Chunk.Normals.end(), Attrib.normals.begin() + NormalBases[i] * 3);
+
+        std::size_t Bases[3] = {PositionBases[i], TexCoordBases[i], NormalBases[i]};
+
+        for (std::size_t j = 0; j < Chunk.Corners.size(); ++j)
+        {
+            FObjCorner Corner = Chunk.Corners[j];
+
+            if (!FixUpObjCorner(Corner, Bases, Counts))
+            {
+                ChunkValid[i] = 0;
+                return;
+            }
+
+            Corners[CornerBases[i] + j] = Corner;
+        }
+    };
+
+    Workers.clear();
+
+    for (std::size_t i = 1; i < ChunkCount; ++i)
+    {
+        Workers.emplace_back(MergeChunk, i);
+    }
+
+    MergeChunk(0);
+
+    for (auto& Worker : Workers)
+    {
+        Worker.join();
+    }
+
+    if (std::find(ChunkValid.begin(), ChunkValid.end(), 0) != ChunkValid.end())
+    {
+        return false;
+    }
+
+    auto ToIndex = [](const FObjCorner& Corner)
+    {
+        tinyobj::index_t Index;
+        Index.vertex_index = Corner.VertexIndex;
+        Index.normal_index = Corner.NormalIndex;
+        Index.texcoord_index = Corner.TexCoordIndex;
+        return Index;
+    };
+
+    std::map<std::string, int> MaterialMap;
+    Materials.clear();
+    LoadObjMaterialLibraries(Path, Chunks, Materials, MaterialMap);
+
+    Shape.mesh.indices.clear();
+    Shape.mesh.indices.reserve(CornerCount * 3 / 2);
+    Shape.mesh.material_ids.clear();
+    Shape.mesh.material_ids.reserve(CornerCount / 2);
+
+    const FObjCorner* Corner = Corners.data();
+    int MaterialId = -1;
+
+    for (const auto& Chunk : Chunks)
+    {
+        auto Switch = Chunk.MaterialSwitches.begin();
+
+        for (std::size_t Face = 0; Face < Chunk.FaceSizes.size(); ++Face)
+        {
+            uint32_t FaceSize = Chunk.FaceSizes[Face];
+
+            for (; Switch != Chunk.MaterialSwitches.end() && Switch->FaceIndex == Face; ++Switch)
+            {
+                auto It = MaterialMap.find(Switch->Name);
+                MaterialId = It != MaterialMap.end() ? It->second : -1;
+            }
+
+            Shape.mesh.material_ids.insert(Shape.mesh.material_ids.end(), FaceSize - 2, MaterialId);
+
+            if (FaceSize == 3)
+            {
+                Shape.mesh.indices.insert(Shape.mesh.indices.end(), {ToIndex(Corner[0]), ToIndex(Corner[1]), ToIndex(Corner[2])});
+            }
+            else
+            {
+                const float* V0 = &Attrib.vertices[Corner[0].VertexIndex * 3];
+                const float* V1 = &Attrib.vertices[Corner[1].VertexIndex * 3];
+                const float* V2 = &Attrib.vertices[Corner[2].VertexIndex * 3];
+                const float* V3 = &Attrib.vertices[Corner[3].VertexIndex * 3];
+
+                float E02X = V2[0] - V0[0];
+                float E02Y = V2[1] - V0[1];
+                float E02Z = V2[2] - V0[2];
+                float E13X = V3[0] - V1[0];
+                float E13Y = V3[1] - V1[1];
+                float E13Z = V3[2] - V1[2];
+
+                float Squared02 = E02X * E02X + E02Y * E02Y + E02Z * E02Z;
+                float Squared13 = E13X * E13X + E13Y * E13Y + E13Z * E13Z;
+
+                if (Squared02 < Squared13)
+                {
+                    Shape.mesh.indices.insert(Shape.mesh.indices.end(), {ToIndex(Corner[0]), ToIndex(Corner[1]), ToIndex(Corner[2]),
+                                                                         ToIndex(Corner[0]), ToIndex(Corner[2]), ToIndex(Corner[3])});
+                }
+                else
+                {
+                    Shape.mesh.indices.insert(Shape.mesh.indices.end(), {ToIndex(Corner[0]), ToIndex(Corner[1]), ToIndex(Corner[3]),
+                                                                         ToIndex(Corner[1]), ToIndex(Corner[2]), ToIndex(Corner[3])});
+                }
+            }
+
+            Corner += FaceSize;
+        }
+
+        for (; Switch != Chunk.MaterialSwitches.end(); ++Switch)
+        {
+            auto It = MaterialMap.find(Switch->Name);
+            MaterialId = It != MaterialMap.end() ? It->second : -1;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+static bool IsShaderSource(const std::filesystem::path& Path)
+{
+    auto Extension = Path.extension().string();
+    return Extension == ".vert" || Extension == ".frag";
+}
+
+static std::string GetCompiledShaderPath(const std::filesystem::path& SourcePath)
+{
+    auto Extension = SourcePath.extension().string().substr(1);
+    auto CompiledPath = SourcePath.parent_path() / (SourcePath.stem().string() + "_" + Extension + ".spv");
+    return CompiledPath.generic_string();
+}
+
+// Runs the compiler directly with an argument vector rather than through a shell, so no character in a shader file
+// name is ever interpreted as shell syntax
+static bool CompileShader(const std::string& Compiler, const std::string& SourcePath, const std::string& CompiledPath)
+{
+#ifdef _WIN32
+    auto Quote = [](const std::string& Argument)
+    {
+        std::string Quoted = "\"";
+        std::size_t Backslashes = 0;
+
+        for (char Character : Argument)
+        {
+            if (Character == '\\')
+            {
+                ++Backslashes;
+                continue;
+            }
+
+            Quoted.append(Character == '"' ? Backslashes * 2 + 1 : Backslashes, '\\');
+            Quoted.push_back(Character);
+            Backslashes = 0;
+        }
+
+        Quoted.append(Backslashes * 2, '\\');
+        Quoted.push_back('"');
+        return Quoted;
+    };
+
+    auto CommandLine = Quote(Compiler) + " " + Quote(SourcePath) + " -o " + Quote(CompiledPath);
+
+    STARTUPINFOA StartupInfo{};
+    StartupInfo.cb = sizeof(StartupInfo);
+    PROCESS_INFORMATION ProcessInfo{};
+
+    if (!CreateProcessA(nullptr, CommandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &StartupInfo, &ProcessInfo))
+    {
+        return false;
+    }
+
+    WaitForSingleObject(ProcessInfo.hProcess, INFINITE);
+
+    DWORD ExitCode = 1;
+    GetExitCodeProcess(ProcessInfo.hProcess, &ExitCode);
+    CloseHandle(ProcessInfo.hThread);
+    CloseHandle(ProcessInfo.hProcess);
+
+    return ExitCode == 0;
+#else
+    std::string OutputFlag = "-o";
+    std::vector<char*> Arguments = {const_cast<char*>(Compiler.c_str()), const_cast<char*>(SourcePath.c_str()), OutputFlag.data(), const_cast<char*>(CompiledPath.c_str()), nullptr};
+
+    pid_t Process;
+    if (posix_spawnp(&Process, Compiler.c_str(), nullptr, nullptr, Arguments.data(), environ) != 0)
+    {
+        return false;
+    }
+
+    int Status = 0;
+    while (waitpid(Process, &Status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    return WIFEXITED(Status) && WEXITSTATUS(Status) == 0;
+#endif
+}
+
+class FShaderWatcher
+{
+public:
+    explicit FShaderWatcher(const std::string& Directory) : Directory(Directory)
+    {
+#ifdef __linux__
+        NotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (NotifyDescriptor >= 0)
+        {
+            WatchDescriptor = inotify_add_watch(NotifyDescriptor, Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        }
+#else
+        std::error_code Error;
+        for (const auto& Entry : std::filesystem::directory_iterator(Directory, Error))
+        {
+            if (IsShaderSource(Entry.path()))
+            {
+                WriteTimes[Entry.path().generic_string()] = Entry.last_write_time(Error);
+            }
+        }
+#endif
+    }
+
+    ~FShaderWatcher()
+    {
+#ifdef __linux__
+        if (NotifyDescriptor >= 0)
+        {
+            close(NotifyDescriptor);
+        }
+#endif
+    }
+
+    FShaderWatcher(const FShaderWatcher&) = delete;
+    FShaderWatcher& operator=(const FShaderWatcher&) = delete;
+
+    std::vector<std::string> PollChangedSources()
+    {
+        std::vector<std::string> ChangedSources;
+
+#ifdef __linux__
+        if (WatchDescriptor < 0)
+        {
+            return ChangedSources;
+        }
+
+        alignas(inotify_event) char Buffer[4096];
+        ssize_t Length;
+
+        while ((Length = read(NotifyDescriptor, Buffer, sizeof(Buffer))) > 0)
+        {
+            for (char* Pointer = Buffer; Pointer < Buffer + Length;)
+            {
+                auto* Event = reinterpret_cast<inotify_event*>(Pointer);
+                Pointer += sizeof(inotify_event) + Event->len;
+
+                if (Event->len == 0)
+                {
+                    continue;
+                }
+
+                auto Path = std::filesystem::path(Directory) / Event->name;
+
+                if (IsShaderSource(Path))
+                {
+                    AddUnique(ChangedSources, Path.generic_string());
+                }
+            }
+        }
+#else
+        auto Now = std::chrono::steady_clock::now();
+
+        if (Now - LastPollTime < std::chrono::milliseconds(250))
+        {
+            return ChangedSources;
+        }
+
+        LastPollTime = Now;
+
+        std::error_code Error;
+        for (const auto& Entry : std::filesystem::directory_iterator(Directory, Error))
+        {
+            if (!IsShaderSource(Entry.path()))
+            {
+                continue;
+            }
+
+            auto Path = Entry.path().generic_string();
+            auto WriteTime = Entry.last_write_time(Error);
+            auto It = WriteTimes.find(Path);
+
+            if (It == WriteTimes.end() || It->second != WriteTime)
+            {
+                WriteTimes[Path] = WriteTime;
+                AddUnique(ChangedSources, Path);
+            }
+        }
+#endif
+
+        return ChangedSources;
+    }
+
+private:
+    static void AddUnique(std::vector<std::string>& Paths, const std::string& Path)
+    {
+        for (const auto& Existing : Paths)
+        {
+            if (Existing == Path)
+            {
+                return;
+            }
+        }
+
+        Paths.push_back(Path);
+    }
+
+    std::string Directory;
+#ifdef __linux__
+    int NotifyDescriptor = -1;
+    int WatchDescriptor = -1;
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> WriteTimes;
+    std::chrono::steady_clock::time_point LastPollTime{};
+#endif
+};
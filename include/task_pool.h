@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+template<typename ResultType>
+static bool IsFutureReady(const std::future<ResultType>& Future)
+{
+    return Future.valid() && Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Fixed set of worker threads running tasks in submission order. Tasks may submit further tasks,
+// the destructor runs everything still queued before joining the workers.
+class FTaskPool
+{
+public:
+    explicit FTaskPool(std::size_t ThreadCount = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        for (std::size_t i = 0; i < ThreadCount; ++i)
+        {
+            Workers.emplace_back(&FTaskPool::RunWorker, this);
+        }
+    }
+
+    ~FTaskPool()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            bStopping = true;
+        }
+
+        Condition.notify_all();
+
+        for (auto& Worker : Workers)
+        {
+            Worker.join();
+        }
+    }
+
+    FTaskPool(const FTaskPool&) = delete;
+    FTaskPool& operator=(const FTaskPool&) = delete;
+
+    template<typename FunctionType>
+    auto Submit(FunctionType Function) -> std::future<decltype(Function())>
+    {
+        using ResultType = decltype(Function());
+
+        auto Task = std::make_shared<std::packaged_task<ResultType()>>(std::move(Function));
+        std::future<ResultType> Future = Task->get_future();
+
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Tasks.emplace_back([Task]() { (*Task)(); });
+        }
+
+        Condition.notify_one();
+
+        return Future;
+    }
+
+    std::size_t GetThreadCount() const
+    {
+        return Workers.size();
+    }
+
+private:
+    void RunWorker()
+    {
+        while (true)
+        {
+            std::function<void()> Task;
+
+            {
+                std::unique_lock<std::mutex> Lock(Mutex);
+                Condition.wait(Lock, [this]() { return bStopping || !Tasks.empty(); });
+
+                if (Tasks.empty())
+                {
+                    return;
+                }
+
+                Task = std::move(Tasks.front());
+                Tasks.pop_front();
+            }
+
+            Task();
+        }
+    }
+
+    std::vector<std::thread> Workers;
+    std::deque<std::function<void()>> Tasks;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    bool bStopping = false;
+};
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "lz_codec.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const uint32_t TEXTURE_CACHE_MAGIC = 0x58455454;
+const uint32_t TEXTURE_CACHE_VERSION = 2;
+const uint64_t TEXTURE_CACHE_ALIGNMENT = 64;
+const uint32_t TEXTURE_CACHE_MAX_LEVELS = 16;
+const std::string TEXTURE_CACHE_EXTENSION = ".texcache";
+
+// Like the supercompression scheme of KTX2, applied to every level on its own. Levels that would not shrink are
+// stored as they are, their size then equals their uncompressed size.
+enum class ETextureSupercompression : uint32_t
+{
+    None,
+    Lz
+};
+
+struct FTextureMip
+{
+    uint32_t Width;
+    uint32_t Height;
+    std::vector<uint8_t> Data;
+};
+
+struct FTextureCacheLevel
+{
+    uint64_t Offset;
+    uint64_t Size;
+    uint64_t UncompressedSize;
+    uint32_t Width;
+    uint32_t Height;
+};
+
+struct FTextureCacheHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t SourceHash;
+    uint32_t Format;
+    uint32_t Supercompression;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t LevelCount;
+    FTextureCacheLevel Levels[TEXTURE_CACHE_MAX_LEVELS];
+};
+
+static uint64_t AlignTextureCacheOffset(uint64_t Offset)
+{
+    return (Offset + TEXTURE_CACHE_ALIGNMENT - 1) & ~(TEXTURE_CACHE_ALIGNMENT - 1);
+}
+
+static uint32_t GetTextureMipLevelCount(uint32_t Width, uint32_t Height)
+{
+    uint32_t LevelCount = 1;
+
+    for (uint32_t Size = std::max(Width, Height); Size > 1; Size /= 2)
+    {
+        ++LevelCount;
+    }
+
+    return LevelCount;
+}
+
+// Levels are stored from the full resolution down, back to back, so a whole chain is staged with a single copy
+static bool WriteTextureCache(const std::string& Path, uint64_t SourceHash, uint32_t Format, const std::vector<FTextureMip>& Mips,
+                              ETextureSupercompression Supercompression = ETextureSupercompression::None)
+{
+    if (Mips.empty() || Mips.size() > TEXTURE_CACHE_MAX_LEVELS)
+    {
+        return false;
+    }
+
+    FTextureCacheHeader Header{};
+    Header.Magic = TEXTURE_CACHE_MAGIC;
+    Header.Version = TEXTURE_CACHE_VERSION;
+    Header.SourceHash = SourceHash;
+    Header.Format = Format;
+    Header.Supercompression = static_cast<uint32_t>(Supercompression);
+    Header.Width = Mips[0].Width;
+    Header.Height = Mips[0].Height;
+    Header.LevelCount = static_cast<uint32_t>(Mips.size());
+
+    std::vector<std::vector<uint8_t>> CompressedLevels(Header.LevelCount);
+    uint64_t Offset = AlignTextureCacheOffset(sizeof(FTextureCacheHeader));
+
+    for (uint32_t i = 0; i < Header.LevelCount; ++i)
+    {
+        if (Supercompression == ETextureSupercompression::Lz)
+        {
+            CompressedLevels[i] = CompressLz(Mips[i].Data.data(), Mips[i].Data.size());
+
+            if (CompressedLevels[i].size() >= Mips[i].Data.size())
+            {
+                CompressedLevels[i].clear();
+            }
+        }
+
+        uint64_t Size = CompressedLevels[i].empty() ? Mips[i].Data.size() : CompressedLevels[i].size();
+        Header.Levels[i] = {Offset, Size, Mips[i].Data.size(), Mips[i].Width, Mips[i].Height};
+        Offset = AlignTextureCacheOffset(Offset + Size);
+    }
+
+    std::string TemporaryPath = Path + ".tmp";
+
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+
+        if (!File)
+        {
+            return false;
+        }
+
+        const char Padding[TEXTURE_CACHE_ALIGNMENT] = {};
+        uint64_t Written = 0;
+
+        auto WriteBlob = [&](uint64_t BlobOffset, const void* Data, uint64_t Size)
+        {
+            File.write(Padding, static_cast<std::streamsize>(BlobOffset - Written));
+            File.write(static_cast<const char*>(Data), static_cast<std::streamsize>(Size));
+            Written = BlobOffset + Size;
+        };
+
+        WriteBlob(0, &Header, sizeof(Header));
+
+        for (uint32_t i = 0; i < Header.LevelCount; ++i)
+        {
+            const std::vector<uint8_t>& Level = CompressedLevels[i].empty() ? Mips[i].Data : CompressedLevels[i];
+            WriteBlob(Header.Levels[i].Offset, Level.data(), Header.Levels[i].Size);
+        }
+
+        if (!File)
+        {
+            return false;
+        }
+    }
+
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, Path, Error);
+
+    if (Error)
+    {
+        std::filesystem::remove(TemporaryPath, Error);
+        return false;
+    }
+
+    return true;
+}
+
+class FTextureCache
+{
+public:
+    bool Open(const std::string& Path)
+    {
+        Close();
+
+        if (!File.Open(Path) || File.GetSize() < sizeof(FTextureCacheHeader))
+        {
+            Close();
+            return false;
+        }
+
+        std::memcpy(&Header, File.GetData(), sizeof(Header));
+
+        bool bValid = Header.Magic == TEXTURE_CACHE_MAGIC &&
+                      Header.Version == TEXTURE_CACHE_VERSION &&
+                      Header.Supercompression <= static_cast<uint32_t>(ETextureSupercompression::Lz) &&
+                      Header.LevelCount > 0 && Header.LevelCount <= TEXTURE_CACHE_MAX_LEVELS &&
+                      Header.LevelCount <= GetTextureMipLevelCount(Header.Width, Header.Height);
+
+        uint64_t End = sizeof(FTextureCacheHeader);
+        uint64_t DataOffset = 0;
+
+        for (uint32_t i = 0; bValid && i < Header.LevelCount; ++i)
+        {
+            const FTextureCacheLevel& Level = Header.Levels[i];
+            bValid = Level.Width == std::max(Header.Width >> i, 1u) && Level.Height == std::max(Header.Height >> i, 1u) &&
+                     Level.Offset % TEXTURE_CACHE_ALIGNMENT == 0 && Level.Offset >= End && Level.Size > 0 &&
+                     Level.Offset + Level.Size <= File.GetSize() && Level.Size <= Level.UncompressedSize &&
+                     (IsSupercompressed() || Level.Size == Level.UncompressedSize);
+            End = Level.Offset + Level.Size;
+
+            // Levels are read out laid out like stored ones, so either way a level sits at the same offset in a staged chain
+            LevelOffsets[i] = IsSupercompressed() ? DataOffset : Level.Offset - Header.Levels[0].Offset;
+            DataOffset = AlignTextureCacheOffset(LevelOffsets[i] + Level.UncompressedSize);
+        }
+
+        if (!bValid)
+        {
+            Close();
+            return false;
+        }
+
+        const FTextureCacheLevel& Last = Header.Levels[Header.LevelCount - 1];
+        DataSize = static_cast<std::size_t>(LevelOffsets[Header.LevelCount - 1] + Last.UncompressedSize);
+
+        return true;
+    }
+
+    void Close()
+    {
+        File.Close();
+        Header = FTextureCacheHeader{};
+        DataSize = 0;
+    }
+
+    bool IsLoaded() const
+    {
+        return Header.Magic == TEXTURE_CACHE_MAGIC;
+    }
+
+    const FTextureCacheHeader& GetHeader() const
+    {
+        return Header;
+    }
+
+    bool IsSupercompressed() const
+    {
+        return Header.Supercompression != static_cast<uint32_t>(ETextureSupercompression::None);
+    }
+
+    void Prefault() const
+    {
+        File.Prefault();
+    }
+
+    // Writes levels FirstLevel to the last one into Destination at their offsets relative to FirstLevel. Stored levels
+    // are copied out of the mapping and supercompressed ones inflated in place, so every byte is written once.
+    // Returns the number of bytes written, or 0 if a level fails to inflate.
+    uint64_t ReadLevels(uint32_t FirstLevel, uint32_t LevelCount, char* Destination) const
+    {
+        uint64_t Written = 0;
+
+        for (uint32_t i = FirstLevel; i < FirstLevel + LevelCount; ++i)
+        {
+            const FTextureCacheLevel& Level = Header.Levels[i];
+            const char* Source = File.GetData() + Level.Offset;
+            char* Output = Destination + (LevelOffsets[i] - LevelOffsets[FirstLevel]);
+
+            if (Level.Size == Level.UncompressedSize)
+            {
+                std::memcpy(Output, Source, Level.Size);
+            }
+            else if (!DecompressLz(reinterpret_cast<const uint8_t*>(Source), Level.Size, reinterpret_cast<uint8_t*>(Output), Level.UncompressedSize))
+            {
+                return 0;
+            }
+
+            Written += Level.UncompressedSize;
+        }
+
+        return Written;
+    }
+
+    // Levels stored without supercompression can be read in place, nullptr for the others
+    const char* GetStoredLevelData(uint32_t Level) const
+    {
+        return Header.Levels[Level].Size == Header.Levels[Level].UncompressedSize ? File.GetData() + Header.Levels[Level].Offset : nullptr;
+    }
+
+    uint64_t GetLevelOffset(uint32_t Level) const
+    {
+        return LevelOffsets[Level];
+    }
+
+    // All levels from the first one on once read out, including the alignment padding between them
+    std::size_t GetDataSize() const
+    {
+        return DataSize;
+    }
+
+private:
+    FMappedFile File;
+    FTextureCacheHeader Header{};
+    uint64_t LevelOffsets[TEXTURE_CACHE_MAX_LEVELS] = {};
+    std::size_t DataSize = 0;
+};
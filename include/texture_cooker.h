@@ -0,0 +1,188 @@
+#pragma once
+
+#include "main.h"
+#include "block_compressor.h"
+#include "mip_generator.h"
+#include "texture_cache.h"
+#include "texture_formats.h"
+#include "virtual_texture_cache.h"
+#include "stb_image.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+static uint64_t HashTextureSource(const std::string& TexturePath, bool& bFound)
+{
+    FMappedFile TextureFile(TexturePath);
+    bFound = TextureFile.GetData() != nullptr;
+
+    return bFound ? HashBytes(TextureFile.GetData(), TextureFile.GetSize()) : 0;
+}
+
+struct FTextureCookSettings
+{
+    ECompressionQuality Quality = ECompressionQuality::Normal;
+    ETextureSupercompression Supercompression = ETextureSupercompression::None;
+    bool bVirtualTexture = false;
+};
+
+static uint64_t GetCompressedTextureHash(uint64_t SourceHash, ECompressionQuality Quality)
+{
+    const uint64_t Key[3] = {SourceHash, static_cast<uint64_t>(Quality), BLOCK_COMPRESSOR_VERSION};
+    return HashBytes(Key, sizeof(Key));
+}
+
+// High quality cooks to BC7, the other presets to BC1, or BC3 for textures with translucent texels
+static VkFormat GetCompressedTextureFormat(EBlockFormat Format)
+{
+    return Format == EBlockFormat::Bc7 ? VK_FORMAT_BC7_SRGB_BLOCK : Format == EBlockFormat::Bc3 ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+}
+
+static EBlockFormat SelectBlockFormat(const FTextureMip& Mip, ECompressionQuality Quality)
+{
+    if (Quality == ECompressionQuality::High)
+    {
+        return EBlockFormat::Bc7;
+    }
+
+    return HasTranslucentTexels(Mip) ? EBlockFormat::Bc3 : EBlockFormat::Bc1;
+}
+
+// Bilinear with wrap around, only used to bring virtual texture sources to a power of two number of pages
+static FTextureMip ResampleTexture(const uint8_t* Pixels, uint32_t Width, uint32_t Height, uint32_t NewWidth, uint32_t NewHeight)
+{
+    FTextureMip Mip{NewWidth, NewHeight, std::vector<uint8_t>(static_cast<std::size_t>(NewWidth) * NewHeight * 4)};
+
+    for (uint32_t y = 0; y < NewHeight; ++y)
+    {
+        float SourceY = (y + 0.5f) * Height / NewHeight - 0.5f + Height;
+        uint32_t Y0 = static_cast<uint32_t>(SourceY);
+        float WeightY = SourceY - Y0;
+
+        for (uint32_t x = 0; x < NewWidth; ++x)
+        {
+            float SourceX = (x + 0.5f) * Width / NewWidth - 0.5f + Width;
+            uint32_t X0 = static_cast<uint32_t>(SourceX);
+            float WeightX = SourceX - X0;
+
+            const uint8_t* Texels[4] = {&Pixels[(static_cast<std::size_t>(Y0 % Height) * Width + X0 % Width) * 4], &Pixels[(static_cast<std::size_t>(Y0 % Height) * Width + (X0 + 1) % Width) * 4],
+                                        &Pixels[(static_cast<std::size_t>((Y0 + 1) % Height) * Width + X0 % Width) * 4], &Pixels[(static_cast<std::size_t>((Y0 + 1) % Height) * Width + (X0 + 1) % Width) * 4]};
+
+            for (int c = 0; c < 4; ++c)
+            {
+                float Top = Texels[0][c] + (Texels[1][c] - Texels[0][c]) * WeightX;
+                float Bottom = Texels[2][c] + (Texels[3][c] - Texels[2][c]) * WeightX;
+                Mip.Data[(static_cast<std::size_t>(y) * NewWidth + x) * 4 + c] = static_cast<uint8_t>(Top + (Bottom - Top) * WeightY + 0.5f);
+            }
+        }
+    }
+
+    return Mip;
+}
+
+static bool IsCookedVirtualTextureCurrent(const std::string& TexturePath, uint64_t SourceHash, const FTextureCookSettings& Settings)
+{
+    FVirtualTextureCache Cache;
+    bool bCooked = Cache.Open(GetCookedVirtualTexturePath(TexturePath));
+
+    return Settings.bVirtualTexture ? bCooked && Cache.GetHeader().SourceHash == SourceHash : !std::filesystem::exists(GetCookedVirtualTexturePath(TexturePath));
+}
+
+// Current when the uncompressed chain and exactly one block compressed chain were cooked from the source with these
+// settings, and the virtual texture exists exactly when it was asked for
+static bool IsCookedTextureCurrent(const std::string& TexturePath, const std::string& CookedPath, uint64_t SourceHash, const FTextureCookSettings& Settings)
+{
+    FTextureCache Cache;
+
+    if (!Cache.Open(CookedPath) || Cache.GetHeader().SourceHash != SourceHash ||
+        Cache.GetHeader().Supercompression != static_cast<uint32_t>(Settings.Supercompression) || !IsCookedVirtualTextureCurrent(TexturePath, SourceHash, Settings))
+    {
+        return false;
+    }
+
+    for (const auto& Info : COOKED_TEXTURE_FORMATS)
+    {
+        if (IsBlockCompressedFormat(Info) && Cache.Open(GetCookedTexturePath(TexturePath, Info)))
+        {
+            return Cache.GetHeader().SourceHash == GetCompressedTextureHash(SourceHash, Settings.Quality) &&
+                   Cache.GetHeader().Supercompression == static_cast<uint32_t>(Settings.Supercompression);
+        }
+    }
+
+    return false;
+}
+
+static bool CookTexture(const std::string& TexturePath, const std::string& CookedPath, uint64_t SourceHash, const FTextureCookSettings& Settings, std::ostream& Log)
+{
+    int Width, Height, Channels;
+    stbi_uc* Pixels = stbi_load(TexturePath.c_str(), &Width, &Height, &Channels, STBI_rgb_alpha);
+
+    if (!Pixels)
+    {
+        Log << "Failed to load texture image " << TexturePath << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    uint32_t SourceWidth = static_cast<uint32_t>(Width);
+    uint32_t SourceHeight = static_cast<uint32_t>(Height);
+    std::vector<FTextureMip> Mips = GenerateMipChain(Pixels, SourceWidth, SourceHeight);
+    std::vector<FTextureMip> VirtualMips;
+
+    if (Settings.bVirtualTexture && IsVirtualTextureExtent(SourceWidth, SourceHeight))
+    {
+        VirtualMips = Mips;
+    }
+    else if (Settings.bVirtualTexture)
+    {
+        FTextureMip Resampled = ResampleTexture(Pixels, SourceWidth, SourceHeight, GetVirtualTextureExtent(SourceWidth), GetVirtualTextureExtent(SourceHeight));
+        VirtualMips = GenerateMipChain(Resampled.Data.data(), Resampled.Width, Resampled.Height);
+    }
+
+    stbi_image_free(Pixels);
+
+    EBlockFormat BlockFormat = SelectBlockFormat(Mips[0], Settings.Quality);
+    const FTextureFormatInfo& CompressedInfo = *GetTextureFormatInfo(GetCompressedTextureFormat(BlockFormat));
+    std::vector<FTextureMip> CompressedMips = CompressMipChain(Mips, BlockFormat, Settings.Quality);
+
+    std::size_t CookedSize = 0;
+    std::size_t CompressedSize = 0;
+
+    for (std::size_t i = 0; i < Mips.size(); ++i)
+    {
+        CookedSize += Mips[i].Data.size();
+        CompressedSize += CompressedMips[i].Data.size();
+    }
+
+    Log << Width << "x" << Height << ", " << Mips.size() << " mip levels, " << CookedSize << " bytes, " << CompressedInfo.Extension + 1 << " " << CompressedSize
+        << " bytes" << std::endl;
+
+    // A previous cook with another preset may have left a different block format or a virtual texture behind, the runtime would prefer them
+    if (!Settings.bVirtualTexture)
+    {
+        std::error_code Error;
+        std::filesystem::remove(GetCookedVirtualTexturePath(TexturePath), Error);
+    }
+    else if (!WriteVirtualTexture(GetCookedVirtualTexturePath(TexturePath), SourceHash, VK_FORMAT_R8G8B8A8_SRGB, VirtualMips))
+    {
+        Log << "Failed to write virtual texture " << GetCookedVirtualTexturePath(TexturePath) << std::endl;
+        return false;
+    }
+
+    for (const auto& Info : COOKED_TEXTURE_FORMATS)
+    {
+        if (IsBlockCompressedFormat(Info) && &Info != &CompressedInfo)
+        {
+            std::error_code Error;
+            std::filesystem::remove(GetCookedTexturePath(TexturePath, Info), Error);
+        }
+    }
+
+    return WriteTextureCache(CookedPath, SourceHash, VK_FORMAT_R8G8B8A8_SRGB, Mips, Settings.Supercompression) &&
+           WriteTextureCache(GetCookedTexturePath(TexturePath, CompressedInfo), GetCompressedTextureHash(SourceHash, Settings.Quality), CompressedInfo.Format,
+                             CompressedMips, Settings.Supercompression);
+}
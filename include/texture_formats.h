@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cooked_assets.h"
+#include "texture_cache.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+
+struct FTextureFormatInfo
+{
+    VkFormat Format;
+    const char* Extension;
+    uint32_t BlockExtent;
+    uint32_t BlockSize;
+};
+
+// Every format a texture can be cooked to, in the order the runtime prefers them. A texture has at most one
+// block compressed variant next to the R8G8B8A8 one, which every device can sample.
+const FTextureFormatInfo COOKED_TEXTURE_FORMATS[] = {
+        {VK_FORMAT_BC7_SRGB_BLOCK, ".bc7", 4, 16},
+        {VK_FORMAT_BC3_SRGB_BLOCK, ".bc3", 4, 16},
+        {VK_FORMAT_BC1_RGB_SRGB_BLOCK, ".bc1", 4, 8},
+        {VK_FORMAT_R8G8B8A8_SRGB, "", 1, 4}
+};
+
+static const FTextureFormatInfo* GetTextureFormatInfo(VkFormat Format)
+{
+    for (const auto& Info : COOKED_TEXTURE_FORMATS)
+    {
+        if (Info.Format == Format)
+        {
+            return &Info;
+        }
+    }
+
+    return nullptr;
+}
+
+static bool IsBlockCompressedFormat(const FTextureFormatInfo& Info)
+{
+    return Info.BlockExtent > 1;
+}
+
+static uint64_t GetTextureLevelSize(const FTextureFormatInfo& Info, uint32_t Width, uint32_t Height)
+{
+    uint64_t BlocksX = (Width + Info.BlockExtent - 1) / Info.BlockExtent;
+    uint64_t BlocksY = (Height + Info.BlockExtent - 1) / Info.BlockExtent;
+    return BlocksX * BlocksY * Info.BlockSize;
+}
+
+static std::string GetCookedTexturePath(const std::string& SourcePath, const FTextureFormatInfo& Info)
+{
+    return GetCookedAssetPath(SourcePath, Info.Extension + TEXTURE_CACHE_EXTENSION);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "texture_cache.h"
+
+#include <cstdint>
+
+// Device memory the streamed textures may hold, estimated from their cooked level sizes. Once exceeded the finest
+// allocated level of any texture is evicted, and evicted levels only stream back in once they fit again.
+const uint64_t TEXTURE_STREAMING_BUDGET = 256ull << 20;
+// The coarsest levels that add up to at most this are uploaded with the texture, the rest stream in one level at a time
+const uint64_t TEXTURE_STREAMING_TAIL_SIZE = 64 << 10;
+
+// Levels are numbered like in the cooked chain, 0 is the full resolution. The image holds AllocatedLevel and every
+// coarser level, the levels from ResidentLevel on hold data and sampling is clamped to ResidentLevel.
+struct FTextureResidency
+{
+    uint32_t LevelCount;
+    uint32_t TailLevel;
+    uint32_t AllocatedLevel;
+    uint32_t ResidentLevel;
+    uint64_t LevelSizes[TEXTURE_CACHE_MAX_LEVELS];
+};
+
+static FTextureResidency GetInitialTextureResidency(const FTextureCacheHeader& Header)
+{
+    FTextureResidency Residency{};
+    Residency.LevelCount = Header.LevelCount;
+    Residency.TailLevel = Header.LevelCount - 1;
+
+    uint64_t TailSize = 0;
+
+    for (uint32_t Level = Header.LevelCount; Level-- > 0;)
+    {
+        Residency.LevelSizes[Level] = Header.Levels[Level].UncompressedSize;
+        TailSize += Residency.LevelSizes[Level];
+
+        if (TailSize <= TEXTURE_STREAMING_TAIL_SIZE && Level + 1 == Residency.TailLevel)
+        {
+            Residency.TailLevel = Level;
+        }
+    }
+
+    Residency.ResidentLevel = Residency.TailLevel;
+
+    return Residency;
+}
+
+static uint64_t GetTextureLevelsSize(const FTextureResidency& Residency, uint32_t FirstLevel)
+{
+    uint64_t Size = 0;
+
+    for (uint32_t Level = FirstLevel; Level < Residency.LevelCount; ++Level)
+    {
+        Size += Residency.LevelSizes[Level];
+    }
+
+    return Size;
+}
+
+// The finest level that fits next to MemoryUsage, the tail is allocated even when nothing fits
+static uint32_t GetAllocatableTextureLevel(const FTextureResidency& Residency, uint64_t MemoryUsage)
+{
+    uint32_t Level = 0;
+
+    while (Level < Residency.TailLevel && MemoryUsage + GetTextureLevelsSize(Residency, Level) > TEXTURE_STREAMING_BUDGET)
+    {
+        ++Level;
+    }
+
+    return Level;
+}
+
+static bool CanEvictTextureLevel(const FTextureResidency& Residency)
+{
+    return Residency.AllocatedLevel < Residency.TailLevel;
+}
+
+// Either the next level is already allocated, or the image can grow by a level without exceeding the budget
+static bool CanStreamTextureLevel(const FTextureResidency& Residency, uint64_t MemoryUsage)
+{
+    if (Residency.ResidentLevel > Residency.AllocatedLevel)
+    {
+        return true;
+    }
+
+    return Residency.AllocatedLevel > 0 && MemoryUsage + Residency.LevelSizes[Residency.AllocatedLevel - 1] <= TEXTURE_STREAMING_BUDGET;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "main.h"
+#include "mesh_cache.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+struct Vertex {
+    FVector3 Pos;
+    FVector3 Color;
+    FVector2 TexCoord;
+
+    bool operator==(const Vertex& Other) const
+    {
+        return Pos == Other.Pos && Color == Other.Color && TexCoord == Other.TexCoord;
+    }
+
+};
+
+enum class EVertexColorFormat
+{
+    Float3,
+    Rgba8,
+    Constant
+};
+
+enum class ETexCoordFormat
+{
+    Float2,
+    Half2,
+    Unorm16
+};
+
+struct FVertexFormat
+{
+    bool bQuantizedPositions;
+    EVertexColorFormat ColorFormat;
+    ETexCoordFormat TexCoordFormat;
+};
+
+const FVertexFormat MODEL_VERTEX_FORMAT = {true, EVertexColorFormat::Constant, ETexCoordFormat::Unorm16};
+
+static FMeshVertexLayout GetVertexLayout(const FVertexFormat& Format)
+{
+    FMeshVertexLayout Layout{};
+
+    auto AddAttribute = [&Layout](uint32_t Location, VkFormat AttributeFormat, uint32_t Size)
+    {
+        Layout.Attributes[Layout.AttributeCount++] = {Location, static_cast<uint32_t>(AttributeFormat), Layout.Stride};
+        Layout.Stride += Size;
+    };
+
+    if (Format.bQuantizedPositions)
+    {
+        AddAttribute(0, VK_FORMAT_R16G16B16A16_SNORM, 4 * sizeof(int16_t));
+    }
+    else
+    {
+        AddAttribute(0, VK_FORMAT_R32G32B32_SFLOAT, 3 * sizeof(float));
+    }
+
+    if (Format.ColorFormat == EVertexColorFormat::Float3)
+    {
+        AddAttribute(1, VK_FORMAT_R32G32B32_SFLOAT, 3 * sizeof(float));
+    }
+    else if (Format.ColorFormat == EVertexColorFormat::Rgba8)
+    {
+        AddAttribute(1, VK_FORMAT_R8G8B8A8_UNORM, 4 * sizeof(uint8_t));
+    }
+
+    switch (Format.TexCoordFormat)
+    {
+        case ETexCoordFormat::Float2:
+            AddAttribute(2, VK_FORMAT_R32G32_SFLOAT, 2 * sizeof(float));
+            break;
+        case ETexCoordFormat::Half2:
+            AddAttribute(2, VK_FORMAT_R16G16_SFLOAT, 2 * sizeof(uint16_t));
+            break;
+        case ETexCoordFormat::Unorm16:
+            AddAttribute(2, VK_FORMAT_R16G16_UNORM, 2 * sizeof(uint16_t));
+            break;
+    }
+
+    return Layout;
+}
+
+template<> struct std::hash<Vertex>
+{
+    size_t operator()(Vertex const& Vertex) const
+    {
+        return ((std::hash<FVector3>()(Vertex.Pos) ^
+                (std::hash<FVector3>()(Vertex.Color) << 1)) >> 1) ^
+                (std::hash<FVector2>()(Vertex.TexCoord) << 1);
+    }
+};
+
+static FMatrix4 GetPositionDequantization(const FMeshBounds& Bounds)
+{
+    FMatrix4 Dequantization;
+    Dequantization.Data[0].X = std::max((Bounds.Max[0] - Bounds.Min[0]) * 0.5f, 1e-6f);
+    Dequantization.Data[1].Y = std::max((Bounds.Max[1] - Bounds.Min[1]) * 0.5f, 1e-6f);
+    Dequantization.Data[2].Z = std::max((Bounds.Max[2] - Bounds.Min[2]) * 0.5f, 1e-6f);
+    Dequantization.Data[3].X = (Bounds.Max[0] + Bounds.Min[0]) * 0.5f;
+    Dequantization.Data[3].Y = (Bounds.Max[1] + Bounds.Min[1]) * 0.5f;
+    Dequantization.Data[3].Z = (Bounds.Max[2] + Bounds.Min[2]) * 0.5f;
+
+    return Dequantization;
+}
+
+// Tiled and wrapped texture coordinates leave [0, 1], UNORM16 stores them relative to their bounds instead
+static void ComputeTexCoordBounds(FMeshBounds& Bounds, const std::vector<Vertex>& Vertices)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        Bounds.TexCoordMin[i] = Vertices.empty() ? 0.f : std::numeric_limits<float>::max();
+        Bounds.TexCoordMax[i] = Vertices.empty() ? 0.f : std::numeric_limits<float>::lowest();
+    }
+
+    for (const Vertex& Vert : Vertices)
+    {
+        Bounds.TexCoordMin[0] = std::min(Bounds.TexCoordMin[0], Vert.TexCoord.X);
+        Bounds.TexCoordMin[1] = std::min(Bounds.TexCoordMin[1], Vert.TexCoord.Y);
+        Bounds.TexCoordMax[0] = std::max(Bounds.TexCoordMax[0], Vert.TexCoord.X);
+        Bounds.TexCoordMax[1] = std::max(Bounds.TexCoordMax[1], Vert.TexCoord.Y);
+    }
+}
+
+// Scale in XY and offset in ZW, the vertex shader applies it to the texture coordinates it fetches
+static FVector4 GetTexCoordDequantization(const FMeshBounds& Bounds)
+{
+    return FVector4(std::max(Bounds.TexCoordMax[0] - Bounds.TexCoordMin[0], 1e-6f), std::max(Bounds.TexCoordMax[1] - Bounds.TexCoordMin[1], 1e-6f),
+                    Bounds.TexCoordMin[0], Bounds.TexCoordMin[1]);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+static uint16_t FloatToHalf(float Value)
+{
+    uint32_t Bits;
+    std::memcpy(&Bits, &Value, sizeof(Bits));
+
+    uint32_t Sign = (Bits >> 16) & 0x8000u;
+    uint32_t Magnitude = Bits & 0x7FFFFFFFu;
+
+    if (Magnitude >= 0x7F800000u)
+    {
+        return static_cast<uint16_t>(Sign | 0x7C00u | (Magnitude > 0x7F800000u ? 0x200u : 0u));
+    }
+
+    if (Magnitude >= 0x477FF000u)
+    {
+        return static_cast<uint16_t>(Sign | 0x7C00u);
+    }
+
+    if (Magnitude < 0x38800000u)
+    {
+        float Denormal;
+        std::memcpy(&Denormal, &Magnitude, sizeof(Denormal));
+        return static_cast<uint16_t>(Sign | static_cast<uint32_t>(std::nearbyint(Denormal * 16777216.f)));
+    }
+
+    uint32_t RoundToEven = ((Magnitude >> 13) & 1u) + 0xFFFu;
+    return static_cast<uint16_t>(Sign | ((Magnitude - 0x38000000u + RoundToEven) >> 13));
+}
+
+static int16_t QuantizeSnorm16(float Value)
+{
+    return static_cast<int16_t>(std::lround(std::clamp(Value, -1.f, 1.f) * 32767.f));
+}
+
+static uint16_t QuantizeUnorm16(float Value)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(Value, 0.f, 1.f) * 65535.f));
+}
+
+static uint8_t QuantizeUnorm8(float Value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(Value, 0.f, 1.f) * 255.f));
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "virtual_texture_cache.h"
+
+#include <cstdint>
+#include <list>
+#include <vector>
+
+// The physical page atlas is this many pages wide and high, all virtual textures share its slots
+const uint32_t VIRTUAL_TEXTURE_ATLAS_PAGES = 16;
+const uint32_t VIRTUAL_TEXTURE_UPLOADS_PER_FRAME = 8;
+const uint32_t VIRTUAL_TEXTURE_MAX_PENDING_READS = 32;
+const uint32_t VIRTUAL_TEXTURE_NO_SLOT = UINT32_MAX;
+const uint64_t VIRTUAL_TEXTURE_NO_PAGE = UINT64_MAX;
+
+// Identifies a page of any virtual texture, Texture being its index in the application's texture list
+static uint64_t GetVirtualPageKey(std::size_t Texture, uint32_t Page)
+{
+    return static_cast<uint64_t>(Texture) << 32 | Page;
+}
+
+// Slots of the page atlas with least recently used replacement. Pinned slots are never replaced, and neither are
+// slots used in the current frame, replacing those could only evict another page the same frame asks for.
+class FPageCache
+{
+public:
+    explicit FPageCache(uint32_t SlotCount = 0)
+    {
+        Reset(SlotCount);
+    }
+
+    void Reset(uint32_t SlotCount)
+    {
+        Slots.assign(SlotCount, FSlot{});
+        Lru.clear();
+
+        for (uint32_t Slot = 0; Slot < SlotCount; ++Slot)
+        {
+            Slots[Slot].Position = Lru.insert(Lru.end(), Slot);
+        }
+    }
+
+    uint32_t GetSlotCount() const
+    {
+        return static_cast<uint32_t>(Slots.size());
+    }
+
+    uint64_t GetPage(uint32_t Slot) const
+    {
+        return Slots[Slot].Page;
+    }
+
+    void Touch(uint32_t Slot, uint64_t Frame)
+    {
+        Slots[Slot].LastUse = Frame;
+
+        if (!Slots[Slot].bPinned)
+        {
+            Lru.splice(Lru.end(), Lru, Slots[Slot].Position);
+        }
+    }
+
+    // Returns the slot Page is loaded into, the page the slot held before is returned in EvictedPage
+    uint32_t Allocate(uint64_t Page, uint64_t Frame, bool bPinned, uint64_t& EvictedPage)
+    {
+        if (Lru.empty() || (Slots[Lru.front()].Page != VIRTUAL_TEXTURE_NO_PAGE && Slots[Lru.front()].LastUse == Frame))
+        {
+            return VIRTUAL_TEXTURE_NO_SLOT;
+        }
+
+        uint32_t Slot = Lru.front();
+        EvictedPage = Slots[Slot].Page;
+        Slots[Slot].Page = Page;
+        Slots[Slot].bPinned = bPinned;
+        Lru.erase(Slots[Slot].Position);
+
+        if (!bPinned)
+        {
+            Slots[Slot].Position = Lru.insert(Lru.end(), Slot);
+        }
+
+        Touch(Slot, Frame);
+
+        return Slot;
+    }
+
+private:
+    struct FSlot
+    {
+        uint64_t Page = VIRTUAL_TEXTURE_NO_PAGE;
+        uint64_t LastUse = 0;
+        bool bPinned = false;
+        std::list<uint32_t>::iterator Position;
+    };
+
+    std::vector<FSlot> Slots;
+    // Unpinned slots, least recently used first
+    std::list<uint32_t> Lru;
+};
+
+// Every texel of the indirection chain names the atlas slot and the level of the finest resident page covering it,
+// packed like VK_FORMAT_R8G8B8A8_UINT as slot x, slot y and level. Pages that are not resident take the entry of
+// the page a level above, the coarsest level is always resident.
+static void BuildVirtualTextureIndirection(const FVirtualTextureHeader& Header, const std::vector<uint32_t>& PageSlots, std::vector<uint32_t>& Entries)
+{
+    Entries.assign(Header.PageCount, 0);
+
+    for (uint32_t Level = Header.LevelCount; Level-- > 0;)
+    {
+        const FVirtualTextureLevel& Pages = Header.Levels[Level];
+
+        for (uint32_t y = 0; y < Pages.PagesY; ++y)
+        {
+            for (uint32_t x = 0; x < Pages.PagesX; ++x)
+            {
+                uint32_t Page = Pages.FirstPage + y * Pages.PagesX + x;
+                uint32_t Slot = PageSlots[Page];
+
+                if (Slot != VIRTUAL_TEXTURE_NO_SLOT)
+                {
+                    Entries[Page] = Slot % VIRTUAL_TEXTURE_ATLAS_PAGES | (Slot / VIRTUAL_TEXTURE_ATLAS_PAGES) << 8 | Level << 16;
+                }
+                else if (Level + 1 < Header.LevelCount)
+                {
+                    const FVirtualTextureLevel& Parent = Header.Levels[Level + 1];
+                    Entries[Page] = Entries[Parent.FirstPage + y / 2 * Parent.PagesX + x / 2];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "cooked_assets.h"
+#include "mapped_file.h"
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const uint32_t VIRTUAL_TEXTURE_MAGIC = 0x54585456;
+const uint32_t VIRTUAL_TEXTURE_VERSION = 1;
+const uint32_t VIRTUAL_TEXTURE_PAGE_SIZE = 128;
+// Pages repeat this many texels of their neighbours, bilinear filtering then never reads into another page of the atlas
+const uint32_t VIRTUAL_TEXTURE_PAGE_BORDER = 4;
+const uint32_t VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE = VIRTUAL_TEXTURE_PAGE_SIZE + 2 * VIRTUAL_TEXTURE_PAGE_BORDER;
+const uint64_t VIRTUAL_TEXTURE_PAGE_BYTES = uint64_t{VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE} * VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE * 4;
+const std::string VIRTUAL_TEXTURE_EXTENSION = ".vtcache";
+
+struct FVirtualTextureLevel
+{
+    uint32_t PagesX;
+    uint32_t PagesY;
+    uint32_t FirstPage;
+};
+
+// Pages are stored level by level from the full resolution down, row by row within a level, each one
+// VIRTUAL_TEXTURE_PAGE_BYTES of R8G8B8A8 texels including its border
+struct FVirtualTextureHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t SourceHash;
+    uint32_t Format;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t LevelCount;
+    uint32_t PageCount;
+    FVirtualTextureLevel Levels[TEXTURE_CACHE_MAX_LEVELS];
+};
+
+static std::string GetCookedVirtualTexturePath(const std::string& SourcePath)
+{
+    return GetCookedAssetPath(SourcePath, VIRTUAL_TEXTURE_EXTENSION);
+}
+
+// Virtual textures are a power of two number of whole pages wide and high, sources of other sizes are resampled
+static uint32_t GetVirtualTextureExtent(uint32_t Size)
+{
+    uint32_t Extent = VIRTUAL_TEXTURE_PAGE_SIZE;
+
+    while (Extent < Size)
+    {
+        Extent *= 2;
+    }
+
+    return Extent;
+}
+
+// Only levels at least a page wide and high are paged, sampling further away stays on the coarsest one
+static uint32_t GetVirtualTextureLevelCount(uint32_t Width, uint32_t Height)
+{
+    uint32_t LevelCount = 1;
+
+    while (LevelCount < TEXTURE_CACHE_MAX_LEVELS && std::min(Width, Height) >> LevelCount >= VIRTUAL_TEXTURE_PAGE_SIZE)
+    {
+        ++LevelCount;
+    }
+
+    return LevelCount;
+}
+
+static bool IsVirtualTextureExtent(uint32_t Width, uint32_t Height)
+{
+    return Width == GetVirtualTextureExtent(Width) && Height == GetVirtualTextureExtent(Height);
+}
+
+static uint32_t FillVirtualTextureLevels(FVirtualTextureHeader& Header)
+{
+    uint32_t PageCount = 0;
+
+    for (uint32_t Level = 0; Level < Header.LevelCount; ++Level)
+    {
+        Header.Levels[Level] = {(Header.Width >> Level) / VIRTUAL_TEXTURE_PAGE_SIZE, (Header.Height >> Level) / VIRTUAL_TEXTURE_PAGE_SIZE, PageCount};
+        PageCount += Header.Levels[Level].PagesX * Header.Levels[Level].PagesY;
+    }
+
+    return PageCount;
+}
+
+// Borders wrap around the level, matching the repeat addressing of the regular texture sampler
+static void BuildVirtualTexturePage(const FTextureMip& Mip, uint32_t PageX, uint32_t PageY, std::vector<uint8_t>& Page)
+{
+    Page.resize(VIRTUAL_TEXTURE_PAGE_BYTES);
+
+    for (uint32_t y = 0; y < VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE; ++y)
+    {
+        uint32_t SourceY = (PageY * VIRTUAL_TEXTURE_PAGE_SIZE + y + Mip.Height - VIRTUAL_TEXTURE_PAGE_BORDER) % Mip.Height;
+
+        for (uint32_t x = 0; x < VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE; ++x)
+        {
+            uint32_t SourceX = (PageX * VIRTUAL_TEXTURE_PAGE_SIZE + x + Mip.Width - VIRTUAL_TEXTURE_PAGE_BORDER) % Mip.Width;
+            std::memcpy(&Page[(static_cast<std::size_t>(y) * VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE + x) * 4], &Mip.Data[(static_cast<std::size_t>(SourceY) * Mip.Width + SourceX) * 4], 4);
+        }
+    }
+}
+
+static bool WriteVirtualTexture(const std::string& Path, uint64_t SourceHash, uint32_t Format, const std::vector<FTextureMip>& Mips)
+{
+    if (Mips.empty() || !IsVirtualTextureExtent(Mips[0].Width, Mips[0].Height))
+    {
+        return false;
+    }
+
+    FVirtualTextureHeader Header{};
+    Header.Magic = VIRTUAL_TEXTURE_MAGIC;
+    Header.Version = VIRTUAL_TEXTURE_VERSION;
+    Header.SourceHash = SourceHash;
+    Header.Format = Format;
+    Header.Width = Mips[0].Width;
+    Header.Height = Mips[0].Height;
+    Header.LevelCount = std::min(GetVirtualTextureLevelCount(Header.Width, Header.Height), static_cast<uint32_t>(Mips.size()));
+    Header.PageCount = FillVirtualTextureLevels(Header);
+
+    std::string TemporaryPath = Path + ".tmp";
+
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+
+        if (!File)
+        {
+            return false;
+        }
+
+        const char Padding[TEXTURE_CACHE_ALIGNMENT] = {};
+        File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+        File.write(Padding, static_cast<std::streamsize>(AlignTextureCacheOffset(sizeof(Header)) - sizeof(Header)));
+
+        std::vector<uint8_t> Page;
+
+        for (uint32_t Level = 0; Level < Header.LevelCount; ++Level)
+        {
+            for (uint32_t PageY = 0; PageY < Header.Levels[Level].PagesY; ++PageY)
+            {
+                for (uint32_t PageX = 0; PageX < Header.Levels[Level].PagesX; ++PageX)
+                {
+                    BuildVirtualTexturePage(Mips[Level], PageX, PageY, Page);
+                    File.write(reinterpret_cast<const char*>(Page.data()), static_cast<std::streamsize>(Page.size()));
+                }
+            }
+        }
+
+        if (!File)
+        {
+            return false;
+        }
+    }
+
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, Path, Error);
+
+    if (Error)
+    {
+        std::filesystem::remove(TemporaryPath, Error);
+        return false;
+    }
+
+    return true;
+}
+
+// Pages are read straight out of a random access mapping, only the pages that are sampled are ever paged in
+class FVirtualTextureCache
+{
+public:
+    bool Open(const std::string& Path)
+    {
+        Close();
+
+        if (!File.Open(Path, EMappedFileAccess::Random) || File.GetSize() < sizeof(FVirtualTextureHeader))
+        {
+            Close();
+            return false;
+        }
+
+        std::memcpy(&Header, File.GetData(), sizeof(Header));
+
+        FVirtualTextureHeader Expected = Header;
+        bool bValid = Header.Magic == VIRTUAL_TEXTURE_MAGIC &&
+                      Header.Version == VIRTUAL_TEXTURE_VERSION &&
+                      IsVirtualTextureExtent(Header.Width, Header.Height) &&
+                      Header.LevelCount > 0 && Header.LevelCount <= GetVirtualTextureLevelCount(Header.Width, Header.Height) &&
+                      FillVirtualTextureLevels(Expected) == Header.PageCount &&
+                      std::memcmp(Expected.Levels, Header.Levels, sizeof(Header.Levels)) == 0 &&
+                      AlignTextureCacheOffset(sizeof(Header)) + Header.PageCount * VIRTUAL_TEXTURE_PAGE_BYTES <= File.GetSize();
+
+        if (!bValid)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close()
+    {
+        File.Close();
+        Header = FVirtualTextureHeader{};
+    }
+
+    bool IsLoaded() const
+    {
+        return Header.Magic == VIRTUAL_TEXTURE_MAGIC;
+    }
+
+    const FVirtualTextureHeader& GetHeader() const
+    {
+        return Header;
+    }
+
+    uint32_t GetPageIndex(uint32_t Level, uint32_t PageX, uint32_t PageY) const
+    {
+        return Header.Levels[Level].FirstPage + PageY * Header.Levels[Level].PagesX + PageX;
+    }
+
+    uint32_t GetPageLevel(uint32_t Page) const
+    {
+        uint32_t Level = 0;
+
+        while (Level + 1 < Header.LevelCount && Page >= Header.Levels[Level + 1].FirstPage)
+        {
+            ++Level;
+        }
+
+        return Level;
+    }
+
+    const char* GetPageData(uint32_t Page) const
+    {
+        return File.GetData() + AlignTextureCacheOffset(sizeof(Header)) + Page * VIRTUAL_TEXTURE_PAGE_BYTES;
+    }
+
+    // Reads one byte of every memory page the page spans, so copying it out afterwards does not wait on the disk
+    void PrefaultPage(uint32_t Page) const
+    {
+        volatile char Sink = 0;
+        const char* Data = GetPageData(Page);
+
+        for (uint64_t Offset = 0; Offset < VIRTUAL_TEXTURE_PAGE_BYTES; Offset += MAPPED_FILE_PAGE_SIZE)
+        {
+            Sink = Sink + Data[Offset];
+        }
+    }
+
+private:
+    FMappedFile File;
+    FVirtualTextureHeader Header{};
+};
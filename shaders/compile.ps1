@@ -1,2 +1,3 @@
 glslc.exe triangle.vert -o triangle_vert.spv
-glslc.exe triangle.frag -o triangle_frag.spv
\ No newline at end of file
+glslc.exe triangle.frag -o triangle_frag.spv
+glslc.exe virtual_texture.frag -o virtual_texture_frag.spv
\ No newline at end of file
@@ -1,14 +1,22 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) out vec4 OutColor;
 
 layout(location = 0) in vec3 FragColor;
 layout(location = 1) in vec2 FragTexCoord;
 
-layout(binding = 1) uniform sampler2D TexSampler;
+// Every texture of the scene, indexed by the draw's push constants
+layout(binding = 1) uniform sampler2D Textures[];
+
+layout(push_constant) uniform DrawConstants
+{
+    uint Texture;
+    uint FeedbackOffset;
+};
 
 void main()
 {
-    OutColor = texture(TexSampler, FragTexCoord);
+    OutColor = texture(Textures[Texture], FragTexCoord);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ layout(binding = 0) uniform UniformBufferObject
     mat4 Model;
     mat4 View;
     mat4 Projection;
+    vec4 TexCoordDequantization;
 } UBO;
 
 layout(location = 0) in vec3 Position;
@@ -19,5 +20,5 @@ void main()
 {
     gl_Position = UBO.Projection * UBO.View * UBO.Model * vec4(Position, 1.0);
     FragColor = Color;
-    FragTexCoord = TexCoord;
+    FragTexCoord = TexCoord * UBO.TexCoordDequantization.xy + UBO.TexCoordDequantization.zw;
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Match VIRTUAL_TEXTURE_PAGE_SIZE and VIRTUAL_TEXTURE_PAGE_BORDER in include/virtual_texture_cache.h
+const float PAGE_SIZE = 128.0;
+const float PAGE_BORDER = 4.0;
+
+layout(location = 0) out vec4 OutColor;
+
+layout(location = 0) in vec3 FragColor;
+layout(location = 1) in vec2 FragTexCoord;
+
+layout(binding = 1) uniform usampler2D Indirections[];
+layout(binding = 2) uniform sampler2D PageAtlas;
+
+// One flag per page of every virtual texture, level by level from the full resolution down
+layout(binding = 3) buffer Feedback
+{
+    uint Requested[];
+};
+
+layout(push_constant) uniform DrawConstants
+{
+    uint Texture;
+    // Index of the drawn texture's first flag in Requested
+    uint FeedbackOffset;
+};
+
+void main()
+{
+    int LevelCount = textureQueryLevels(Indirections[Texture]);
+    vec2 TexelCoord = FragTexCoord * vec2(textureSize(Indirections[Texture], 0)) * PAGE_SIZE;
+    vec2 Dx = dFdx(TexelCoord);
+    vec2 Dy = dFdy(TexelCoord);
+    float Lod = 0.5 * log2(max(max(dot(Dx, Dx), dot(Dy, Dy)), 1.0));
+    int Level = min(int(Lod), LevelCount - 1);
+
+    vec2 Uv = fract(FragTexCoord);
+    ivec2 PageCount = textureSize(Indirections[Texture], Level);
+    ivec2 Page = min(ivec2(Uv * vec2(PageCount)), PageCount - 1);
+    uint PageIndex = FeedbackOffset + uint(Page.y * PageCount.x + Page.x);
+
+    for (int i = 0; i < Level; ++i)
+    {
+        ivec2 LevelPageCount = textureSize(Indirections[Texture], i);
+        PageIndex += uint(LevelPageCount.x * LevelPageCount.y);
+    }
+
+    if (Requested[PageIndex] == 0u)
+    {
+        Requested[PageIndex] = 1u;
+    }
+
+    // The entry names the atlas slot of the finest resident page covering this one, possibly from a coarser level
+    uvec3 Entry = texelFetch(Indirections[Texture], Page, Level).xyz;
+    vec2 PageTexel = fract(Uv * vec2(textureSize(Indirections[Texture], int(Entry.z)))) * PAGE_SIZE;
+    vec2 AtlasTexel = vec2(Entry.xy) * (PAGE_SIZE + 2.0 * PAGE_BORDER) + PAGE_BORDER + PageTexel;
+
+    OutColor = textureLod(PageAtlas, AtlasTexel / vec2(textureSize(PageAtlas, 0)), 0.0);
+}
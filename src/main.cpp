@@ -6,13 +6,18 @@
 #define GLM_ENABLE_EXPERIMENTAL
 
 #include "main.h"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
-
+#include "shader_watcher.h"
+#include "cooked_assets.h"
+#include "mesh_cache.h"
+#include "mesh_codec.h"
+#include "task_pool.h"
+#include "texture_cache.h"
+#include "texture_formats.h"
+#include "texture_streaming.h"
+#include "vertex_format.h"
+#include "virtual_texture.h"
+
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstdlib>
@@ -24,88 +29,77 @@
 #include <vector>
 #include <unordered_map>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <functional>
 
 using uint = std::uint32_t;
 
 const uint WIDTH = 1920;
 const uint HEIGHT = 1080;
 const int MAX_FRAMES_IN_FLIGHT = 2;
+const float LOD_PIXEL_ERROR_THRESHOLD = 1.f;
+const std::size_t MODEL_STREAM_CHUNK_SIZE = 1 << 20;
+const uint8_t MODEL_CONSTANT_COLOR[4] = {255, 255, 255, 255};
+const VkFormat VIRTUAL_TEXTURE_ATLAS_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+// Size of the bindless texture table, draws address it through FDrawConstants::Texture
+const uint32_t MAX_BINDLESS_TEXTURES = 4096;
+
+const FVector3 CAMERA_POSITION = FVector3(2.f, 2.f, 2.f);
+const float CAMERA_FOV = 0.785398f;
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 10.f;
 
 const std::string MODEL_PATH = "models/viking_room/viking_room.obj";
 const std::string TEXTURE_PATH = "models/viking_room/viking_room.png";
+const std::string VERTEX_SHADER_PATH = "shaders/triangle_vert.spv";
+const std::string FRAGMENT_SHADER_PATH = "shaders/triangle_frag.spv";
+const std::string VIRTUAL_TEXTURE_FRAGMENT_SHADER_PATH = "shaders/virtual_texture_frag.spv";
+const std::string SHADER_DIRECTORY = "shaders";
+const std::string SHADER_COMPILER = "glslc";
 
 const std::vector<const char*> ValidationLayers = {
         "VK_LAYER_KHRONOS_validation"
 };
 
 const std::vector<const char*> DeviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
+        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+        VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
+};
+
+const std::vector<const char*> PipelineLibraryExtensions = {
+        VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+        VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME
+};
+
+const std::vector<const char*> HostImageCopyExtensions = {
+        VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME,
+        VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME,
+        VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME
 };
 
 #ifndef NDEBUG
 const bool bEnableValidationLayers = true;
+const bool bEnableShaderHotReload = true;
 #else
 const bool bEnableValidationLayers = false;
+const bool bEnableShaderHotReload = false;
 #endif
 
-struct Vertex {
-    FVector3 Pos;
-    FVector3 Color;
-    FVector2 TexCoord;
-
-    static VkVertexInputBindingDescription GetBindingDescription()
-    {
-        VkVertexInputBindingDescription BindingDescription{};
-        BindingDescription.binding = 0;
-        BindingDescription.stride = sizeof(Vertex);
-        BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        return BindingDescription;
-    }
-
-    static std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions()
-    {
-        std::array<VkVertexInputAttributeDescription, 3> AttributeDescription{};
-        AttributeDescription[0].binding = 0;
-        AttributeDescription[0].location = 0;
-        AttributeDescription[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-        AttributeDescription[0].offset = offsetof(Vertex, Pos);
-
-        AttributeDescription[1].binding = 0;
-        AttributeDescription[1].location = 1;
-        AttributeDescription[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        AttributeDescription[1].offset = offsetof(Vertex, Color);
-
-        AttributeDescription[2].binding = 0;
-        AttributeDescription[2].location = 2;
-        AttributeDescription[2].format = VK_FORMAT_R32G32_SFLOAT;
-        AttributeDescription[2].offset = offsetof(Vertex, TexCoord);
-
-        return AttributeDescription;
-    }
-
-    bool operator==(const Vertex& Other) const
-    {
-        return Pos == Other.Pos && Color == Other.Color && TexCoord == Other.TexCoord;
-    }
-
-};
-
-template<> struct std::hash<Vertex>
-{
-    size_t operator()(Vertex const& Vertex) const
-    {
-        return ((std::hash<FVector3>()(Vertex.Pos) ^
-                (std::hash<FVector3>()(Vertex.Color) << 1)) >> 1) ^
-                (std::hash<FVector2>()(Vertex.TexCoord) << 1);
-    }
-};
-
 struct UniformBufferObject
 {
     alignas(16) FMatrix4 Model;
     alignas(16) FMatrix4 View;
     alignas(16) FMatrix4 Projection;
+    alignas(16) FVector4 TexCoordDequantization;
+};
+
+// Pushed before every draw, the fragment shader reads its texture out of the bindless table with it
+struct FDrawConstants
+{
+    uint32_t Texture;
+    // Index of the texture's first page flag in the feedback buffer, only read by the virtual texture shader
+    uint32_t FeedbackOffset;
 };
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
@@ -165,6 +159,7 @@ class FHelloTriangleApplication
 public:
     void Run()
     {
+        StartAssetLoading();
         InitWindow();
         InitVulkan();
         MainLoop();
@@ -190,6 +185,119 @@ private:
         std::vector<VkPresentModeKHR> PresentModes;
     };
 
+    struct FShaderModuleCacheEntry
+    {
+        uint64_t Hash;
+        VkShaderModule Module;
+    };
+
+    enum class EModelStream
+    {
+        ConstantColor,
+        Vertices,
+        Indices,
+        Meshlets,
+        MeshletVertices,
+        MeshletTriangles,
+        Count
+    };
+
+    struct FModelStream
+    {
+        VkBuffer Buffer;
+        VkDeviceSize BufferOffset;
+        const char* Source;
+        VkDeviceSize Size;
+        VkDeviceSize Uploaded;
+        VkDeviceSize Pending;
+        // Non-zero when Source holds a mesh codec stream of Stride byte elements, which is decoded into staging memory
+        std::size_t EncodedSize;
+        uint32_t Stride;
+    };
+
+    struct FTexture
+    {
+        VkImage Image;
+        VkDeviceMemory Memory;
+        VkImageView View;
+        VkFormat Format;
+        FTextureResidency Residency;
+        // Stays open while the texture lives, evicted levels stream back in from it
+        std::unique_ptr<FTextureCache> Source;
+        std::chrono::steady_clock::time_point CreateTime;
+        // Bytes written into staging memory for the texture's levels, including levels streamed in again after eviction
+        uint64_t StagedBytes;
+        // Bytes written into the image from host memory instead, stored levels directly and compressed ones once inflated
+        uint64_t HostCopiedBytes;
+        // Set for virtual textures, whose image is the indirection chain and whose pages live in the shared atlas
+        std::unique_ptr<FVirtualTextureCache> VirtualSource;
+        std::vector<uint32_t> PageSlots;
+        VkDeviceSize FeedbackOffset;
+        bool bIndirectionDirty;
+    };
+
+    struct FRetiredTextureImage
+    {
+        std::size_t Texture;
+        VkImage Image;
+        VkDeviceMemory Memory;
+        VkImageView View;
+        std::vector<char> ReferencingSets;
+    };
+
+    struct FStagingBuffer
+    {
+        VkBuffer Buffer;
+        VkDeviceMemory Memory;
+    };
+
+    struct FShaderCompile
+    {
+        std::string SourcePath;
+        std::future<bool> Succeeded;
+        bool bSourceChangedAgain = false;
+    };
+
+    struct FVirtualPageRead
+    {
+        uint64_t Page;
+        std::future<void> Ready;
+    };
+
+    struct FVirtualPageUpload
+    {
+        const FVirtualTextureCache* Source;
+        uint32_t Page;
+        uint32_t Slot;
+    };
+
+    // A streamed level, or when Image is set the image that replaces the texture's image once the copy completes
+    struct FTextureUpload
+    {
+        std::size_t Texture;
+        uint32_t AllocatedLevel;
+        uint32_t ResidentLevel;
+        VkImage Image;
+        VkDeviceMemory Memory;
+    };
+
+    struct FGraphicsPipelineState
+    {
+        VkPipelineShaderStageCreateInfo ShaderStages[2];
+        std::vector<VkVertexInputBindingDescription> BindingDescriptions;
+        std::vector<VkVertexInputAttributeDescription> AttributeDescriptions;
+        VkPipelineVertexInputStateCreateInfo VertexInputInfo;
+        VkPipelineInputAssemblyStateCreateInfo InputAssembly;
+        VkViewport Viewport;
+        VkRect2D Scissors;
+        VkPipelineViewportStateCreateInfo ViewportState;
+        VkPipelineRasterizationStateCreateInfo Rasterizer;
+        VkPipelineMultisampleStateCreateInfo Multisampling;
+        VkPipelineColorBlendAttachmentState ColorBlendAttachment;
+        VkPipelineColorBlendStateCreateInfo ColorBlending;
+        VkPipelineDepthStencilStateCreateInfo DepthStencil;
+    };
+
     std::vector<const char*> GetRequestedExtensions()
     {
         uint GLFWExtensionCount = 0;
@@ -255,6 +363,131 @@ private:
 
     }
 
+    bool CheckGraphicsPipelineLibrarySupport(VkPhysicalDevice Device)
+    {
+        VkPhysicalDeviceProperties Properties{};
+        vkGetPhysicalDeviceProperties(Device, &Properties);
+
+        if (Properties.apiVersion < VK_API_VERSION_1_1)
+        {
+            return false;
+        }
+
+        uint ExtensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(Device, nullptr, &ExtensionCount, nullptr);
+
+        std::vector<VkExtensionProperties>AvailableExtensions(ExtensionCount);
+        vkEnumerateDeviceExtensionProperties(Device, nullptr, &ExtensionCount, AvailableExtensions.data());
+
+        std::set<std::string> RequiredExtensions(PipelineLibraryExtensions.begin(), PipelineLibraryExtensions.end());
+
+        for (const auto& Extension : AvailableExtensions)
+        {
+            RequiredExtensions.erase(Extension.extensionName);
+        }
+
+        if (!RequiredExtensions.empty())
+        {
+            return false;
+        }
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT LibraryFeatures{};
+        LibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+        VkPhysicalDeviceFeatures2 Features{};
+        Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        Features.pNext = &LibraryFeatures;
+        vkGetPhysicalDeviceFeatures2(Device, &Features);
+
+        return LibraryFeatures.graphicsPipelineLibrary == VK_TRUE;
+    }
+
+    // Texture images are written from the host when they can be copied to in the layout they are sampled in
+    bool CheckHostImageCopySupport(VkPhysicalDevice Device)
+    {
+        VkPhysicalDeviceProperties Properties{};
+        vkGetPhysicalDeviceProperties(Device, &Properties);
+
+        if (Properties.apiVersion < VK_API_VERSION_1_1)
+        {
+            return false;
+        }
+
+        uint ExtensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(Device, nullptr, &ExtensionCount, nullptr);
+
+        std::vector<VkExtensionProperties>AvailableExtensions(ExtensionCount);
+        vkEnumerateDeviceExtensionProperties(Device, nullptr, &ExtensionCount, AvailableExtensions.data());
+
+        std::set<std::string> RequiredExtensions(HostImageCopyExtensions.begin(), HostImageCopyExtensions.end());
+
+        for (const auto& Extension : AvailableExtensions)
+        {
+            RequiredExtensions.erase(Extension.extensionName);
+        }
+
+        if (!RequiredExtensions.empty())
+        {
+            return false;
+        }
+
+        VkPhysicalDeviceHostImageCopyFeaturesEXT HostImageCopyFeatures{};
+        HostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+
+        VkPhysicalDeviceFeatures2 Features{};
+        Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        Features.pNext = &HostImageCopyFeatures;
+        vkGetPhysicalDeviceFeatures2(Device, &Features);
+
+        if (HostImageCopyFeatures.hostImageCopy != VK_TRUE)
+        {
+            return false;
+        }
+
+        VkPhysicalDeviceHostImageCopyPropertiesEXT HostImageCopyProperties{};
+        HostImageCopyProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+
+        VkPhysicalDeviceProperties2 Properties2{};
+        Properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        Properties2.pNext = &HostImageCopyProperties;
+        vkGetPhysicalDeviceProperties2(Device, &Properties2);
+
+        std::vector<VkImageLayout> CopyDstLayouts(HostImageCopyProperties.copyDstLayoutCount);
+        HostImageCopyProperties.pCopyDstLayouts = CopyDstLayouts.data();
+        vkGetPhysicalDeviceProperties2(Device, &Properties2);
+
+        return std::find(CopyDstLayouts.begin(), CopyDstLayouts.end(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) != CopyDstLayouts.end();
+    }
+
+    // Textures live in one update after bind array that is only partially written
+    bool CheckDescriptorIndexingSupport(VkPhysicalDevice Device)
+    {
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT IndexingProperties{};
+        IndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+        VkPhysicalDeviceProperties2 Properties{};
+        Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        Properties.pNext = &IndexingProperties;
+        vkGetPhysicalDeviceProperties2(Device, &Properties);
+
+        if (Properties.properties.apiVersion < VK_API_VERSION_1_1)
+        {
+            return false;
+        }
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT IndexingFeatures{};
+        IndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+        VkPhysicalDeviceFeatures2 Features{};
+        Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        Features.pNext = &IndexingFeatures;
+        vkGetPhysicalDeviceFeatures2(Device, &Features);
+
+        return IndexingFeatures.runtimeDescriptorArray && IndexingFeatures.descriptorBindingPartiallyBound && IndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+               IndexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers >= MAX_BINDLESS_TEXTURES &&
+               IndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages >= MAX_BINDLESS_TEXTURES;
+    }
+
     void InitWindow()
     {
         glfwInit();
@@ -284,7 +517,7 @@ private:
         AppInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         AppInfo.pEngineName = "No Engine";
         AppInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        AppInfo.apiVersion = VK_API_VERSION_1_0;
+        AppInfo.apiVersion = VK_API_VERSION_1_1;
 
         VkInstanceCreateInfo CreateInfo{};
         CreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -477,6 +710,7 @@ private:
 
         vkFreeCommandBuffers(Device, CommandPool, static_cast<uint32_t>(CommandBuffers.size()), CommandBuffers.data());
 
+        CleanUpPipelineLibraries();
         vkDestroyPipeline(Device, GraphicsPipeline, nullptr);
         vkDestroyPipelineLayout(Device, PipelineLayout, nullptr);
         vkDestroyRenderPass(Device, RenderPass, nullptr);
@@ -494,6 +728,8 @@ private:
             vkFreeMemory(Device, UniformBuffersMemory[i], nullptr);
         }
 
+        DestroyDrawIndirectBuffers();
+        DestroyVirtualTextureFeedbackBuffers();
         vkDestroyDescriptorPool(Device, DescriptorPool, nullptr);
     }
 
@@ -515,14 +751,19 @@ private:
         CreateSwapChain();
         CreateImageViews();
         CreateRenderPass();
+        CreatePipelineLayout();
         CreateGraphicsPipeline();
         CreateColorResources();
         CreateDepthResources();
         CreateFramebuffers();
         CreateUniformBuffers();
+        CreateDrawIndirectBuffers();
+        CreateVirtualTextureFeedbackBuffers();
         CreateDescriptorPool();
         CreateDescriptorSet();
         CreateCommandBuffers();
+
+        ImagesInFlight.assign(SwapChainImages.size(), VK_NULL_HANDLE);
     }
 
     void SetupDebugMessenger()
@@ -558,7 +799,9 @@ private:
         VkPhysicalDeviceFeatures  SupportedFeatures;
         vkGetPhysicalDeviceFeatures(Device, &SupportedFeatures);
 
-        return Indices.IsComplete() && ExtensionsSupported && SwapChainAdequate && SupportedFeatures.samplerAnisotropy;
+        return Indices.IsComplete() && ExtensionsSupported && SwapChainAdequate && SupportedFeatures.samplerAnisotropy &&
+               SupportedFeatures.shaderSampledImageArrayDynamicIndexing && (!bVirtualTexturing || SupportedFeatures.fragmentStoresAndAtomics) &&
+               CheckDescriptorIndexingSupport(Device);
     }
 
     void PickPhysicalDevice()
@@ -580,6 +823,10 @@ private:
             {
                 PhysicalDevice = Device;
                 MSAASamples = GetMaxUSableSampleCount();
+                bGraphicsPipelineLibrarySupported = CheckGraphicsPipelineLibrarySupport(Device);
+                bHostImageCopySupported = CheckHostImageCopySupport(Device);
+                SupportedTextureFormats = GetSupportedTextureFormats();
+                HostImageCopyFormats = GetHostImageCopyFormats();
                 break;
             }
         }
@@ -646,17 +893,54 @@ private:
             QueueCreateInfos.push_back(QueueCreateInfo);
         }
 
+        VkPhysicalDeviceFeatures SupportedFeatures;
+        vkGetPhysicalDeviceFeatures(PhysicalDevice, &SupportedFeatures);
+
         VkPhysicalDeviceFeatures DeviceFeatures{};
         DeviceFeatures.samplerAnisotropy = VK_TRUE;
         DeviceFeatures.sampleRateShading = VK_TRUE;
+        DeviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+        DeviceFeatures.textureCompressionBC = SupportedFeatures.textureCompressionBC;
+        DeviceFeatures.fragmentStoresAndAtomics = bVirtualTexturing ? VK_TRUE : VK_FALSE;
+
+        std::vector<const char*> EnabledExtensions(DeviceExtensions.begin(), DeviceExtensions.end());
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT LibraryFeatures{};
+        LibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+        LibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT IndexingFeatures{};
+        IndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        IndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        IndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        IndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+
+        VkPhysicalDeviceHostImageCopyFeaturesEXT HostImageCopyFeatures{};
+        HostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+        HostImageCopyFeatures.hostImageCopy = VK_TRUE;
 
         VkDeviceCreateInfo CreateInfo{};
         CreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        CreateInfo.pNext = &IndexingFeatures;
+
+        if (bGraphicsPipelineLibrarySupported)
+        {
+            EnabledExtensions.insert(EnabledExtensions.end(), PipelineLibraryExtensions.begin(), PipelineLibraryExtensions.end());
+            IndexingFeatures.pNext = &LibraryFeatures;
+        }
+
+        if (bHostImageCopySupported)
+        {
+            EnabledExtensions.insert(EnabledExtensions.end(), HostImageCopyExtensions.begin(), HostImageCopyExtensions.end());
+            HostImageCopyFeatures.pNext = &IndexingFeatures;
+            CreateInfo.pNext = &HostImageCopyFeatures;
+        }
+
         CreateInfo.pQueueCreateInfos = QueueCreateInfos.data();
         CreateInfo.queueCreateInfoCount = static_cast<uint>(QueueCreateInfos.size());
         CreateInfo.pEnabledFeatures = &DeviceFeatures;
-        CreateInfo.enabledExtensionCount = static_cast<uint>(DeviceExtensions.size());
-        CreateInfo.ppEnabledExtensionNames = DeviceExtensions.data();
+        CreateInfo.enabledExtensionCount = static_cast<uint>(EnabledExtensions.size());
+        CreateInfo.ppEnabledExtensionNames = EnabledExtensions.data();
         if (bEnableValidationLayers)
         {
             CreateInfo.enabledLayerCount = static_cast<uint>(ValidationLayers.size());
@@ -674,6 +958,12 @@ private:
 
         vkGetDeviceQueue(Device, Indices.GraphicsFamily.value(), 0, &GraphicsQueue);
         vkGetDeviceQueue(Device, Indices.PresentFamily.value(), 0, &PresentQueue);
+
+        if (bHostImageCopySupported)
+        {
+            CopyMemoryToImageEXT = (PFN_vkCopyMemoryToImageEXT) vkGetDeviceProcAddr(Device, "vkCopyMemoryToImageEXT");
+            TransitionImageLayoutEXT = (PFN_vkTransitionImageLayoutEXT) vkGetDeviceProcAddr(Device, "vkTransitionImageLayoutEXT");
+        }
     }
 
     void CreateSurface()
@@ -710,146 +1000,208 @@ private:
         return ShaderModule;
     }
 
-    void CreateGraphicsPipeline()
+    VkShaderModule GetShaderModule(const std::string& Path)
+    {
+        auto It = ShaderModuleCache.find(Path);
+
+        if (It != ShaderModuleCache.end())
+        {
+            return It->second.Module;
+        }
+
+        auto Code = ReadFile(Path);
+
+        FShaderModuleCacheEntry Entry{};
+        Entry.Hash = HashBytes(Code.data(), Code.size());
+        Entry.Module = CreateShaderModule(Code);
+        ShaderModuleCache[Path] = Entry;
+
+        return Entry.Module;
+    }
+
+    void ClearShaderModuleCache()
+    {
+        for (auto& Entry : ShaderModuleCache)
+        {
+            vkDestroyShaderModule(Device, Entry.second.Module, nullptr);
+        }
+
+        ShaderModuleCache.clear();
+    }
+
+    void FillGraphicsPipelineState(FGraphicsPipelineState& State)
     {
-        std::cout << std::filesystem::current_path() << std::endl;
-        auto VertexShaderCode = ReadFile("shaders/triangle_vert.spv");
-        auto FragmentShaderCode = ReadFile("shaders/triangle_frag.spv");
-
-        VkShaderModule VertexShaderModule = CreateShaderModule(VertexShaderCode);
-        VkShaderModule FragmentShaderModule = CreateShaderModule(FragmentShaderCode);
-
-        VkPipelineShaderStageCreateInfo VertShaderStageInfo{};
-        VertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        VertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        VertShaderStageInfo.module = VertexShaderModule;
-        VertShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo FragmentShaderStageInfo{};
-        FragmentShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        FragmentShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        FragmentShaderStageInfo.module = FragmentShaderModule;
-        FragmentShaderStageInfo.pName = "main";
-
-        VkPipelineShaderStageCreateInfo ShaderStages[] = {VertShaderStageInfo, FragmentShaderStageInfo};
-
-
-        VkPipelineVertexInputStateCreateInfo VertexInputInfo{};
-        VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-
-        auto BindingDescription = Vertex::GetBindingDescription();
-        auto AttributeDescriptions = Vertex::GetAttributeDescriptions();
-
-        VertexInputInfo.vertexBindingDescriptionCount = 1;
-        VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint>(AttributeDescriptions.size());
-        VertexInputInfo.pVertexBindingDescriptions = &BindingDescription;
-        VertexInputInfo.pVertexAttributeDescriptions = AttributeDescriptions.data();
-
-        VkPipelineInputAssemblyStateCreateInfo InputAssembly{};
-        InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        InputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        InputAssembly.primitiveRestartEnable = VK_FALSE;
-
-        VkViewport Viewport{};
-        Viewport.x = 0.f;
-        Viewport.y = 0.f;
-        Viewport.width = (float)SwapChainExtent.width;
-        Viewport.height = (float)SwapChainExtent.height;
-        Viewport.minDepth = 0.f;
-        Viewport.maxDepth = 1.f;
-
-        VkRect2D Scissors{};
-        Scissors.offset = {0, 0};
-        Scissors.extent = SwapChainExtent;
-
-        VkPipelineViewportStateCreateInfo ViewportState{};
-        ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-        ViewportState.viewportCount = 1;
-        ViewportState.pViewports = &Viewport;
-        ViewportState.scissorCount = 1;
-        ViewportState.pScissors = &Scissors;
-
-        VkPipelineRasterizationStateCreateInfo Rasterizer{};
-        Rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        Rasterizer.depthClampEnable = VK_FALSE;
-        Rasterizer.rasterizerDiscardEnable = VK_FALSE;
-        Rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-        Rasterizer.lineWidth = 1.f;
-        Rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-        Rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-        Rasterizer.depthBiasEnable = VK_FALSE;
-        Rasterizer.depthBiasConstantFactor = 0.f;
-        Rasterizer.depthBiasClamp = 0.f;
-        Rasterizer.depthBiasSlopeFactor = 0.f;
-
-        VkPipelineMultisampleStateCreateInfo Multisampling{};
-        Multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-        Multisampling.sampleShadingEnable = VK_TRUE;
-        Multisampling.rasterizationSamples = MSAASamples;
-        Multisampling.minSampleShading = 0.2f;
-        Multisampling.pSampleMask = nullptr;
-        Multisampling.alphaToCoverageEnable = VK_FALSE;
-        Multisampling.alphaToOneEnable = VK_FALSE;
-
-        VkPipelineColorBlendAttachmentState ColorBlendAttachment{};
-        ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+        State.ShaderStages[0] = {};
+        State.ShaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        State.ShaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        State.ShaderStages[0].module = GetShaderModule(VERTEX_SHADER_PATH);
+        State.ShaderStages[0].pName = "main";
+
+        State.ShaderStages[1] = {};
+        State.ShaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        State.ShaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        State.ShaderStages[1].module = GetShaderModule(GetFragmentShaderPath());
+        State.ShaderStages[1].pName = "main";
+
+        FMeshVertexLayout Layout = GetVertexLayout(MODEL_VERTEX_FORMAT);
+        State.BindingDescriptions = {{0, Layout.Stride, VK_VERTEX_INPUT_RATE_VERTEX}};
+        State.AttributeDescriptions.clear();
+
+        for (uint32_t i = 0; i < Layout.AttributeCount; ++i)
+        {
+            State.AttributeDescriptions.push_back({Layout.Attributes[i].Location, 0, static_cast<VkFormat>(Layout.Attributes[i].Format), Layout.Attributes[i].Offset});
+        }
+
+        if (MODEL_VERTEX_FORMAT.ColorFormat == EVertexColorFormat::Constant)
+        {
+            State.BindingDescriptions.push_back({1, 0, VK_VERTEX_INPUT_RATE_INSTANCE});
+            State.AttributeDescriptions.push_back({1, 1, VK_FORMAT_R8G8B8A8_UNORM, 0});
+        }
+
+        State.VertexInputInfo = {};
+        State.VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        State.VertexInputInfo.vertexBindingDescriptionCount = static_cast<uint>(State.BindingDescriptions.size());
+        State.VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint>(State.AttributeDescriptions.size());
+        State.VertexInputInfo.pVertexBindingDescriptions = State.BindingDescriptions.data();
+        State.VertexInputInfo.pVertexAttributeDescriptions = State.AttributeDescriptions.data();
+
+        State.InputAssembly = {};
+        State.InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        State.InputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        State.InputAssembly.primitiveRestartEnable = VK_FALSE;
+
+        State.Viewport = {};
+        State.Viewport.x = 0.f;
+        State.Viewport.y = 0.f;
+        State.Viewport.width = (float)SwapChainExtent.width;
+        State.Viewport.height = (float)SwapChainExtent.height;
+        State.Viewport.minDepth = 0.f;
+        State.Viewport.maxDepth = 1.f;
+
+        State.Scissors = {};
+        State.Scissors.offset = {0, 0};
+        State.Scissors.extent = SwapChainExtent;
+
+        State.ViewportState = {};
+        State.ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        State.ViewportState.viewportCount = 1;
+        State.ViewportState.pViewports = &State.Viewport;
+        State.ViewportState.scissorCount = 1;
+        State.ViewportState.pScissors = &State.Scissors;
+
+        State.Rasterizer = {};
+        State.Rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        State.Rasterizer.depthClampEnable = VK_FALSE;
+        State.Rasterizer.rasterizerDiscardEnable = VK_FALSE;
+        State.Rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+        State.Rasterizer.lineWidth = 1.f;
+        State.Rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+        State.Rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        State.Rasterizer.depthBiasEnable = VK_FALSE;
+        State.Rasterizer.depthBiasConstantFactor = 0.f;
+        State.Rasterizer.depthBiasClamp = 0.f;
+        State.Rasterizer.depthBiasSlopeFactor = 0.f;
+
+        State.Multisampling = {};
+        State.Multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        State.Multisampling.sampleShadingEnable = VK_TRUE;
+        State.Multisampling.rasterizationSamples = MSAASamples;
+        State.Multisampling.minSampleShading = 0.2f;
+        State.Multisampling.pSampleMask = nullptr;
+        State.Multisampling.alphaToCoverageEnable = VK_FALSE;
+        State.Multisampling.alphaToOneEnable = VK_FALSE;
+
+        State.ColorBlendAttachment = {};
+        State.ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                 VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-        ColorBlendAttachment.blendEnable = VK_FALSE;
-        ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-        ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-        ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-        ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-        ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-        ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-
-        VkPipelineColorBlendStateCreateInfo ColorBlending{};
-        ColorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-        ColorBlending.logicOpEnable = VK_FALSE;
-        ColorBlending.logicOp = VK_LOGIC_OP_COPY;
-        ColorBlending.attachmentCount = 1;
-        ColorBlending.pAttachments = &ColorBlendAttachment;
-        ColorBlending.blendConstants[0] = 0.f;
-        ColorBlending.blendConstants[1] = 0.f;
-        ColorBlending.blendConstants[2] = 0.f;
-        ColorBlending.blendConstants[3] = 0.f;
+        State.ColorBlendAttachment.blendEnable = VK_FALSE;
+        State.ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        State.ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+        State.ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+        State.ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        State.ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        State.ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+        State.ColorBlending = {};
+        State.ColorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        State.ColorBlending.logicOpEnable = VK_FALSE;
+        State.ColorBlending.logicOp = VK_LOGIC_OP_COPY;
+        State.ColorBlending.attachmentCount = 1;
+        State.ColorBlending.pAttachments = &State.ColorBlendAttachment;
+        State.ColorBlending.blendConstants[0] = 0.f;
+        State.ColorBlending.blendConstants[1] = 0.f;
+        State.ColorBlending.blendConstants[2] = 0.f;
+        State.ColorBlending.blendConstants[3] = 0.f;
+
+        State.DepthStencil = {};
+        State.DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        State.DepthStencil.depthTestEnable = VK_TRUE;
+        State.DepthStencil.depthWriteEnable = VK_TRUE;
+        State.DepthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        State.DepthStencil.depthBoundsTestEnable = VK_FALSE;
+        State.DepthStencil.minDepthBounds = 0.f;
+        State.DepthStencil.maxDepthBounds = 1.f;
+        State.DepthStencil.stencilTestEnable = VK_FALSE;
+        State.DepthStencil.front = {};
+        State.DepthStencil.back = {};
+    }
 
+    const std::string& GetFragmentShaderPath() const
+    {
+        return bVirtualTexturing ? VIRTUAL_TEXTURE_FRAGMENT_SHADER_PATH : FRAGMENT_SHADER_PATH;
+    }
 
+    void CreatePipelineLayout()
+    {
         VkPipelineLayoutCreateInfo PipelineLayoutInfo{};
         PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         PipelineLayoutInfo.setLayoutCount = 1;
         PipelineLayoutInfo.pSetLayouts = &DescriptorSetLayout;
-        PipelineLayoutInfo.pushConstantRangeCount = 0;
-        PipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+        VkPushConstantRange PushConstantRange{};
+        PushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        PushConstantRange.offset = 0;
+        PushConstantRange.size = sizeof(FDrawConstants);
+
+        PipelineLayoutInfo.pushConstantRangeCount = 1;
+        PipelineLayoutInfo.pPushConstantRanges = &PushConstantRange;
 
         if (vkCreatePipelineLayout(Device, &PipelineLayoutInfo, nullptr, &PipelineLayout) != VK_SUCCESS)
         {
             throw std::runtime_error("Failed to create pipeline layout!");
         }
+    }
+
+    void CreateGraphicsPipeline()
+    {
+        FGraphicsPipelineState State;
+        FillGraphicsPipelineState(State);
+
+        if (bGraphicsPipelineLibrarySupported)
+        {
+            CreatePipelineLibraries(State);
+            GraphicsPipeline = LinkPipelineLibraries(Device, PipelineLibraries, PipelineLayout, false);
 
-        VkPipelineDepthStencilStateCreateInfo DepthStencil{};
-        DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        DepthStencil.depthTestEnable = VK_TRUE;
-        DepthStencil.depthWriteEnable = VK_TRUE;
-        DepthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-        DepthStencil.depthBoundsTestEnable = VK_FALSE;
-        DepthStencil.minDepthBounds = 0.f;
-        DepthStencil.maxDepthBounds = 1.f;
-        DepthStencil.stencilTestEnable = VK_FALSE;
-        DepthStencil.front = {};
-        DepthStencil.back = {};
+            if (GraphicsPipeline == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("Failed to link graphics pipeline libraries!");
+            }
+
+            StartOptimizedPipelineLink();
+            return;
+        }
 
         VkGraphicsPipelineCreateInfo PipelineInfo{};
         PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         PipelineInfo.stageCount = 2;
-        PipelineInfo.pStages = ShaderStages;
-        PipelineInfo.pVertexInputState = &VertexInputInfo;
-        PipelineInfo.pInputAssemblyState = &InputAssembly;
-        PipelineInfo.pViewportState = &ViewportState;
-        PipelineInfo.pRasterizationState = &Rasterizer;
-        PipelineInfo.pMultisampleState = &Multisampling;
-        PipelineInfo.pDepthStencilState = nullptr;
-        PipelineInfo.pColorBlendState = &ColorBlending;
-        PipelineInfo.pDepthStencilState = &DepthStencil;
+        PipelineInfo.pStages = State.ShaderStages;
+        PipelineInfo.pVertexInputState = &State.VertexInputInfo;
+        PipelineInfo.pInputAssemblyState = &State.InputAssembly;
+        PipelineInfo.pViewportState = &State.ViewportState;
+        PipelineInfo.pRasterizationState = &State.Rasterizer;
+        PipelineInfo.pMultisampleState = &State.Multisampling;
+        PipelineInfo.pColorBlendState = &State.ColorBlending;
+        PipelineInfo.pDepthStencilState = &State.DepthStencil;
         PipelineInfo.layout = PipelineLayout;
         PipelineInfo.renderPass = RenderPass;
         PipelineInfo.subpass = 0;
@@ -860,9 +1212,158 @@ private:
         {
             throw std::runtime_error("Failed to create graphics pipeline!");
         }
+    }
+
+    VkPipeline CreatePipelineLibrary(VkGraphicsPipelineLibraryFlagsEXT Flags, VkGraphicsPipelineCreateInfo& PipelineInfo)
+    {
+        VkGraphicsPipelineLibraryCreateInfoEXT LibraryInfo{};
+        LibraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+        LibraryInfo.flags = Flags;
+
+        PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        PipelineInfo.pNext = &LibraryInfo;
+        PipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+        PipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+        PipelineInfo.basePipelineIndex = -1;
+
+        VkPipeline Library;
+        if (vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &PipelineInfo, nullptr, &Library) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create graphics pipeline library!");
+        }
+
+        return Library;
+    }
+
+    void CreatePipelineLibraries(FGraphicsPipelineState& State)
+    {
+        if (PipelineLibraries[0] == VK_NULL_HANDLE)
+        {
+            VkGraphicsPipelineCreateInfo VertexInputInfo{};
+            VertexInputInfo.pVertexInputState = &State.VertexInputInfo;
+            VertexInputInfo.pInputAssemblyState = &State.InputAssembly;
+            PipelineLibraries[0] = CreatePipelineLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, VertexInputInfo);
+        }
+
+        VkGraphicsPipelineCreateInfo PreRasterizationInfo{};
+        PreRasterizationInfo.stageCount = 1;
+        PreRasterizationInfo.pStages = &State.ShaderStages[0];
+        PreRasterizationInfo.pViewportState = &State.ViewportState;
+        PreRasterizationInfo.pRasterizationState = &State.Rasterizer;
+        PreRasterizationInfo.layout = PipelineLayout;
+        PreRasterizationInfo.renderPass = RenderPass;
+        PreRasterizationInfo.subpass = 0;
+        PipelineLibraries[1] = CreatePipelineLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, PreRasterizationInfo);
+
+        VkGraphicsPipelineCreateInfo FragmentShaderInfo{};
+        FragmentShaderInfo.stageCount = 1;
+        FragmentShaderInfo.pStages = &State.ShaderStages[1];
+        FragmentShaderInfo.pMultisampleState = &State.Multisampling;
+        FragmentShaderInfo.pDepthStencilState = &State.DepthStencil;
+        FragmentShaderInfo.layout = PipelineLayout;
+        FragmentShaderInfo.renderPass = RenderPass;
+        FragmentShaderInfo.subpass = 0;
+        PipelineLibraries[2] = CreatePipelineLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, FragmentShaderInfo);
+
+        VkGraphicsPipelineCreateInfo FragmentOutputInfo{};
+        FragmentOutputInfo.pColorBlendState = &State.ColorBlending;
+        FragmentOutputInfo.pMultisampleState = &State.Multisampling;
+        FragmentOutputInfo.renderPass = RenderPass;
+        FragmentOutputInfo.subpass = 0;
+        PipelineLibraries[3] = CreatePipelineLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, FragmentOutputInfo);
+    }
+
+    static VkPipeline LinkPipelineLibraries(VkDevice Device, const std::array<VkPipeline, 4>& Libraries, VkPipelineLayout Layout, bool bOptimize)
+    {
+        VkPipelineLibraryCreateInfoKHR LinkingInfo{};
+        LinkingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+        LinkingInfo.libraryCount = static_cast<uint>(Libraries.size());
+        LinkingInfo.pLibraries = Libraries.data();
+
+        VkGraphicsPipelineCreateInfo PipelineInfo{};
+        PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        PipelineInfo.pNext = &LinkingInfo;
+        PipelineInfo.flags = bOptimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+        PipelineInfo.layout = Layout;
+        PipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+        PipelineInfo.basePipelineIndex = -1;
+
+        VkPipeline Pipeline = VK_NULL_HANDLE;
+        if (vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &PipelineInfo, nullptr, &Pipeline) != VK_SUCCESS)
+        {
+            return VK_NULL_HANDLE;
+        }
+
+        return Pipeline;
+    }
+
+    void StartOptimizedPipelineLink()
+    {
+        OptimizedPipelineFuture = std::async(std::launch::async, LinkPipelineLibraries, Device, PipelineLibraries, PipelineLayout, true);
+    }
+
+    void SwapInOptimizedPipeline()
+    {
+        if (!OptimizedPipelineFuture.valid() || OptimizedPipelineFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return;
+        }
+
+        VkPipeline OptimizedPipeline = OptimizedPipelineFuture.get();
+
+        if (OptimizedPipeline == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        // Frames still in flight keep executing the fast linked pipeline, it is released with their command buffers
+        DeferDestroy([this, Pipeline = GraphicsPipeline, OldCommandBuffers = CommandBuffers]()
+        {
+            vkFreeCommandBuffers(Device, CommandPool, static_cast<uint32_t>(OldCommandBuffers.size()), OldCommandBuffers.data());
+            vkDestroyPipeline(Device, Pipeline, nullptr);
+        });
+
+        GraphicsPipeline = OptimizedPipeline;
+        CreateCommandBuffers();
+    }
+
+    // Objects retired while frames are in flight are queued on the current frame slot. Its fence is waited on again
+    // only after the fences of every earlier frame, so by then no submission can still use them.
+    void DeferDestroy(std::function<void()> Destroy)
+    {
+        DeferredDestroys[CurrentFrame].push_back(std::move(Destroy));
+    }
+
+    void RunDeferredDestroys(std::size_t Frame)
+    {
+        for (auto& Destroy : DeferredDestroys[Frame])
+        {
+            Destroy();
+        }
 
-        vkDestroyShaderModule(Device, FragmentShaderModule, nullptr);
-        vkDestroyShaderModule(Device, VertexShaderModule, nullptr);
+        DeferredDestroys[Frame].clear();
+    }
+
+    void CleanUpPipelineLibraries()
+    {
+        if (OptimizedPipelineFuture.valid())
+        {
+            VkPipeline OptimizedPipeline = OptimizedPipelineFuture.get();
+
+            if (OptimizedPipeline != VK_NULL_HANDLE)
+            {
+                vkDestroyPipeline(Device, OptimizedPipeline, nullptr);
+            }
+        }
+
+        for (std::size_t i = 1; i < PipelineLibraries.size(); ++i)
+        {
+            if (PipelineLibraries[i] != VK_NULL_HANDLE)
+            {
+                vkDestroyPipeline(Device, PipelineLibraries[i], nullptr);
+                PipelineLibraries[i] = VK_NULL_HANDLE;
+            }
+        }
     }
 
     void CreateRenderPass()
@@ -1017,20 +1518,45 @@ private:
             RenderPassInfo.pClearValues = ClearValues.data();
 
             vkCmdBeginRenderPass(CommandBuffers[i], &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-            vkCmdBindPipeline(CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, GraphicsPipeline);
-            VkBuffer VertexBuffers[] = {VertexBuffer};
-            VkDeviceSize Offsets[] = {0};
-            vkCmdBindVertexBuffers(CommandBuffers[i], 0, 1, VertexBuffers, Offsets);
-            vkCmdBindIndexBuffer(CommandBuffers[i], IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-            vkCmdBindDescriptorSets(CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, PipelineLayout, 0, 1, &DescriptorSets[i], 0,
-                                    nullptr);
-            vkCmdDrawIndexed(CommandBuffers[i], static_cast<uint>(Indices.size()), 1, 0, 0, 0);
-            vkCmdEndRenderPass(CommandBuffers[i]);
 
-            if (vkEndCommandBuffer(CommandBuffers[i]) != VK_SUCCESS)
+            // The resident index range grows while the model streams in, so the draw reads its arguments from a buffer updated every frame
+            if (bModelBuffersCreated)
             {
-                throw std::runtime_error("Failed to record command buffer!");
+                vkCmdBindPipeline(CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, GraphicsPipeline);
+                VkBuffer VertexBuffers[] = {VertexBuffer, VertexBuffer};
+                VkDeviceSize Offsets[] = {0, ConstantColorOffset};
+                vkCmdBindVertexBuffers(CommandBuffers[i], 0, MODEL_VERTEX_FORMAT.ColorFormat == EVertexColorFormat::Constant ? 2 : 1, VertexBuffers, Offsets);
+                vkCmdBindIndexBuffer(CommandBuffers[i], IndexBuffer, 0, ModelIndexType);
+
+                // Every texture is in the one bound set, materials only push the index of theirs
+                vkCmdBindDescriptorSets(CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, PipelineLayout, 0, 1, &DescriptorSets[i], 0, nullptr);
+
+                for (uint32_t Material = 0; Material < MaterialTextures.size(); ++Material)
+                {
+                    const FTexture& Texture = Textures[MaterialTextures[Material]];
+                    FDrawConstants DrawConstants{MaterialTextures[Material], static_cast<uint32_t>(Texture.FeedbackOffset / sizeof(uint32_t))};
+                    vkCmdPushConstants(CommandBuffers[i], PipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(DrawConstants), &DrawConstants);
+
+                    vkCmdDrawIndexedIndirect(CommandBuffers[i], DrawIndirectBuffers[i], Material * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+                }
+            }
+
+            vkCmdEndRenderPass(CommandBuffers[i]);
+
+            // The page requests the fragment shader wrote are read on the host once the frame's fence signals
+            if (bVirtualTexturing)
+            {
+                VkMemoryBarrier FeedbackBarrier{};
+                FeedbackBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                FeedbackBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                FeedbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+                vkCmdPipelineBarrier(CommandBuffers[i], VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &FeedbackBarrier, 0, nullptr, 0, nullptr);
+            }
+
+            if (vkEndCommandBuffer(CommandBuffers[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Failed to record command buffer!");
             }
         }
     }
@@ -1040,7 +1566,7 @@ private:
         ImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
         RenderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
         InFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-        ImagesInFlight.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+        ImagesInFlight.assign(SwapChainImages.size(), VK_NULL_HANDLE);
 
         VkSemaphoreCreateInfo SemaphoreInfo{};
         SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -1058,6 +1584,13 @@ private:
                 throw std::runtime_error("Failed to create synchronization objects for a frame!");
             }
         }
+
+        FenceInfo.flags = 0;
+
+        if (vkCreateFence(Device, &FenceInfo, nullptr, &TextureUploadFence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create texture upload fence!");
+        }
     }
 
     uint FindMemoryType(uint TypeFilter, VkMemoryPropertyFlags Properties)
@@ -1087,26 +1620,39 @@ private:
         EndSingleTimeCommand(CommandBuffer);
     }
 
-    void CopyBufferToImage(VkBuffer Buffer, VkImage Image, uint32_t Width, uint32_t Height)
+    // Runs on the calling thread, the image can be sampled by anything submitted after it returns
+    void CopyMemoryToImage(VkImage Image, VkImageLayout Layout, const std::vector<VkMemoryToImageCopyEXT>& Regions)
     {
-        VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
-
-        VkBufferImageCopy Region{};
-        Region.bufferOffset = 0;
-        Region.bufferRowLength = 0;
-        Region.bufferImageHeight = 0;
-
-        Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        Region.imageSubresource.mipLevel = 0;
-        Region.imageSubresource.baseArrayLayer = 0;
-        Region.imageSubresource.layerCount = 1;
-
-        Region.imageOffset = {0, 0, 0};
-        Region.imageExtent = {Width, Height, 1};
-
-        vkCmdCopyBufferToImage(CommandBuffer, Buffer, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+        VkCopyMemoryToImageInfoEXT CopyInfo{};
+        CopyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT;
+        CopyInfo.dstImage = Image;
+        CopyInfo.dstImageLayout = Layout;
+        CopyInfo.regionCount = static_cast<uint32_t>(Regions.size());
+        CopyInfo.pRegions = Regions.data();
+
+        if (CopyMemoryToImageEXT(Device, &CopyInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to copy memory to image!");
+        }
+    }
 
-        EndSingleTimeCommand(CommandBuffer);
+    void TransitionImageLayoutOnHost(VkImage Image, VkImageLayout OldLayout, VkImageLayout NewLayout, uint32_t MipLevels)
+    {
+        VkHostImageLayoutTransitionInfoEXT Transition{};
+        Transition.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT;
+        Transition.image = Image;
+        Transition.oldLayout = OldLayout;
+        Transition.newLayout = NewLayout;
+        Transition.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        Transition.subresourceRange.baseMipLevel = 0;
+        Transition.subresourceRange.levelCount = MipLevels;
+        Transition.subresourceRange.baseArrayLayer = 0;
+        Transition.subresourceRange.layerCount = 1;
+
+        if (TransitionImageLayoutEXT(Device, 1, &Transition) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to transition image layout on the host!");
+        }
     }
 
     void TransitionImageLayout(VkImage Image, VkFormat Format, VkImageLayout OldLayout, VkImageLayout NewLayout, uint32_t MipLevels)
@@ -1178,23 +1724,16 @@ private:
 
     void CreateVertexBuffer()
     {
-        VkDeviceSize BufferSize = sizeof(Vertices[0]) * Vertices.size();
+        uint32_t VertexStride = GetVertexLayout(MODEL_VERTEX_FORMAT).Stride;
+        VkDeviceSize VertexDataSize = static_cast<VkDeviceSize>(ModelVertexCount) * VertexStride;
 
-        VkBuffer StagingBuffer;
-        VkDeviceMemory StagingBufferMemory;
-        CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
-
-        void* Data;
-        vkMapMemory(Device, StagingBufferMemory, 0, BufferSize, 0, &Data);
-        memcpy(Data, Vertices.data(), (std::size_t)BufferSize);
-        vkUnmapMemory(Device, StagingBufferMemory);
+        ConstantColorOffset = (VertexDataSize + 3) & ~VkDeviceSize(3);
+        VkDeviceSize BufferSize = ConstantColorOffset + sizeof(MODEL_CONSTANT_COLOR);
 
         CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VertexBuffer, VertexBufferMemory);
 
-        CopyBuffer(StagingBuffer, VertexBuffer, BufferSize);
-
-        vkDestroyBuffer(Device, StagingBuffer, nullptr);
-        vkFreeMemory(Device, StagingBufferMemory, nullptr);
+        GetModelStream(EModelStream::Vertices) = {VertexBuffer, 0, static_cast<const char*>(ModelCache.GetVertexData()), VertexDataSize, 0, 0, ModelCache.GetVertexDataSize(), VertexStride};
+        GetModelStream(EModelStream::ConstantColor) = {VertexBuffer, ConstantColorOffset, reinterpret_cast<const char*>(MODEL_CONSTANT_COLOR), sizeof(MODEL_CONSTANT_COLOR), 0, 0, 0, 0};
     }
 
     void CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties, VkBuffer& Buffer, VkDeviceMemory& BufferMemory)
@@ -1207,183 +1746,1762 @@ private:
 
         if (vkCreateBuffer(Device, &BufferInfo, nullptr, &Buffer) != VK_SUCCESS)
         {
-            throw std::runtime_error("Failed to create buffer!");
+            throw std::runtime_error("Failed to create buffer!");
+        }
+
+        VkMemoryRequirements MemRequirements;
+        vkGetBufferMemoryRequirements(Device, Buffer, &MemRequirements);
+
+        VkMemoryAllocateInfo  AllocInfo{};
+        AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        AllocInfo.allocationSize = MemRequirements.size;
+        AllocInfo.memoryTypeIndex = FindMemoryType(MemRequirements.memoryTypeBits, Properties);
+
+        if (vkAllocateMemory(Device, &AllocInfo, nullptr, &BufferMemory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to allocate buffer memory!");
+        }
+
+        vkBindBufferMemory(Device, Buffer, BufferMemory, 0);
+    }
+
+    void CreateIndexBuffer()
+    {
+        const void* IndexData = GetModelIndexData();
+        VkDeviceSize BufferSize = static_cast<VkDeviceSize>(ModelIndexCount) * GetIndexSize(ModelIndexType);
+
+        CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, IndexBuffer, IndexBufferMemory);
+
+        GetModelStream(EModelStream::Indices) = {IndexBuffer, 0, static_cast<const char*>(IndexData), BufferSize, 0, 0, 0, 0};
+    }
+
+    void CreateMeshletBuffers()
+    {
+        VkDeviceSize MeshletDataSize = ModelCache.GetMeshletDataSize();
+        VkDeviceSize MeshletVertexDataSize = ModelCache.GetMeshletVertexDataSize();
+        VkDeviceSize MeshletTriangleDataSize = ModelCache.GetMeshletTriangleDataSize();
+
+        if (MeshletDataSize == 0)
+        {
+            throw std::runtime_error("Failed to create meshlet buffers, model has no meshlets!");
+        }
+
+        CreateBuffer(MeshletDataSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MeshletBuffer, MeshletBufferMemory);
+        CreateBuffer(MeshletVertexDataSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MeshletVertexBuffer, MeshletVertexBufferMemory);
+        CreateBuffer(MeshletTriangleDataSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MeshletTriangleBuffer, MeshletTriangleBufferMemory);
+
+        GetModelStream(EModelStream::Meshlets) = {MeshletBuffer, 0, static_cast<const char*>(ModelCache.GetMeshletData()), MeshletDataSize, 0, 0, 0, 0};
+        GetModelStream(EModelStream::MeshletVertices) = {MeshletVertexBuffer, 0, static_cast<const char*>(ModelCache.GetMeshletVertexData()), MeshletVertexDataSize, 0, 0, 0, 0};
+        GetModelStream(EModelStream::MeshletTriangles) = {MeshletTriangleBuffer, 0, static_cast<const char*>(ModelCache.GetMeshletTriangleData()), MeshletTriangleDataSize, 0, 0, 0, 0};
+    }
+
+    FModelStream& GetModelStream(EModelStream Stream)
+    {
+        return ModelStreams[static_cast<std::size_t>(Stream)];
+    }
+
+    void StartModelStreaming()
+    {
+        ModelStreamStartTime = std::chrono::steady_clock::now();
+
+        CreateBuffer(MODEL_STREAM_CHUNK_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, ModelStagingBuffer, ModelStagingBufferMemory);
+
+        void* Data;
+        vkMapMemory(Device, ModelStagingBufferMemory, 0, MODEL_STREAM_CHUNK_SIZE, 0, &Data);
+        ModelStagingData = static_cast<char*>(Data);
+
+        VkFenceCreateInfo FenceInfo{};
+        FenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkCreateFence(Device, &FenceInfo, nullptr, &ModelUploadFence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create model upload fence!");
+        }
+    }
+
+    void UpdateModelStreaming()
+    {
+        if (bModelResident)
+        {
+            return;
+        }
+
+        if (!bModelBuffersCreated)
+        {
+            if (!IsFutureReady(ModelLoadFuture))
+            {
+                return;
+            }
+
+            // The model load submits its material textures, uploading waits for all of them rather than stalling a frame on one
+            for (const auto& Future : MaterialTextureFutures)
+            {
+                if (!IsFutureReady(Future))
+                {
+                    return;
+                }
+            }
+
+            ModelLoadFuture.get();
+            ModelDequantization = MODEL_VERTEX_FORMAT.bQuantizedPositions ? GetPositionDequantization(ModelBounds) : FMatrix4();
+            ModelTexCoordDequantization = MODEL_VERTEX_FORMAT.TexCoordFormat == ETexCoordFormat::Unorm16 ? GetTexCoordDequantization(ModelBounds) : FVector4(1.f, 1.f, 0.f, 0.f);
+
+            CreateVertexBuffer();
+            CreateIndexBuffer();
+            CreateMeshletBuffers();
+
+            // The material textures upload together with the first chunk, frames keep drawing while it completes
+            VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
+            std::size_t FirstMaterialTexture = Textures.size();
+            CreateMaterialTextures(CommandBuffer);
+            bModelBuffersCreated = true;
+
+            // The draw commands and feedback buffers are sized by the material and texture count of the model. Frames in
+            // flight keep the ones they were recorded with, each set picks up the new feedback buffer and table entries.
+            DeferDestroy([this, OldCommandBuffers = CommandBuffers, OldDrawIndirectBuffers = DrawIndirectBuffers, OldDrawIndirectBuffersMemory = DrawIndirectBuffersMemory,
+                          OldFeedbackBuffers = VirtualTextureFeedbackBuffers, OldFeedbackBuffersMemory = VirtualTextureFeedbackBuffersMemory]()
+            {
+                vkFreeCommandBuffers(Device, CommandPool, static_cast<uint32_t>(OldCommandBuffers.size()), OldCommandBuffers.data());
+
+                for (std::size_t i = 0; i < OldDrawIndirectBuffers.size(); ++i)
+                {
+                    vkDestroyBuffer(Device, OldDrawIndirectBuffers[i], nullptr);
+                    vkFreeMemory(Device, OldDrawIndirectBuffersMemory[i], nullptr);
+                }
+
+                for (std::size_t i = 0; i < OldFeedbackBuffers.size(); ++i)
+                {
+                    vkUnmapMemory(Device, OldFeedbackBuffersMemory[i]);
+                    vkDestroyBuffer(Device, OldFeedbackBuffers[i], nullptr);
+                    vkFreeMemory(Device, OldFeedbackBuffersMemory[i], nullptr);
+                }
+            });
+
+            CreateDrawIndirectBuffers();
+            CreateVirtualTextureFeedbackBuffers();
+
+            for (std::size_t t = FirstMaterialTexture; t < Textures.size(); ++t)
+            {
+                QueueTextureDescriptorWrite(t);
+            }
+
+            QueueVirtualTextureDescriptorWrites();
+            CreateCommandBuffers();
+            SubmitModelChunk(CommandBuffer);
+            return;
+        }
+
+        if (ModelUploadCommandBuffer != VK_NULL_HANDLE)
+        {
+            if (vkGetFenceStatus(Device, ModelUploadFence) != VK_SUCCESS)
+            {
+                return;
+            }
+
+            vkResetFences(Device, 1, &ModelUploadFence);
+            vkFreeCommandBuffers(Device, CommandPool, 1, &ModelUploadCommandBuffer);
+            ModelUploadCommandBuffer = VK_NULL_HANDLE;
+            ReleasePendingStagingBuffers();
+
+            bool bComplete = true;
+
+            for (auto& Stream : ModelStreams)
+            {
+                Stream.Uploaded += Stream.Pending;
+                Stream.Pending = 0;
+                bComplete = bComplete && Stream.Uploaded == Stream.Size;
+            }
+
+            ResidentIndexCount = static_cast<uint32_t>(GetModelStream(EModelStream::Indices).Uploaded / GetIndexSize(ModelIndexType));
+
+            if (bComplete)
+            {
+                FinishModelStreaming();
+                return;
+            }
+        }
+
+        SubmitModelChunk(BeginSingleTimeCommands());
+    }
+
+    void SubmitModelChunk(VkCommandBuffer CommandBuffer)
+    {
+        VkDeviceSize StagingOffset = 0;
+
+        auto StageCopy = [&](EModelStream StreamType, VkDeviceSize Size)
+        {
+            FModelStream& Stream = GetModelStream(StreamType);
+
+            if (Size == 0)
+            {
+                return;
+            }
+
+            if (Stream.EncodedSize != 0)
+            {
+                if (!DecodeVertexBuffer(ModelStagingData + StagingOffset, Stream.Source, Stream.EncodedSize, Stream.Size / Stream.Stride, Stream.Stride,
+                                        Stream.Uploaded / Stream.Stride, (Stream.Uploaded + Size) / Stream.Stride))
+                {
+                    throw std::runtime_error("Failed to decode model stream!");
+                }
+            }
+            else
+            {
+                memcpy(ModelStagingData + StagingOffset, Stream.Source + Stream.Uploaded, (std::size_t)Size);
+            }
+
+            VkBufferCopy CopyRegion{};
+            CopyRegion.srcOffset = StagingOffset;
+            CopyRegion.dstOffset = Stream.BufferOffset + Stream.Uploaded;
+            CopyRegion.size = Size;
+            vkCmdCopyBuffer(CommandBuffer, ModelStagingBuffer, Stream.Buffer, 1, &CopyRegion);
+
+            Stream.Pending = Size;
+            StagingOffset += Size;
+        };
+
+        StageCopy(EModelStream::ConstantColor, GetModelStream(EModelStream::ConstantColor).Size - GetModelStream(EModelStream::ConstantColor).Uploaded);
+
+        // An index only becomes resident together with or after every vertex it references, vertex fetch
+        // optimization ordered the vertices by first use so each chunk only needs a short run of new vertices
+        const FModelStream& VertexStream = GetModelStream(EModelStream::Vertices);
+        const FModelStream& IndexStream = GetModelStream(EModelStream::Indices);
+        VkDeviceSize VertexStride = GetVertexLayout(MODEL_VERTEX_FORMAT).Stride;
+        VkDeviceSize IndexSize = GetIndexSize(ModelIndexType);
+        VkDeviceSize FirstVertex = VertexStream.Uploaded / VertexStride;
+        VkDeviceSize FirstIndex = IndexStream.Uploaded / IndexSize;
+        VkDeviceSize VertexEnd = FirstVertex;
+        VkDeviceSize IndexEnd = FirstIndex;
+
+        // Encoded vertices decode in whole blocks, so every chunk ends on a block boundary or at the last vertex
+        auto AlignVertexEnd = [&](VkDeviceSize End)
+        {
+            return std::min<VkDeviceSize>(ModelVertexCount, (End + MESH_CODEC_BLOCK_SIZE - 1) / MESH_CODEC_BLOCK_SIZE * MESH_CODEC_BLOCK_SIZE);
+        };
+
+        auto ReadIndex = [&](VkDeviceSize Index) -> VkDeviceSize
+        {
+            if (IndexSize == sizeof(uint16_t))
+            {
+                uint16_t Value;
+                memcpy(&Value, IndexStream.Source + Index * sizeof(uint16_t), sizeof(Value));
+                return Value;
+            }
+
+            uint32_t Value;
+            memcpy(&Value, IndexStream.Source + Index * sizeof(uint32_t), sizeof(Value));
+            return Value;
+        };
+
+        while (IndexEnd < ModelIndexCount)
+        {
+            VkDeviceSize TriangleVertexEnd = VertexEnd;
+
+            for (VkDeviceSize k = 0; k < 3; ++k)
+            {
+                TriangleVertexEnd = std::max(TriangleVertexEnd, AlignVertexEnd(ReadIndex(IndexEnd + k) + 1));
+            }
+
+            if (StagingOffset + (TriangleVertexEnd - FirstVertex) * VertexStride + (IndexEnd + 3 - FirstIndex) * IndexSize > MODEL_STREAM_CHUNK_SIZE)
+            {
+                break;
+            }
+
+            VertexEnd = TriangleVertexEnd;
+            IndexEnd += 3;
+        }
+
+        if (IndexEnd == ModelIndexCount)
+        {
+            VkDeviceSize Budget = MODEL_STREAM_CHUNK_SIZE - StagingOffset - (IndexEnd - FirstIndex) * IndexSize;
+            VertexEnd = std::max(VertexEnd, std::min<VkDeviceSize>(ModelVertexCount, FirstVertex + Budget / VertexStride / MESH_CODEC_BLOCK_SIZE * MESH_CODEC_BLOCK_SIZE));
+        }
+
+        StageCopy(EModelStream::Vertices, (VertexEnd - FirstVertex) * VertexStride);
+        StageCopy(EModelStream::Indices, (IndexEnd - FirstIndex) * IndexSize);
+
+        if (IndexEnd == ModelIndexCount && VertexEnd == ModelVertexCount)
+        {
+            for (EModelStream StreamType : {EModelStream::Meshlets, EModelStream::MeshletVertices, EModelStream::MeshletTriangles})
+            {
+                const FModelStream& Stream = GetModelStream(StreamType);
+                StageCopy(StreamType, std::min(Stream.Size - Stream.Uploaded, MODEL_STREAM_CHUNK_SIZE - StagingOffset));
+            }
+        }
+
+        if (StagingOffset == 0)
+        {
+            throw std::runtime_error("Failed to stream model, chunk size is too small!");
+        }
+
+        VkMemoryBarrier Barrier{};
+        Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &Barrier, 0, nullptr, 0, nullptr);
+        vkEndCommandBuffer(CommandBuffer);
+
+        VkSubmitInfo SubmitInfo{};
+        SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        SubmitInfo.commandBufferCount = 1;
+        SubmitInfo.pCommandBuffers = &CommandBuffer;
+
+        if (vkQueueSubmit(GraphicsQueue, 1, &SubmitInfo, ModelUploadFence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to submit model upload!");
+        }
+
+        ModelUploadCommandBuffer = CommandBuffer;
+    }
+
+    void FinishModelStreaming()
+    {
+        bModelResident = true;
+
+        DestroyModelStreamingResources();
+        ModelCache.Close();
+        Indices = {};
+        CompactIndices = {};
+
+        auto StreamTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ModelStreamStartTime).count();
+        std::cout << "Model resident after " << StreamTime << " ms" << std::endl;
+    }
+
+    void DestroyModelStreamingResources()
+    {
+        if (ModelStagingBuffer != VK_NULL_HANDLE)
+        {
+            vkUnmapMemory(Device, ModelStagingBufferMemory);
+            vkDestroyBuffer(Device, ModelStagingBuffer, nullptr);
+            vkFreeMemory(Device, ModelStagingBufferMemory, nullptr);
+            ModelStagingBuffer = VK_NULL_HANDLE;
+            ModelStagingData = nullptr;
+        }
+
+        ReleasePendingStagingBuffers();
+        vkDestroyFence(Device, ModelUploadFence, nullptr);
+        ModelUploadFence = VK_NULL_HANDLE;
+    }
+
+    // One upload is in flight at a time. The smallest missing level of any texture goes first, so every texture gets
+    // its coarse levels before any gets its fine ones, and over budget the largest allocated level goes first.
+    void UpdateTextureStreaming()
+    {
+        if (TextureUploadCommandBuffer != VK_NULL_HANDLE)
+        {
+            if (vkGetFenceStatus(Device, TextureUploadFence) != VK_SUCCESS)
+            {
+                return;
+            }
+
+            vkResetFences(Device, 1, &TextureUploadFence);
+            vkFreeCommandBuffers(Device, CommandPool, 1, &TextureUploadCommandBuffer);
+            TextureUploadCommandBuffer = VK_NULL_HANDLE;
+
+            FinishTextureUpload();
+        }
+
+        uint64_t MemoryUsage = GetTextureMemoryUsage();
+        std::size_t Selected = Textures.size();
+
+        if (MemoryUsage > TEXTURE_STREAMING_BUDGET)
+        {
+            for (std::size_t t = 0; t < Textures.size(); ++t)
+            {
+                const FTextureResidency& Residency = Textures[t].Residency;
+
+                if (CanEvictTextureLevel(Residency) &&
+                    (Selected == Textures.size() || Residency.LevelSizes[Residency.AllocatedLevel] > Textures[Selected].Residency.LevelSizes[Textures[Selected].Residency.AllocatedLevel]))
+                {
+                    Selected = t;
+                }
+            }
+
+            if (Selected != Textures.size())
+            {
+                SubmitTextureReallocation(Selected, Textures[Selected].Residency.AllocatedLevel + 1);
+            }
+
+            return;
+        }
+
+        for (std::size_t t = 0; t < Textures.size(); ++t)
+        {
+            const FTextureResidency& Residency = Textures[t].Residency;
+
+            if (CanStreamTextureLevel(Residency, MemoryUsage) &&
+                (Selected == Textures.size() || Residency.LevelSizes[Residency.ResidentLevel - 1] < Textures[Selected].Residency.LevelSizes[Textures[Selected].Residency.ResidentLevel - 1]))
+            {
+                Selected = t;
+            }
+        }
+
+        if (Selected == Textures.size())
+        {
+            return;
+        }
+
+        const FTextureResidency& Residency = Textures[Selected].Residency;
+
+        if (Residency.ResidentLevel > Residency.AllocatedLevel)
+        {
+            SubmitTextureLevel(Selected);
+        }
+        else
+        {
+            SubmitTextureReallocation(Selected, Residency.AllocatedLevel - 1);
+        }
+    }
+
+    void SubmitTextureLevel(std::size_t TextureIndex)
+    {
+        FTexture& Texture = Textures[TextureIndex];
+        uint32_t Level = Texture.Residency.ResidentLevel - 1;
+        uint32_t ImageLevel = Level - Texture.Residency.AllocatedLevel;
+        const FTextureCacheLevel& LevelInfo = Texture.Source->GetHeader().Levels[Level];
+
+        uint64_t Staged = Texture.Source->ReadLevels(Level, 1, ReserveTextureStaging(LevelInfo.UncompressedSize));
+
+        if (Staged == 0)
+        {
+            throw std::runtime_error("Failed to stream texture level, cooked mip level is corrupt!");
+        }
+
+        Texture.StagedBytes += Staged;
+
+        VkBufferImageCopy Region{};
+        Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        Region.imageSubresource.mipLevel = ImageLevel;
+        Region.imageSubresource.baseArrayLayer = 0;
+        Region.imageSubresource.layerCount = 1;
+        Region.imageExtent = {LevelInfo.Width, LevelInfo.Height, 1};
+
+        VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
+
+        // Nothing samples the level before the upload completes, so its old contents are discarded
+        RecordTextureBarrier(CommandBuffer, Texture.Image, ImageLevel, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        vkCmdCopyBufferToImage(CommandBuffer, TextureStagingBuffer, Texture.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+        RecordTextureBarrier(CommandBuffer, Texture.Image, ImageLevel, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        SubmitTextureUpload(CommandBuffer, {TextureIndex, Texture.Residency.AllocatedLevel, Level, VK_NULL_HANDLE, VK_NULL_HANDLE});
+    }
+
+    // Images cannot free single levels, so evicting or regrowing a level moves the texture to a new image. The
+    // levels both images hold are copied on the device, the old image stays readable for frames still in flight.
+    void SubmitTextureReallocation(std::size_t TextureIndex, uint32_t AllocatedLevel)
+    {
+        const FTexture& Texture = Textures[TextureIndex];
+        const FTextureResidency& Residency = Texture.Residency;
+        FTextureUpload Upload{TextureIndex, AllocatedLevel, std::max(Residency.ResidentLevel, AllocatedLevel), VK_NULL_HANDLE, VK_NULL_HANDLE};
+
+        CreateStreamedImage(Texture, AllocatedLevel, Upload.Image, Upload.Memory);
+
+        uint32_t ImageLevels = Residency.LevelCount - AllocatedLevel;
+        uint32_t CopyLevels = Residency.LevelCount - Upload.ResidentLevel;
+        uint32_t SourceLevel = Upload.ResidentLevel - Residency.AllocatedLevel;
+        std::vector<VkImageCopy> Regions(CopyLevels);
+
+        for (uint32_t i = 0; i < CopyLevels; ++i)
+        {
+            const FTextureCacheLevel& Level = Texture.Source->GetHeader().Levels[Upload.ResidentLevel + i];
+
+            Regions[i].srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, SourceLevel + i, 0, 1};
+            Regions[i].dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, Upload.ResidentLevel - AllocatedLevel + i, 0, 1};
+            Regions[i].extent = {Level.Width, Level.Height, 1};
+        }
+
+        VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
+
+        RecordTextureBarrier(CommandBuffer, Upload.Image, 0, ImageLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        RecordTextureBarrier(CommandBuffer, Texture.Image, SourceLevel, CopyLevels, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        vkCmdCopyImage(CommandBuffer, Texture.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Upload.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, CopyLevels, Regions.data());
+        RecordTextureBarrier(CommandBuffer, Texture.Image, SourceLevel, CopyLevels, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        RecordTextureBarrier(CommandBuffer, Upload.Image, 0, ImageLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        SubmitTextureUpload(CommandBuffer, Upload);
+    }
+
+    void SubmitTextureUpload(VkCommandBuffer CommandBuffer, const FTextureUpload& Upload)
+    {
+        vkEndCommandBuffer(CommandBuffer);
+
+        VkSubmitInfo SubmitInfo{};
+        SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        SubmitInfo.commandBufferCount = 1;
+        SubmitInfo.pCommandBuffers = &CommandBuffer;
+
+        if (vkQueueSubmit(GraphicsQueue, 1, &SubmitInfo, TextureUploadFence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to submit texture upload!");
+        }
+
+        TextureUploadCommandBuffer = CommandBuffer;
+        PendingTextureUpload = Upload;
+    }
+
+    // The sampler clamping a texture changes with its residency. Its table entries are queued and each set is rewritten
+    // once the frame that last used it has completed, a replaced image lives until no set refers to it any more.
+    void FinishTextureUpload()
+    {
+        FTextureUpload Upload = PendingTextureUpload;
+        FTexture& Texture = Textures[Upload.Texture];
+
+        if (Upload.Image != VK_NULL_HANDLE)
+        {
+            RetiredTextureImages.push_back({Upload.Texture, Texture.Image, Texture.Memory, Texture.View, std::vector<char>(DescriptorSets.size(), 1)});
+
+            Texture.Image = Upload.Image;
+            Texture.Memory = Upload.Memory;
+            Texture.View = CreateImageView(Texture.Image, Texture.Format, VK_IMAGE_ASPECT_COLOR_BIT, Texture.Residency.LevelCount - Upload.AllocatedLevel);
+        }
+        else if (Upload.ResidentLevel == 0)
+        {
+            auto StreamTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Texture.CreateTime).count();
+            std::cout << "Texture " << Upload.Texture << " fully resident after " << StreamTime << " ms, " << Texture.StagedBytes << " bytes staged, " << Texture.HostCopiedBytes << " bytes host copied" << std::endl;
+        }
+
+        Texture.Residency.AllocatedLevel = Upload.AllocatedLevel;
+        Texture.Residency.ResidentLevel = Upload.ResidentLevel;
+        PendingTextureUpload = {};
+
+        QueueTextureDescriptorWrite(Upload.Texture);
+    }
+
+    char* ReserveTextureStaging(VkDeviceSize Size)
+    {
+        if (Size > TextureStagingSize)
+        {
+            DestroyTextureStaging();
+
+            CreateBuffer(Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, TextureStagingBuffer, TextureStagingBufferMemory);
+
+            void* Data;
+            vkMapMemory(Device, TextureStagingBufferMemory, 0, Size, 0, &Data);
+            TextureStagingData = static_cast<char*>(Data);
+            TextureStagingSize = Size;
+        }
+
+        return TextureStagingData;
+    }
+
+    void DestroyTextureStaging()
+    {
+        if (TextureStagingBuffer != VK_NULL_HANDLE)
+        {
+            vkUnmapMemory(Device, TextureStagingBufferMemory);
+            vkDestroyBuffer(Device, TextureStagingBuffer, nullptr);
+            vkFreeMemory(Device, TextureStagingBufferMemory, nullptr);
+            TextureStagingBuffer = VK_NULL_HANDLE;
+            TextureStagingData = nullptr;
+            TextureStagingSize = 0;
+        }
+    }
+
+    void DestroyTextureStreamingResources()
+    {
+        if (PendingTextureUpload.Image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(Device, PendingTextureUpload.Image, nullptr);
+            vkFreeMemory(Device, PendingTextureUpload.Memory, nullptr);
+            PendingTextureUpload = {};
+        }
+
+        DestroyRetiredTextureImages(true);
+        DestroyTextureStaging();
+        vkDestroyFence(Device, TextureUploadFence, nullptr);
+    }
+
+    void RecordTextureBarrier(VkCommandBuffer CommandBuffer, VkImage Image, uint32_t BaseLevel, uint32_t LevelCount, VkImageLayout OldLayout, VkImageLayout NewLayout)
+    {
+        auto GetLayoutAccess = [](VkImageLayout Layout, VkAccessFlags& Access, VkPipelineStageFlags& Stage)
+        {
+            switch (Layout)
+            {
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                Access = VK_ACCESS_TRANSFER_WRITE_BIT;
+                Stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+                Access = VK_ACCESS_TRANSFER_READ_BIT;
+                Stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                Access = VK_ACCESS_SHADER_READ_BIT;
+                Stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                break;
+            default:
+                Access = 0;
+                Stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                break;
+            }
+        };
+
+        VkImageMemoryBarrier Barrier{};
+        Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        Barrier.oldLayout = OldLayout;
+        Barrier.newLayout = NewLayout;
+        Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.image = Image;
+        Barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, BaseLevel, LevelCount, 0, 1};
+
+        VkPipelineStageFlags SourceStage;
+        VkPipelineStageFlags DestinationStage;
+        GetLayoutAccess(OldLayout, Barrier.srcAccessMask, SourceStage);
+        GetLayoutAccess(NewLayout, Barrier.dstAccessMask, DestinationStage);
+
+        vkCmdPipelineBarrier(CommandBuffer, SourceStage, DestinationStage, 0, 0, nullptr, 0, nullptr, 1, &Barrier);
+    }
+
+    void CreateDescriptorSetLayout()
+    {
+        VkDescriptorSetLayoutBinding UboLayoutBinding{};
+        UboLayoutBinding.binding = 0;
+        UboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        UboLayoutBinding.descriptorCount = 1;
+        UboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        UboLayoutBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutBinding SamplerLayoutBinding{};
+        SamplerLayoutBinding.binding = 1;
+        SamplerLayoutBinding.descriptorCount = MAX_BINDLESS_TEXTURES;
+        SamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        SamplerLayoutBinding.pImmutableSamplers = nullptr;
+        SamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        std::vector<VkDescriptorSetLayoutBinding> Bindings {UboLayoutBinding, SamplerLayoutBinding};
+
+        // Virtual textures bind their indirection chain as the texture, next to the shared page atlas and the feedback buffer
+        if (bVirtualTexturing)
+        {
+            VkDescriptorSetLayoutBinding AtlasLayoutBinding = SamplerLayoutBinding;
+            AtlasLayoutBinding.binding = 2;
+            AtlasLayoutBinding.descriptorCount = 1;
+
+            VkDescriptorSetLayoutBinding FeedbackLayoutBinding = AtlasLayoutBinding;
+            FeedbackLayoutBinding.binding = 3;
+            FeedbackLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+            Bindings.push_back(AtlasLayoutBinding);
+            Bindings.push_back(FeedbackLayoutBinding);
+        }
+
+        // The texture table is written as textures are created and rewritten as they stream, without recording the
+        // command buffers that bound it again. A set is only written once the frame that last used it has completed,
+        // see QueueTextureDescriptorWrite. Entries no texture uses yet are never written.
+        std::vector<VkDescriptorBindingFlagsEXT> BindingFlags(Bindings.size(), 0);
+        BindingFlags[1] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT;
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT BindingFlagsInfo{};
+        BindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        BindingFlagsInfo.bindingCount = static_cast<uint32_t>(BindingFlags.size());
+        BindingFlagsInfo.pBindingFlags = BindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo LayoutInfo{};
+        LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        LayoutInfo.pNext = &BindingFlagsInfo;
+        LayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        LayoutInfo.bindingCount = static_cast<uint32_t>(Bindings.size());
+        LayoutInfo.pBindings = Bindings.data();
+
+        if (vkCreateDescriptorSetLayout(Device, &LayoutInfo, nullptr, &DescriptorSetLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create descriptor set layout!");
+        }
+    }
+
+    void CreateUniformBuffers()
+    {
+        VkDeviceSize BufferSize = sizeof(UniformBufferObject);
+
+        UniformBuffers.resize(SwapChainImages.size());
+        UniformBuffersMemory.resize(SwapChainImages.size());
+
+        for (size_t i = 0; i < SwapChainImages.size(); ++i)
+        {
+            CreateBuffer(BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, UniformBuffers[i], UniformBuffersMemory[i]);
+        }
+    }
+
+    uint32_t GetDrawCommandCount() const
+    {
+        return std::max<uint32_t>(1, static_cast<uint32_t>(MaterialTextures.size()));
+    }
+
+    // One draw command per material, so every texture is bound once per frame whichever LOD is drawn
+    void CreateDrawIndirectBuffers()
+    {
+        DrawIndirectBuffers.resize(SwapChainImages.size());
+        DrawIndirectBuffersMemory.resize(SwapChainImages.size());
+
+        for (size_t i = 0; i < SwapChainImages.size(); ++i)
+        {
+            CreateBuffer(GetDrawCommandCount() * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, DrawIndirectBuffers[i], DrawIndirectBuffersMemory[i]);
+        }
+    }
+
+    void DestroyDrawIndirectBuffers()
+    {
+        for (size_t i = 0; i < DrawIndirectBuffers.size(); ++i)
+        {
+            vkDestroyBuffer(Device, DrawIndirectBuffers[i], nullptr);
+            vkFreeMemory(Device, DrawIndirectBuffersMemory[i], nullptr);
+        }
+    }
+
+    void CreateDescriptorPool()
+    {
+        uint32_t SetCount = static_cast<uint32_t>(SwapChainImages.size());
+
+        std::vector<VkDescriptorPoolSize> PoolSizes(2);
+        PoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        PoolSizes[0].descriptorCount = SetCount;
+        PoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        PoolSizes[1].descriptorCount = SetCount * (bVirtualTexturing ? MAX_BINDLESS_TEXTURES + 1 : MAX_BINDLESS_TEXTURES);
+
+        if (bVirtualTexturing)
+        {
+            PoolSizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SetCount});
+        }
+
+        VkDescriptorPoolCreateInfo PoolInfo{};
+        PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        PoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        PoolInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
+        PoolInfo.pPoolSizes = PoolSizes.data();
+        PoolInfo.maxSets = SetCount;
+
+        if (vkCreateDescriptorPool(Device, &PoolInfo, nullptr, &DescriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create descriptor pool!");
+        }
+    }
+
+    // One set per swap chain image, holding the uniform buffer of the image and the table of every texture
+    void CreateDescriptorSet()
+    {
+        std::vector<VkDescriptorSetLayout> Layouts(SwapChainImages.size(), DescriptorSetLayout);
+        VkDescriptorSetAllocateInfo AllocInfo{};
+        AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        AllocInfo.descriptorPool = DescriptorPool;
+        AllocInfo.descriptorSetCount = static_cast<uint32_t>(Layouts.size());
+        AllocInfo.pSetLayouts = Layouts.data();
+
+        DescriptorSets.resize(Layouts.size());
+        if (vkAllocateDescriptorSets(Device, &AllocInfo, DescriptorSets.data()) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to allocate descriptor sets!");
+        }
+
+        for (size_t i = 0; i < DescriptorSets.size(); ++i)
+        {
+            VkDescriptorBufferInfo BufferInfo{};
+            BufferInfo.buffer = UniformBuffers[i];
+            BufferInfo.offset = 0;
+            BufferInfo.range = sizeof(UniformBufferObject);
+
+            VkWriteDescriptorSet DescriptorWrite{};
+            DescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrite.dstSet = DescriptorSets[i];
+            DescriptorWrite.dstBinding = 0;
+            DescriptorWrite.dstArrayElement = 0;
+            DescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            DescriptorWrite.descriptorCount = 1;
+            DescriptorWrite.pBufferInfo = &BufferInfo;
+
+            vkUpdateDescriptorSets(Device, 1, &DescriptorWrite, 0, nullptr);
+        }
+
+        for (std::size_t t = 0; t < Textures.size(); ++t)
+        {
+            UpdateTextureDescriptorSets(t);
+        }
+
+        UpdateVirtualTextureDescriptorSets();
+        PendingTextureWrites.assign(DescriptorSets.size(), {});
+        PendingVirtualTextureWrites.assign(DescriptorSets.size(), 0);
+        DestroyRetiredTextureImages(true);
+    }
+
+    // Writes entry TextureIndex of the texture table in every set, only while no frame in flight uses them
+    void UpdateTextureDescriptorSets(std::size_t TextureIndex)
+    {
+        for (std::size_t i = 0; i < DescriptorSets.size(); ++i)
+        {
+            WriteTextureDescriptors(i, {TextureIndex});
+        }
+    }
+
+    void WriteTextureDescriptors(std::size_t SetIndex, const std::vector<std::size_t>& TextureIndices)
+    {
+        std::vector<VkDescriptorImageInfo> ImageInfos(TextureIndices.size());
+        std::vector<VkWriteDescriptorSet> DescriptorWrites(TextureIndices.size());
+
+        for (std::size_t i = 0; i < DescriptorWrites.size(); ++i)
+        {
+            ImageInfos[i] = GetTextureImageInfo(Textures[TextureIndices[i]]);
+
+            DescriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrites[i].dstSet = DescriptorSets[SetIndex];
+            DescriptorWrites[i].dstBinding = 1;
+            DescriptorWrites[i].dstArrayElement = static_cast<uint32_t>(TextureIndices[i]);
+            DescriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            DescriptorWrites[i].descriptorCount = 1;
+            DescriptorWrites[i].pImageInfo = &ImageInfos[i];
+        }
+
+        vkUpdateDescriptorSets(Device, static_cast<uint32_t>(DescriptorWrites.size()), DescriptorWrites.data(), 0, nullptr);
+    }
+
+    // Frames in flight may be sampling any entry of the sets they bound, so while they run an entry is only marked. Each
+    // set picks up its marked entries in DrawFrame, after the frame that last used it has completed.
+    void QueueTextureDescriptorWrite(std::size_t TextureIndex)
+    {
+        for (auto& Writes : PendingTextureWrites)
+        {
+            if (std::find(Writes.begin(), Writes.end(), TextureIndex) == Writes.end())
+            {
+                Writes.push_back(TextureIndex);
+            }
+        }
+    }
+
+    void FlushTextureDescriptorWrites(uint32_t ImageIndex)
+    {
+        if (PendingVirtualTextureWrites[ImageIndex])
+        {
+            WriteVirtualTextureDescriptors(ImageIndex);
+            PendingVirtualTextureWrites[ImageIndex] = 0;
+        }
+
+        if (PendingTextureWrites[ImageIndex].empty())
+        {
+            return;
+        }
+
+        WriteTextureDescriptors(ImageIndex, PendingTextureWrites[ImageIndex]);
+
+        for (auto& Retired : RetiredTextureImages)
+        {
+            if (std::find(PendingTextureWrites[ImageIndex].begin(), PendingTextureWrites[ImageIndex].end(), Retired.Texture) != PendingTextureWrites[ImageIndex].end())
+            {
+                Retired.ReferencingSets[ImageIndex] = 0;
+            }
+        }
+
+        PendingTextureWrites[ImageIndex].clear();
+        DestroyRetiredTextureImages(false);
+    }
+
+    // Frames only reach a retired image through the sets still referring to it, each set stopped being used by the
+    // frames in flight before it was rewritten
+    void DestroyRetiredTextureImages(bool bAll)
+    {
+        for (auto Retired = RetiredTextureImages.begin(); Retired != RetiredTextureImages.end();)
+        {
+            if (!bAll && std::find(Retired->ReferencingSets.begin(), Retired->ReferencingSets.end(), 1) != Retired->ReferencingSets.end())
+            {
+                ++Retired;
+                continue;
+            }
+
+            vkDestroyImageView(Device, Retired->View, nullptr);
+            vkDestroyImage(Device, Retired->Image, nullptr);
+            vkFreeMemory(Device, Retired->Memory, nullptr);
+            Retired = RetiredTextureImages.erase(Retired);
+        }
+    }
+
+    // The page atlas and the feedback buffer of each image, shared by every virtual texture
+    void UpdateVirtualTextureDescriptorSets()
+    {
+        if (!bVirtualTexturing)
+        {
+            return;
+        }
+
+        for (std::size_t i = 0; i < DescriptorSets.size(); ++i)
+        {
+            WriteVirtualTextureDescriptors(i);
+        }
+    }
+
+    // The feedback buffers are replaced once the model arrives, each set is rewritten like its texture table entries
+    void QueueVirtualTextureDescriptorWrites()
+    {
+        if (bVirtualTexturing)
+        {
+            PendingVirtualTextureWrites.assign(DescriptorSets.size(), 1);
+        }
+    }
+
+    void WriteVirtualTextureDescriptors(std::size_t SetIndex)
+    {
+        VkDescriptorImageInfo AtlasInfo{};
+        AtlasInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        AtlasInfo.imageView = VirtualTextureAtlasView;
+        AtlasInfo.sampler = VirtualTextureAtlasSampler;
+
+        VkDescriptorBufferInfo FeedbackInfo{};
+        FeedbackInfo.buffer = VirtualTextureFeedbackBuffers[SetIndex];
+        FeedbackInfo.offset = 0;
+        FeedbackInfo.range = VK_WHOLE_SIZE;
+
+        std::array<VkWriteDescriptorSet, 2> DescriptorWrites{};
+        DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        DescriptorWrites[0].dstSet = DescriptorSets[SetIndex];
+        DescriptorWrites[0].dstBinding = 2;
+        DescriptorWrites[0].dstArrayElement = 0;
+        DescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        DescriptorWrites[0].descriptorCount = 1;
+        DescriptorWrites[0].pImageInfo = &AtlasInfo;
+
+        DescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        DescriptorWrites[1].dstSet = DescriptorSets[SetIndex];
+        DescriptorWrites[1].dstBinding = 3;
+        DescriptorWrites[1].dstArrayElement = 0;
+        DescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        DescriptorWrites[1].descriptorCount = 1;
+        DescriptorWrites[1].pBufferInfo = &FeedbackInfo;
+
+        vkUpdateDescriptorSets(Device, static_cast<uint32_t>(DescriptorWrites.size()), DescriptorWrites.data(), 0, nullptr);
+    }
+
+    // Sampling is clamped to the resident levels through the sampler's minLod, relative to the first level of the image
+    VkDescriptorImageInfo GetTextureImageInfo(const FTexture& Texture)
+    {
+        VkDescriptorImageInfo ImageInfo{};
+        ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        ImageInfo.imageView = Texture.View;
+        ImageInfo.sampler = Texture.VirtualSource ? VirtualTextureIndirectionSampler : TextureSamplers[Texture.Residency.ResidentLevel - Texture.Residency.AllocatedLevel];
+        return ImageInfo;
+    }
+
+    // Cooked assets are read on the pool from process start, overlapping window, device and pipeline creation.
+    // Each one is only joined where it gets uploaded.
+    // Textures are virtual when the default texture was cooked as one, their pages are then read as frames ask for them.
+    void StartAssetLoading()
+    {
+        AssetLoadStartTime = std::chrono::steady_clock::now();
+        bVirtualTexturing = std::filesystem::exists(GetCookedVirtualTexturePath(TEXTURE_PATH));
+
+        if (!bVirtualTexturing)
+        {
+            DefaultTextureFuture = AssetLoadPool.Submit([]() { return LoadCookedTexture(TEXTURE_PATH, GetCookedTextureFormats()); });
+        }
+
+        ModelLoadFuture = AssetLoadPool.Submit([this]() { LoadModel(); });
+    }
+
+    // Loads start before the device is known, so they take the preferred cooked format. The rare device that
+    // cannot sample it gets the texture reloaded in a format it supports once the load is joined.
+    // Only the mapping is faulted in here, supercompressed levels are inflated straight into staging memory.
+    static std::unique_ptr<FTextureCache> LoadCookedTexture(const std::string& Path, const std::vector<VkFormat>& Formats)
+    {
+        auto TextureCache = std::make_unique<FTextureCache>();
+
+        for (VkFormat Format : Formats)
+        {
+            if (TextureCache->Open(GetCookedTexturePath(Path, *GetTextureFormatInfo(Format))) && static_cast<VkFormat>(TextureCache->GetHeader().Format) == Format)
+            {
+                TextureCache->Prefault();
+                return TextureCache;
+            }
+        }
+
+        return nullptr;
+    }
+
+    static std::vector<VkFormat> GetCookedTextureFormats()
+    {
+        std::vector<VkFormat> Formats;
+
+        for (const auto& Info : COOKED_TEXTURE_FORMATS)
+        {
+            Formats.push_back(Info.Format);
+        }
+
+        return Formats;
+    }
+
+    std::vector<VkFormat> GetSupportedTextureFormats()
+    {
+        VkFormatFeatureFlags Features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+        std::vector<VkFormat> Formats;
+
+        for (const auto& Info : COOKED_TEXTURE_FORMATS)
+        {
+            VkFormatProperties Props;
+            vkGetPhysicalDeviceFormatProperties(PhysicalDevice, Info.Format, &Props);
+
+            if ((Props.optimalTilingFeatures & Features) == Features)
+            {
+                Formats.push_back(Info.Format);
+            }
+        }
+
+        return Formats;
+    }
+
+    // Formats whose images can take host copies without being laid out worse for sampling. Devices may pick another
+    // layout for images that allow host copies, such formats keep the staging upload.
+    std::vector<VkFormat> GetHostImageCopyFormats()
+    {
+        std::vector<VkFormat> Formats;
+
+        if (!bHostImageCopySupported)
+        {
+            return Formats;
+        }
+
+        for (VkFormat Format : SupportedTextureFormats)
+        {
+            VkPhysicalDeviceImageFormatInfo2 FormatInfo{};
+            FormatInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2;
+            FormatInfo.format = Format;
+            FormatInfo.type = VK_IMAGE_TYPE_2D;
+            FormatInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            FormatInfo.usage = GetTextureImageUsage(Format) | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+
+            VkHostImageCopyDevicePerformanceQueryEXT PerformanceQuery{};
+            PerformanceQuery.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT;
+
+            VkImageFormatProperties2 FormatProperties{};
+            FormatProperties.sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2;
+            FormatProperties.pNext = &PerformanceQuery;
+
+            if (vkGetPhysicalDeviceImageFormatProperties2(PhysicalDevice, &FormatInfo, &FormatProperties) == VK_SUCCESS && PerformanceQuery.optimalDeviceAccess)
+            {
+                Formats.push_back(Format);
+            }
+        }
+
+        return Formats;
+    }
+
+    bool IsHostImageCopyFormat(VkFormat Format) const
+    {
+        return std::find(HostImageCopyFormats.begin(), HostImageCopyFormats.end(), Format) != HostImageCopyFormats.end();
+    }
+
+    VkImageUsageFlags GetTextureImageUsage(VkFormat Format) const
+    {
+        VkImageUsageFlags Usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        return IsHostImageCopyFormat(Format) ? Usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT : Usage;
+    }
+
+    std::unique_ptr<FTextureCache> EnsureSupportedTextureFormat(std::unique_ptr<FTextureCache> TextureCache, const std::string& Path)
+    {
+        if (!TextureCache)
+        {
+            return nullptr;
+        }
+
+        VkFormat Format = static_cast<VkFormat>(TextureCache->GetHeader().Format);
+
+        if (std::find(SupportedTextureFormats.begin(), SupportedTextureFormats.end(), Format) != SupportedTextureFormats.end())
+        {
+            return TextureCache;
+        }
+
+        std::cout << "Cooked texture " << Path << " is in a format the device cannot sample, reloading" << std::endl;
+        return LoadCookedTexture(Path, SupportedTextureFormats);
+    }
+
+    void CreateTextureImage()
+    {
+        if (bVirtualTexturing)
+        {
+            std::unique_ptr<FVirtualTextureCache> VirtualTextureCache = LoadVirtualTexture(TEXTURE_PATH);
+
+            if (!VirtualTextureCache)
+            {
+                throw std::runtime_error("Failed to load cooked virtual texture, run asset_cooker!");
+            }
+
+            VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
+            Textures.push_back(CreateVirtualTexture(std::move(VirtualTextureCache), CommandBuffer));
+            EndSingleTimeCommand(CommandBuffer);
+            ReleasePendingStagingBuffers();
+            return;
+        }
+
+        auto WaitStartTime = std::chrono::steady_clock::now();
+        std::unique_ptr<FTextureCache> TextureCache = EnsureSupportedTextureFormat(DefaultTextureFuture.get(), TEXTURE_PATH);
+        auto WaitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - WaitStartTime).count();
+        auto ReadyTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - AssetLoadStartTime).count();
+
+        if (!TextureCache)
+        {
+            throw std::runtime_error("Failed to load cooked texture image, run asset_cooker!");
+        }
+
+        std::cout << "Default texture joined " << ReadyTime << " ms after start, waited " << WaitTime << " ms" << std::endl;
+
+        VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
+        Textures.push_back(CreateTexture(std::move(TextureCache), CommandBuffer));
+        EndSingleTimeCommand(CommandBuffer);
+        ReleasePendingStagingBuffers();
+    }
+
+    // The image gets the whole mip chain when it fits the streaming budget, but only the coarse tail is uploaded here.
+    // Finer levels stream in from the kept cooked texture while sampling is clamped to the resident ones. A tail that
+    // goes through staging memory is recorded into CommandBuffer, which the caller submits.
+    FTexture CreateTexture(std::unique_ptr<FTextureCache> TextureCache, VkCommandBuffer CommandBuffer)
+    {
+        const FTextureCacheHeader& Header = TextureCache->GetHeader();
+        VkFormat Format = static_cast<VkFormat>(Header.Format);
+        const FTextureFormatInfo* FormatInfo = GetTextureFormatInfo(Format);
+
+        if (FormatInfo == nullptr || std::find(SupportedTextureFormats.begin(), SupportedTextureFormats.end(), Format) == SupportedTextureFormats.end())
+        {
+            throw std::runtime_error("Failed to create texture, unsupported cooked texture format!");
+        }
+
+        for (uint32_t i = 0; i < Header.LevelCount; ++i)
+        {
+            if (Header.Levels[i].UncompressedSize != GetTextureLevelSize(*FormatInfo, Header.Levels[i].Width, Header.Levels[i].Height))
+            {
+                throw std::runtime_error("Failed to create texture, cooked mip level size does not match its extent!");
+            }
+        }
+
+        FTexture Texture{};
+        Texture.Format = Format;
+        Texture.Residency = GetInitialTextureResidency(Header);
+        Texture.Residency.AllocatedLevel = GetAllocatableTextureLevel(Texture.Residency, GetTextureMemoryUsage());
+        Texture.Source = std::move(TextureCache);
+        Texture.CreateTime = std::chrono::steady_clock::now();
+
+        CreateStreamedImage(Texture, Texture.Residency.AllocatedLevel, Texture.Image, Texture.Memory);
+
+        if (IsHostImageCopyFormat(Format))
+        {
+            CopyTextureTailFromHost(Texture);
+        }
+        else
+        {
+            CopyTextureTailFromStaging(Texture, CommandBuffer);
+        }
+
+        Texture.View = CreateImageView(Texture.Image, Format, VK_IMAGE_ASPECT_COLOR_BIT, Texture.Residency.LevelCount - Texture.Residency.AllocatedLevel);
+
+        return Texture;
+    }
+
+    // Levels that are not resident yet only move to the layout sampling expects, the sampler never reaches them
+    void CopyTextureTailFromStaging(FTexture& Texture, VkCommandBuffer CommandBuffer)
+    {
+        const FTextureCacheHeader& Header = Texture.Source->GetHeader();
+        const FTextureResidency& Residency = Texture.Residency;
+        uint32_t ImageLevels = Residency.LevelCount - Residency.AllocatedLevel;
+        std::vector<VkBufferImageCopy> Regions(Residency.LevelCount - Residency.TailLevel);
+        VkDeviceSize TailOffset = Texture.Source->GetLevelOffset(Residency.TailLevel);
+
+        for (uint32_t i = 0; i < Regions.size(); ++i)
+        {
+            const FTextureCacheLevel& Level = Header.Levels[Residency.TailLevel + i];
+
+            Regions[i].bufferOffset = Texture.Source->GetLevelOffset(Residency.TailLevel + i) - TailOffset;
+            Regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            Regions[i].imageSubresource.mipLevel = Residency.TailLevel + i - Residency.AllocatedLevel;
+            Regions[i].imageSubresource.baseArrayLayer = 0;
+            Regions[i].imageSubresource.layerCount = 1;
+            Regions[i].imageOffset = {0, 0, 0};
+            Regions[i].imageExtent = {Level.Width, Level.Height, 1};
+        }
+
+        VkDeviceSize TailSize = Texture.Source->GetDataSize() - TailOffset;
+
+        FStagingBuffer Staging{};
+        CreateBuffer(TailSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, Staging.Buffer, Staging.Memory);
+
+        void *Data;
+        vkMapMemory(Device, Staging.Memory, 0, TailSize, 0, &Data);
+        Texture.StagedBytes = Texture.Source->ReadLevels(Residency.TailLevel, Residency.LevelCount - Residency.TailLevel, static_cast<char*>(Data));
+        vkUnmapMemory(Device, Staging.Memory);
+
+        if (Texture.StagedBytes == 0)
+        {
+            vkDestroyBuffer(Device, Staging.Buffer, nullptr);
+            vkFreeMemory(Device, Staging.Memory, nullptr);
+            throw std::runtime_error("Failed to create texture, cooked mip level is corrupt!");
+        }
+
+        RecordTextureBarrier(CommandBuffer, Texture.Image, 0, ImageLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        vkCmdCopyBufferToImage(CommandBuffer, Staging.Buffer, Texture.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(Regions.size()), Regions.data());
+        RecordTextureBarrier(CommandBuffer, Texture.Image, 0, ImageLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        PendingStagingBuffers.push_back(Staging);
+    }
+
+    void ReleasePendingStagingBuffers()
+    {
+        for (const auto& Staging : PendingStagingBuffers)
+        {
+            vkDestroyBuffer(Device, Staging.Buffer, nullptr);
+            vkFreeMemory(Device, Staging.Memory, nullptr);
+        }
+
+        PendingStagingBuffers.clear();
+    }
+
+    // No staging buffer, command buffer or submit. Stored levels are copied straight out of the cooked file's mapping,
+    // only supercompressed ones are inflated into host memory first.
+    void CopyTextureTailFromHost(FTexture& Texture)
+    {
+        const FTextureCacheHeader& Header = Texture.Source->GetHeader();
+        const FTextureResidency& Residency = Texture.Residency;
+        VkDeviceSize TailOffset = Texture.Source->GetLevelOffset(Residency.TailLevel);
+        std::vector<VkMemoryToImageCopyEXT> Regions(Residency.LevelCount - Residency.TailLevel);
+        std::vector<char> Inflated;
+
+        for (uint32_t i = 0; i < Regions.size(); ++i)
+        {
+            uint32_t LevelIndex = Residency.TailLevel + i;
+            const FTextureCacheLevel& Level = Header.Levels[LevelIndex];
+            const char* Data = Texture.Source->GetStoredLevelData(LevelIndex);
+
+            if (Data == nullptr)
+            {
+                if (Inflated.empty())
+                {
+                    Inflated.resize(Texture.Source->GetDataSize() - TailOffset);
+                }
+
+                char* Output = &Inflated[Texture.Source->GetLevelOffset(LevelIndex) - TailOffset];
+
+                if (Texture.Source->ReadLevels(LevelIndex, 1, Output) == 0)
+                {
+                    throw std::runtime_error("Failed to create texture, cooked mip level is corrupt!");
+                }
+
+                Data = Output;
+            }
+
+            Regions[i].sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT;
+            Regions[i].pHostPointer = Data;
+            Regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            Regions[i].imageSubresource.mipLevel = LevelIndex - Residency.AllocatedLevel;
+            Regions[i].imageSubresource.baseArrayLayer = 0;
+            Regions[i].imageSubresource.layerCount = 1;
+            Regions[i].imageOffset = {0, 0, 0};
+            Regions[i].imageExtent = {Level.Width, Level.Height, 1};
+
+            Texture.HostCopiedBytes += Residency.LevelSizes[LevelIndex];
+        }
+
+        TransitionImageLayoutOnHost(Texture.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, Residency.LevelCount - Residency.AllocatedLevel);
+        CopyMemoryToImage(Texture.Image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, Regions);
+    }
+
+    // The image of a texture that holds AllocatedLevel and every coarser level
+    void CreateStreamedImage(const FTexture& Texture, uint32_t AllocatedLevel, VkImage& Image, VkDeviceMemory& Memory)
+    {
+        const FTextureCacheLevel& Level = Texture.Source->GetHeader().Levels[AllocatedLevel];
+
+        CreateImage(Level.Width, Level.Height, Texture.Residency.LevelCount - AllocatedLevel, VK_SAMPLE_COUNT_1_BIT, Texture.Format, VK_IMAGE_TILING_OPTIMAL,
+                    GetTextureImageUsage(Texture.Format), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Image, Memory);
+    }
+
+    uint64_t GetTextureMemoryUsage() const
+    {
+        uint64_t MemoryUsage = 0;
+
+        for (const auto& Texture : Textures)
+        {
+            MemoryUsage += GetTextureLevelsSize(Texture.Residency, Texture.Residency.AllocatedLevel);
+        }
+
+        return MemoryUsage;
+    }
+
+    void CreateMaterialTextures(VkCommandBuffer CommandBuffer)
+    {
+        MaterialTextures.assign(ModelMaterials.size(), 0);
+
+        for (std::size_t m = 0; m < ModelMaterials.size(); ++m)
+        {
+            std::size_t TextureCount = Textures.size();
+
+            if (TextureCount == MAX_BINDLESS_TEXTURES)
+            {
+                std::cerr << "Texture table is full, material texture " << ModelMaterials[m].DiffuseTexture << " uses " << TEXTURE_PATH << std::endl;
+                continue;
+            }
+
+            if (bVirtualTexturing)
+            {
+                std::unique_ptr<FVirtualTextureCache> VirtualTextureCache = LoadVirtualTexture(ModelMaterials[m].DiffuseTexture);
+
+                if (VirtualTextureCache)
+                {
+                    Textures.push_back(CreateVirtualTexture(std::move(VirtualTextureCache), CommandBuffer));
+                }
+            }
+            else
+            {
+                std::unique_ptr<FTextureCache> TextureCache = EnsureSupportedTextureFormat(MaterialTextureFutures[m].get(), ModelMaterials[m].DiffuseTexture);
+
+                if (TextureCache)
+                {
+                    Textures.push_back(CreateTexture(std::move(TextureCache), CommandBuffer));
+                }
+            }
+
+            if (Textures.size() > TextureCount)
+            {
+                MaterialTextures[m] = static_cast<uint32_t>(TextureCount);
+            }
+            else if (ModelMaterials[m].DiffuseTexture[0] != '\0')
+            {
+                std::cerr << "Failed to load cooked material texture " << ModelMaterials[m].DiffuseTexture << ", using " << TEXTURE_PATH << std::endl;
+            }
+        }
+
+        MaterialTextureFutures.clear();
+    }
+
+    // Runs as part of the model load, each material texture gets its own task. Materials without a
+    // diffuse texture, or whose texture was not cooked, are drawn with the default texture.
+    void SubmitMaterialTextureLoads()
+    {
+        MaterialTextureFutures.clear();
+
+        // Virtual textures only map their cooked file when created, there is nothing to load ahead
+        if (bVirtualTexturing)
+        {
+            return;
+        }
+
+        for (const auto& Material : ModelMaterials)
+        {
+            std::string Path = Material.DiffuseTexture;
+
+            MaterialTextureFutures.push_back(AssetLoadPool.Submit([Path]() -> std::unique_ptr<FTextureCache>
+            {
+                return Path.empty() ? nullptr : LoadCookedTexture(Path, GetCookedTextureFormats());
+            }));
+        }
+    }
+
+    static std::unique_ptr<FVirtualTextureCache> LoadVirtualTexture(const std::string& Path)
+    {
+        auto VirtualTextureCache = std::make_unique<FVirtualTextureCache>();
+
+        if (Path.empty() || !VirtualTextureCache->Open(GetCookedVirtualTexturePath(Path)))
+        {
+            return nullptr;
+        }
+
+        return VirtualTextureCache;
+    }
+
+    // Every virtual texture samples its resident pages out of this one image, VirtualTexturePageCache hands out its slots
+    void CreateVirtualTextureAtlas()
+    {
+        if (!bVirtualTexturing)
+        {
+            return;
+        }
+
+        uint32_t AtlasSize = VIRTUAL_TEXTURE_ATLAS_PAGES * VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE;
+
+        CreateImage(AtlasSize, AtlasSize, 1, VK_SAMPLE_COUNT_1_BIT, VIRTUAL_TEXTURE_ATLAS_FORMAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VirtualTextureAtlasImage, VirtualTextureAtlasMemory);
+        VirtualTextureAtlasView = CreateImageView(VirtualTextureAtlasImage, VIRTUAL_TEXTURE_ATLAS_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+        VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
+        RecordTextureBarrier(CommandBuffer, VirtualTextureAtlasImage, 0, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        EndSingleTimeCommand(CommandBuffer);
+
+        VirtualTexturePageCache.Reset(VIRTUAL_TEXTURE_ATLAS_PAGES * VIRTUAL_TEXTURE_ATLAS_PAGES);
+
+        // Page borders make filtering within the atlas safe, the level is picked by the shader so the atlas has no mips
+        VkSamplerCreateInfo SamplerInfo{};
+        SamplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        SamplerInfo.magFilter = VK_FILTER_LINEAR;
+        SamplerInfo.minFilter = VK_FILTER_LINEAR;
+        SamplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        SamplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        SamplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        SamplerInfo.anisotropyEnable = VK_FALSE;
+        SamplerInfo.maxAnisotropy = 1.f;
+        SamplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        SamplerInfo.unnormalizedCoordinates = VK_FALSE;
+        SamplerInfo.compareEnable = VK_FALSE;
+        SamplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+        SamplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        SamplerInfo.minLod = 0.f;
+        SamplerInfo.maxLod = 0.f;
+
+        if (vkCreateSampler(Device, &SamplerInfo, nullptr, &VirtualTextureAtlasSampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create page atlas sampler!");
+        }
+
+        SamplerInfo.magFilter = VK_FILTER_NEAREST;
+        SamplerInfo.minFilter = VK_FILTER_NEAREST;
+        SamplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+        if (vkCreateSampler(Device, &SamplerInfo, nullptr, &VirtualTextureIndirectionSampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create indirection sampler!");
+        }
+    }
+
+    // The image of a virtual texture is its indirection chain, one texel per page. The coarsest level is pinned in the
+    // atlas here, so every texel has a page to fall back to, finer pages are only read once a frame asks for them.
+    // The caller appends the texture to Textures, its pages are keyed by that index, and submits CommandBuffer.
+    FTexture CreateVirtualTexture(std::unique_ptr<FVirtualTextureCache> VirtualTextureCache, VkCommandBuffer CommandBuffer)
+    {
+        const FVirtualTextureHeader& Header = VirtualTextureCache->GetHeader();
+
+        if (static_cast<VkFormat>(Header.Format) != VIRTUAL_TEXTURE_ATLAS_FORMAT)
+        {
+            throw std::runtime_error("Failed to create virtual texture, its pages do not match the atlas format!");
+        }
+
+        FTexture Texture{};
+        Texture.Format = VK_FORMAT_R8G8B8A8_UINT;
+        Texture.VirtualSource = std::move(VirtualTextureCache);
+        Texture.PageSlots.assign(Header.PageCount, VIRTUAL_TEXTURE_NO_SLOT);
+        Texture.CreateTime = std::chrono::steady_clock::now();
+
+        CreateImage(Header.Levels[0].PagesX, Header.Levels[0].PagesY, Header.LevelCount, VK_SAMPLE_COUNT_1_BIT, Texture.Format, VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Texture.Image, Texture.Memory);
+        Texture.View = CreateImageView(Texture.Image, Texture.Format, VK_IMAGE_ASPECT_COLOR_BIT, Header.LevelCount);
+
+        std::vector<FVirtualPageUpload> Uploads;
+
+        for (uint32_t Page = Header.Levels[Header.LevelCount - 1].FirstPage; Page < Header.PageCount; ++Page)
+        {
+            // Pinning may take a slot a frame in flight samples, the atlas barrier orders the upload after those frames
+            uint64_t EvictedPage = VIRTUAL_TEXTURE_NO_PAGE;
+            uint32_t Slot = VirtualTexturePageCache.Allocate(GetVirtualPageKey(Textures.size(), Page), VirtualTextureFrame + 1, true, EvictedPage);
+
+            if (Slot == VIRTUAL_TEXTURE_NO_SLOT)
+            {
+                throw std::runtime_error("Failed to create virtual texture, the page atlas is full!");
+            }
+
+            ReleaseVirtualPage(EvictedPage);
+            Texture.PageSlots[Page] = Slot;
+            Uploads.push_back({Texture.VirtualSource.get(), Page, Slot});
+        }
+
+        VkDeviceSize StagingSize = Uploads.size() * VIRTUAL_TEXTURE_PAGE_BYTES + Header.PageCount * sizeof(uint32_t);
+        FStagingBuffer Staging{};
+        CreateBuffer(StagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, Staging.Buffer, Staging.Memory);
+
+        void* Data;
+        vkMapMemory(Device, Staging.Memory, 0, StagingSize, 0, &Data);
+
+        VkDeviceSize StagingOffset = RecordVirtualTexturePages(CommandBuffer, Staging.Buffer, static_cast<char*>(Data), Uploads);
+        RecordVirtualTextureIndirection(CommandBuffer, Staging.Buffer, static_cast<char*>(Data), StagingOffset, Texture, VK_IMAGE_LAYOUT_UNDEFINED);
+
+        vkUnmapMemory(Device, Staging.Memory);
+        PendingStagingBuffers.push_back(Staging);
+
+        return Texture;
+    }
+
+    // Reads the pages the last frame drawn to this swap chain image asked for and queues reads of the missing ones,
+    // coarse levels first. Reads that completed are uploaded by a command buffer submitted ahead of the frame's own.
+    void UpdateVirtualTextures(uint32_t ImageIndex)
+    {
+        if (!bVirtualTexturing)
+        {
+            return;
+        }
+
+        ++VirtualTextureFrame;
+
+        VkCommandBuffer& CommandBuffer = VirtualTextureCommandBuffers[CurrentFrame];
+
+        if (CommandBuffer != VK_NULL_HANDLE)
+        {
+            vkFreeCommandBuffers(Device, CommandPool, 1, &CommandBuffer);
+            CommandBuffer = VK_NULL_HANDLE;
+        }
+
+        std::vector<std::pair<uint32_t, uint64_t>> Requests;
+
+        for (std::size_t t = 0; t < Textures.size(); ++t)
+        {
+            FTexture& Texture = Textures[t];
+            uint32_t* Requested = VirtualTextureFeedbackData[ImageIndex] + Texture.FeedbackOffset / sizeof(uint32_t);
+
+            for (uint32_t Page = 0; Page < Texture.PageSlots.size(); ++Page)
+            {
+                if (Requested[Page] == 0)
+                {
+                    continue;
+                }
+
+                Requested[Page] = 0;
+
+                if (Texture.PageSlots[Page] != VIRTUAL_TEXTURE_NO_SLOT)
+                {
+                    VirtualTexturePageCache.Touch(Texture.PageSlots[Page], VirtualTextureFrame);
+                }
+                else
+                {
+                    Requests.push_back({Texture.VirtualSource->GetPageLevel(Page), GetVirtualPageKey(t, Page)});
+                }
+            }
+        }
+
+        std::sort(Requests.begin(), Requests.end(), std::greater<std::pair<uint32_t, uint64_t>>());
+
+        for (const auto& Request : Requests)
+        {
+            if (PendingPageReads.size() >= VIRTUAL_TEXTURE_MAX_PENDING_READS)
+            {
+                break;
+            }
+
+            uint64_t Page = Request.second;
+
+            if (std::any_of(PendingPageReads.begin(), PendingPageReads.end(), [Page](const FVirtualPageRead& Read) { return Read.Page == Page; }))
+            {
+                continue;
+            }
+
+            const FVirtualTextureCache* Source = Textures[Page >> 32].VirtualSource.get();
+            PendingPageReads.push_back({Page, AssetLoadPool.Submit([Source, Page]() { Source->PrefaultPage(static_cast<uint32_t>(Page)); })});
+        }
+
+        std::vector<FVirtualPageUpload> Uploads;
+
+        for (auto Read = PendingPageReads.begin(); Read != PendingPageReads.end() && Uploads.size() < VIRTUAL_TEXTURE_UPLOADS_PER_FRAME;)
+        {
+            if (!IsFutureReady(Read->Ready))
+            {
+                ++Read;
+                continue;
+            }
+
+            uint64_t EvictedPage = VIRTUAL_TEXTURE_NO_PAGE;
+            uint32_t Slot = VirtualTexturePageCache.Allocate(Read->Page, VirtualTextureFrame, false, EvictedPage);
+
+            // Every slot holds a page this frame samples, the read stays queued until one frees up
+            if (Slot == VIRTUAL_TEXTURE_NO_SLOT)
+            {
+                break;
+            }
+
+            Read->Ready.get();
+            ReleaseVirtualPage(EvictedPage);
+
+            FTexture& Texture = Textures[Read->Page >> 32];
+            Texture.PageSlots[static_cast<uint32_t>(Read->Page)] = Slot;
+            Texture.bIndirectionDirty = true;
+            Uploads.push_back({Texture.VirtualSource.get(), static_cast<uint32_t>(Read->Page), Slot});
+
+            Read = PendingPageReads.erase(Read);
+        }
+
+        VkDeviceSize StagingSize = Uploads.size() * VIRTUAL_TEXTURE_PAGE_BYTES;
+
+        for (const auto& Texture : Textures)
+        {
+            StagingSize += Texture.bIndirectionDirty ? Texture.PageSlots.size() * sizeof(uint32_t) : 0;
+        }
+
+        if (StagingSize == 0)
+        {
+            return;
         }
 
-        VkMemoryRequirements MemRequirements;
-        vkGetBufferMemoryRequirements(Device, Buffer, &MemRequirements);
+        char* Data = ReserveVirtualTextureStaging(CurrentFrame, StagingSize);
+        VkBuffer Buffer = VirtualTextureStagingBuffers[CurrentFrame];
 
-        VkMemoryAllocateInfo  AllocInfo{};
-        AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        AllocInfo.allocationSize = MemRequirements.size;
-        AllocInfo.memoryTypeIndex = FindMemoryType(MemRequirements.memoryTypeBits, Properties);
+        CommandBuffer = BeginSingleTimeCommands();
+        VkDeviceSize StagingOffset = RecordVirtualTexturePages(CommandBuffer, Buffer, Data, Uploads);
 
-        if (vkAllocateMemory(Device, &AllocInfo, nullptr, &BufferMemory) != VK_SUCCESS)
+        for (auto& Texture : Textures)
         {
-            throw std::runtime_error("Failed to allocate buffer memory!");
+            if (Texture.bIndirectionDirty)
+            {
+                StagingOffset = RecordVirtualTextureIndirection(CommandBuffer, Buffer, Data, StagingOffset, Texture, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
         }
 
-        vkBindBufferMemory(Device, Buffer, BufferMemory, 0);
+        if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to record virtual texture upload!");
+        }
     }
 
-    void CreateIndexBuffer()
+    void ReleaseVirtualPage(uint64_t Page)
     {
-        VkDeviceSize BufferSize = sizeof(Indices[0]) * Indices.size();
+        if (Page != VIRTUAL_TEXTURE_NO_PAGE)
+        {
+            FTexture& Texture = Textures[Page >> 32];
+            Texture.PageSlots[static_cast<uint32_t>(Page)] = VIRTUAL_TEXTURE_NO_SLOT;
+            Texture.bIndirectionDirty = true;
+        }
+    }
+
+    // Stages the pages at the start of Data and copies them into their atlas slots, returns the staged size
+    VkDeviceSize RecordVirtualTexturePages(VkCommandBuffer CommandBuffer, VkBuffer Buffer, char* Data, const std::vector<FVirtualPageUpload>& Uploads)
+    {
+        std::vector<VkBufferImageCopy> Regions(Uploads.size());
 
-        VkBuffer StagingBuffer;
-        VkDeviceMemory StagingBufferMemory;
-        CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
+        for (std::size_t i = 0; i < Uploads.size(); ++i)
+        {
+            memcpy(Data + i * VIRTUAL_TEXTURE_PAGE_BYTES, Uploads[i].Source->GetPageData(Uploads[i].Page), static_cast<size_t>(VIRTUAL_TEXTURE_PAGE_BYTES));
 
-        void* Data;
-        vkMapMemory(Device, StagingBufferMemory, 0, BufferSize, 0, &Data);
-        memcpy(Data, Indices.data(), (std::size_t)BufferSize);
-        vkUnmapMemory(Device, StagingBufferMemory);
+            Regions[i].bufferOffset = i * VIRTUAL_TEXTURE_PAGE_BYTES;
+            Regions[i].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+            Regions[i].imageOffset = {static_cast<int32_t>(Uploads[i].Slot % VIRTUAL_TEXTURE_ATLAS_PAGES * VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE),
+                                      static_cast<int32_t>(Uploads[i].Slot / VIRTUAL_TEXTURE_ATLAS_PAGES * VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE), 0};
+            Regions[i].imageExtent = {VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE, VIRTUAL_TEXTURE_PHYSICAL_PAGE_SIZE, 1};
+        }
 
-        CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, IndexBuffer, IndexBufferMemory);
+        if (!Regions.empty())
+        {
+            RecordTextureBarrier(CommandBuffer, VirtualTextureAtlasImage, 0, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            vkCmdCopyBufferToImage(CommandBuffer, Buffer, VirtualTextureAtlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(Regions.size()), Regions.data());
+            RecordTextureBarrier(CommandBuffer, VirtualTextureAtlasImage, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
 
-        CopyBuffer(StagingBuffer, IndexBuffer, BufferSize);
-        vkDestroyBuffer(Device, StagingBuffer, nullptr);
-        vkFreeMemory(Device, StagingBufferMemory, nullptr);
+        return Uploads.size() * VIRTUAL_TEXTURE_PAGE_BYTES;
     }
 
-    void CreateDescriptorSetLayout()
+    // Rebuilds the whole indirection chain of a texture at StagingOffset, returns the offset past it
+    VkDeviceSize RecordVirtualTextureIndirection(VkCommandBuffer CommandBuffer, VkBuffer Buffer, char* Data, VkDeviceSize StagingOffset, FTexture& Texture, VkImageLayout OldLayout)
     {
-        VkDescriptorSetLayoutBinding UboLayoutBinding{};
-        UboLayoutBinding.binding = 0;
-        UboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        UboLayoutBinding.descriptorCount = 1;
-        UboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        UboLayoutBinding.pImmutableSamplers = nullptr;
+        const FVirtualTextureHeader& Header = Texture.VirtualSource->GetHeader();
 
-        VkDescriptorSetLayoutBinding SamplerLayoutBinding{};
-        SamplerLayoutBinding.binding = 1;
-        SamplerLayoutBinding.descriptorCount = 1;
-        SamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        SamplerLayoutBinding.pImmutableSamplers = nullptr;
-        SamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        std::vector<uint32_t> Entries;
+        BuildVirtualTextureIndirection(Header, Texture.PageSlots, Entries);
+        memcpy(Data + StagingOffset, Entries.data(), Entries.size() * sizeof(uint32_t));
 
-        std::array<VkDescriptorSetLayoutBinding, 2> Bindings {UboLayoutBinding, SamplerLayoutBinding};
-        VkDescriptorSetLayoutCreateInfo LayoutInfo{};
-        LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        LayoutInfo.bindingCount = static_cast<uint32_t>(Bindings.size());
-        LayoutInfo.pBindings = Bindings.data();
+        std::vector<VkBufferImageCopy> Regions(Header.LevelCount);
 
-        if (vkCreateDescriptorSetLayout(Device, &LayoutInfo, nullptr, &DescriptorSetLayout) != VK_SUCCESS)
+        for (uint32_t Level = 0; Level < Header.LevelCount; ++Level)
         {
-            throw std::runtime_error("Failed to create descriptor set layout!");
+            Regions[Level].bufferOffset = StagingOffset + Header.Levels[Level].FirstPage * sizeof(uint32_t);
+            Regions[Level].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, Level, 0, 1};
+            Regions[Level].imageExtent = {Header.Levels[Level].PagesX, Header.Levels[Level].PagesY, 1};
         }
+
+        RecordTextureBarrier(CommandBuffer, Texture.Image, 0, Header.LevelCount, OldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        vkCmdCopyBufferToImage(CommandBuffer, Buffer, Texture.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(Regions.size()), Regions.data());
+        RecordTextureBarrier(CommandBuffer, Texture.Image, 0, Header.LevelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        Texture.bIndirectionDirty = false;
+
+        return StagingOffset + Entries.size() * sizeof(uint32_t);
     }
 
-    void CreateUniformBuffers()
+    // Each frame in flight stages into its own buffer, the buffer is free again once the frame's fence signals
+    char* ReserveVirtualTextureStaging(std::size_t Frame, VkDeviceSize Size)
     {
-        VkDeviceSize BufferSize = sizeof(UniformBufferObject);
+        if (Size > VirtualTextureStagingSizes[Frame])
+        {
+            DestroyVirtualTextureStaging(Frame);
 
-        UniformBuffers.resize(SwapChainImages.size());
-        UniformBuffersMemory.resize(SwapChainImages.size());
+            CreateBuffer(Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VirtualTextureStagingBuffers[Frame],
+                         VirtualTextureStagingBuffersMemory[Frame]);
 
-        for (size_t i = 0; i < SwapChainImages.size(); ++i)
-        {
-            CreateBuffer(BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, UniformBuffers[i], UniformBuffersMemory[i]);
+            void* Data;
+            vkMapMemory(Device, VirtualTextureStagingBuffersMemory[Frame], 0, Size, 0, &Data);
+            VirtualTextureStagingData[Frame] = static_cast<char*>(Data);
+            VirtualTextureStagingSizes[Frame] = Size;
         }
+
+        return VirtualTextureStagingData[Frame];
     }
 
-    void CreateDescriptorPool()
+    void DestroyVirtualTextureStaging(std::size_t Frame)
     {
-        std::array<VkDescriptorPoolSize, 2> PoolSizes{};
-        PoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        PoolSizes[0].descriptorCount = static_cast<uint32_t>(SwapChainImages.size());
-        PoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        PoolSizes[1].descriptorCount = static_cast<uint32_t>(SwapChainImages.size());
-
-        VkDescriptorPoolCreateInfo PoolInfo{};
-        PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        PoolInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
-        PoolInfo.pPoolSizes = PoolSizes.data();
-        PoolInfo.maxSets = static_cast<uint32_t>(SwapChainImages.size());
-
-        if (vkCreateDescriptorPool(Device, &PoolInfo, nullptr, &DescriptorPool) != VK_SUCCESS)
+        if (VirtualTextureStagingBuffers[Frame] != VK_NULL_HANDLE)
         {
-            throw std::runtime_error("Failed to create descriptor pool!");
+            vkUnmapMemory(Device, VirtualTextureStagingBuffersMemory[Frame]);
+            vkDestroyBuffer(Device, VirtualTextureStagingBuffers[Frame], nullptr);
+            vkFreeMemory(Device, VirtualTextureStagingBuffersMemory[Frame], nullptr);
+            VirtualTextureStagingBuffers[Frame] = VK_NULL_HANDLE;
+            VirtualTextureStagingData[Frame] = nullptr;
+            VirtualTextureStagingSizes[Frame] = 0;
         }
     }
 
-    void CreateDescriptorSet()
+    // One flag per page of every virtual texture, the frame drawn to swap chain image i writes buffer i. Draws find
+    // their texture's flags through FDrawConstants::FeedbackOffset.
+    void CreateVirtualTextureFeedbackBuffers()
     {
-        std::vector<VkDescriptorSetLayout> Layouts(SwapChainImages.size(), DescriptorSetLayout);
-        VkDescriptorSetAllocateInfo AllocInfo{};
-        AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        AllocInfo.descriptorPool = DescriptorPool;
-        AllocInfo.descriptorSetCount = static_cast<uint32_t>(SwapChainImages.size());
-        AllocInfo.pSetLayouts = Layouts.data();
-
-        DescriptorSets.resize(SwapChainImages.size());
-        if (vkAllocateDescriptorSets(Device, &AllocInfo, DescriptorSets.data()) != VK_SUCCESS)
+        if (!bVirtualTexturing)
         {
-            throw std::runtime_error("Failed to allocate descriptor sets!");
+            return;
         }
 
-        for (size_t i = 0; i < SwapChainImages.size(); ++i)
+        VkDeviceSize Size = 0;
+
+        for (auto& Texture : Textures)
         {
-            VkDescriptorBufferInfo BufferInfo{};
-            BufferInfo.buffer = UniformBuffers[i];
-            BufferInfo.offset = 0;
-            BufferInfo.range = sizeof(UniformBufferObject);
+            Texture.FeedbackOffset = Size;
+            Size += Texture.PageSlots.size() * sizeof(uint32_t);
+        }
 
-            VkDescriptorImageInfo ImageInfo{};
-            ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            ImageInfo.imageView = TextureImageView;
-            ImageInfo.sampler = TextureSampler;
+        VirtualTextureFeedbackBuffers.resize(SwapChainImages.size());
+        VirtualTextureFeedbackBuffersMemory.resize(SwapChainImages.size());
+        VirtualTextureFeedbackData.resize(SwapChainImages.size());
 
-            std::array<VkWriteDescriptorSet, 2> DescriptorWrites{};
-            DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            DescriptorWrites[0].dstSet = DescriptorSets[i];
-            DescriptorWrites[0].dstBinding = 0;
-            DescriptorWrites[0].dstArrayElement = 0;
-            DescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            DescriptorWrites[0].descriptorCount = 1;
-            DescriptorWrites[0].pBufferInfo = &BufferInfo;
+        for (size_t i = 0; i < SwapChainImages.size(); ++i)
+        {
+            CreateBuffer(Size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VirtualTextureFeedbackBuffers[i],
+                         VirtualTextureFeedbackBuffersMemory[i]);
 
-            DescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            DescriptorWrites[1].dstSet = DescriptorSets[i];
-            DescriptorWrites[1].dstBinding = 1;
-            DescriptorWrites[1].dstArrayElement = 0;
-            DescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            DescriptorWrites[1].descriptorCount = 1;
-            DescriptorWrites[1].pImageInfo = &ImageInfo;
+            void* Data;
+            vkMapMemory(Device, VirtualTextureFeedbackBuffersMemory[i], 0, Size, 0, &Data);
+            memset(Data, 0, static_cast<size_t>(Size));
+            VirtualTextureFeedbackData[i] = static_cast<uint32_t*>(Data);
+        }
+    }
 
-            vkUpdateDescriptorSets(Device, static_cast<uint32_t>(DescriptorWrites.size()), DescriptorWrites.data(), 0, nullptr);
+    void DestroyVirtualTextureFeedbackBuffers()
+    {
+        for (size_t i = 0; i < VirtualTextureFeedbackBuffers.size(); ++i)
+        {
+            vkUnmapMemory(Device, VirtualTextureFeedbackBuffersMemory[i]);
+            vkDestroyBuffer(Device, VirtualTextureFeedbackBuffers[i], nullptr);
+            vkFreeMemory(Device, VirtualTextureFeedbackBuffersMemory[i], nullptr);
         }
 
+        VirtualTextureFeedbackBuffers.clear();
+        VirtualTextureFeedbackBuffersMemory.clear();
+        VirtualTextureFeedbackData.clear();
     }
 
-    void CreateTextureImage()
+    void DestroyVirtualTextureResources()
     {
-        int TexWidth, TexHeight, TexChannels;
-        stbi_uc* Pixels = stbi_load(TEXTURE_PATH.c_str(), &TexWidth, &TexHeight, &TexChannels, STBI_rgb_alpha);
-        VkDeviceSize ImageSize = TexWidth * TexHeight * 4;
-        MipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(TexWidth, TexHeight)))) + 1;
-
-        if (!Pixels)
+        for (auto& Read : PendingPageReads)
         {
-            throw std::runtime_error("Failed to load texture image!");
+            Read.Ready.wait();
         }
 
-        CreateBuffer(ImageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
+        PendingPageReads.clear();
 
-        void *Data;
-        vkMapMemory(Device, StagingBufferMemory, 0, ImageSize, 0, &Data);
-        memcpy(Data, Pixels, static_cast<size_t>(ImageSize));
-        vkUnmapMemory(Device, StagingBufferMemory);
-        stbi_image_free(Pixels);
-
-        CreateImage(TexWidth, TexHeight, MipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TextureImage, TextureImageMemory);
+        for (std::size_t Frame = 0; Frame < MAX_FRAMES_IN_FLIGHT; ++Frame)
+        {
+            if (VirtualTextureCommandBuffers[Frame] != VK_NULL_HANDLE)
+            {
+                vkFreeCommandBuffers(Device, CommandPool, 1, &VirtualTextureCommandBuffers[Frame]);
+                VirtualTextureCommandBuffers[Frame] = VK_NULL_HANDLE;
+            }
 
-        TransitionImageLayout(TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, MipLevels);
-        CopyBufferToImage(StagingBuffer, TextureImage, static_cast<uint32_t>(TexWidth), static_cast<uint32_t>(TexHeight));
+            DestroyVirtualTextureStaging(Frame);
+        }
 
-        GenerateMipmaps(TextureImage, VK_FORMAT_R8G8B8A8_SRGB, TexWidth, TexHeight, MipLevels);
-        vkDestroyBuffer(Device, StagingBuffer, nullptr);
-        vkFreeMemory(Device, StagingBufferMemory, nullptr);
+        vkDestroySampler(Device, VirtualTextureIndirectionSampler, nullptr);
+        vkDestroySampler(Device, VirtualTextureAtlasSampler, nullptr);
+        vkDestroyImageView(Device, VirtualTextureAtlasView, nullptr);
+        vkDestroyImage(Device, VirtualTextureAtlasImage, nullptr);
+        vkFreeMemory(Device, VirtualTextureAtlasMemory, nullptr);
     }
 
     void CreateImage(uint32_t Width, uint32_t Height, uint32_t MipLevels, VkSampleCountFlagBits NumSamples, VkFormat Format, VkImageTiling Tiling, VkImageUsageFlags Usage, VkMemoryPropertyFlags Properties, VkImage& Image, VkDeviceMemory& ImageMemory)
@@ -1481,12 +3599,8 @@ private:
         return ImageView;
     }
 
-    void CreateTextureImageView()
-    {
-        TextureImageView = CreateImageView(TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, MipLevels);
-    }
-
-    void CreateTextureSampler()
+    // One sampler per level sampling can be clamped to, streamed textures switch between them
+    void CreateTextureSamplers()
     {
         VkSamplerCreateInfo SamplerInfo{};
         SamplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -1506,12 +3620,16 @@ private:
         SamplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
         SamplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         SamplerInfo.mipLodBias = 0.f;
-        SamplerInfo.minLod = 0.f;
-        SamplerInfo.maxLod = static_cast<float>(MipLevels);
+        SamplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
-        if (vkCreateSampler(Device, &SamplerInfo, nullptr, &TextureSampler) != VK_SUCCESS)
+        for (uint32_t Level = 0; Level < TEXTURE_CACHE_MAX_LEVELS; ++Level)
         {
-            throw std::runtime_error("Failed to create texture sampler!");
+            SamplerInfo.minLod = static_cast<float>(Level);
+
+            if (vkCreateSampler(Device, &SamplerInfo, nullptr, &TextureSamplers[Level]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Failed to create texture sampler!");
+            }
         }
     }
 
@@ -1561,127 +3679,107 @@ private:
 
     void LoadModel()
     {
-        tinyobj::attrib_t Attrib;
-        std::vector<tinyobj::shape_t> Shapes;
-        std::vector<tinyobj::material_t> Materials;
-        std::string Warn, Err;
+        auto StartTime = std::chrono::steady_clock::now();
 
-        if (!tinyobj::LoadObj(&Attrib, &Shapes, &Materials, &Warn, &Err, MODEL_PATH.c_str()))
+        if (!ModelCache.Open(GetCookedAssetPath(MODEL_PATH, MESH_CACHE_EXTENSION), GetVertexLayout(MODEL_VERTEX_FORMAT)))
         {
-            throw std::runtime_error(Warn + Err);
+            throw std::runtime_error("Failed to load cooked model, run asset_cooker!");
         }
 
-        std::unordered_map<Vertex, uint32_t> UniqueVertices{};
+        ModelVertexCount = static_cast<uint32_t>(ModelCache.GetHeader().VertexCount);
+        ModelIndexCount = static_cast<uint32_t>(ModelCache.GetHeader().IndexCount);
+        ModelIndexType = ModelCache.GetHeader().IndexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        ModelBounds = ModelCache.GetHeader().Bounds;
+        ModelLods.assign(ModelCache.GetHeader().Lods, ModelCache.GetHeader().Lods + ModelCache.GetHeader().LodCount);
+        ModelSubmeshes.assign(ModelCache.GetSubmeshes(), ModelCache.GetSubmeshes() + ModelCache.GetHeader().SubmeshCount);
+        ModelMaterials.assign(ModelCache.GetMaterials(), ModelCache.GetMaterials() + ModelCache.GetHeader().MaterialCount);
+
+        // Streaming plans its chunks by reading the indices, so they are decoded here. Vertices stay encoded until they are staged.
+        if (ModelIndexType == VK_INDEX_TYPE_UINT16)
+        {
+            CompactIndices.resize(ModelIndexCount);
+        }
+        else
+        {
+            Indices.resize(ModelIndexCount);
+        }
 
+        void* IndexData = ModelIndexType == VK_INDEX_TYPE_UINT16 ? static_cast<void*>(CompactIndices.data()) : Indices.data();
 
-        for (const auto& Shape : Shapes)
+        if (!DecodeIndexBuffer(IndexData, ModelCache.GetIndexData(), ModelCache.GetIndexDataSize(), ModelIndexCount, GetIndexSize(ModelIndexType)))
         {
-            for (const auto& Index : Shape.mesh.indices)
-            {
-                Vertex Vert{};
+            throw std::runtime_error("Failed to decode cooked model indices!");
+        }
 
-                Vert.Pos = {
-                        Attrib.vertices[3 * Index.vertex_index + 0],
-                        Attrib.vertices[3 * Index.vertex_index + 1],
-                        Attrib.vertices[3 * Index.vertex_index + 2]
-                };
+        SubmitMaterialTextureLoads();
 
-                Vert.TexCoord = {
-                        Attrib.texcoords[2 * Index.texcoord_index + 0],
-                        1.f - Attrib.texcoords[2 * Index.texcoord_index + 1],
-                };
+        auto LoadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+        std::cout << "Loaded cooked model in " << LoadTime << " ms" << std::endl;
+    }
 
-                Vert.Color = {1.f, 1.f, 1.f};
+    uint32_t SelectModelLod() const
+    {
+        FVector3 Center((ModelBounds.Min[0] + ModelBounds.Max[0]) * 0.5f, (ModelBounds.Min[1] + ModelBounds.Max[1]) * 0.5f, (ModelBounds.Min[2] + ModelBounds.Max[2]) * 0.5f);
 
-                if (UniqueVertices.find(Vert) == UniqueVertices.end())
-                {
-                    UniqueVertices[Vert] = static_cast<uint32_t>(Vertices.size());
-                    Vertices.push_back(Vert);
-                }
+        // The model spins around the origin, so the closest its bounding sphere gets to the camera does not depend on the angle
+        float Distance = std::sqrt(Dot(CAMERA_POSITION, CAMERA_POSITION)) - std::sqrt(Dot(Center, Center)) - GetMeshBoundsRadius(ModelBounds);
+        float PixelsPerUnit = SwapChainExtent.height / (2.f * std::tan(CAMERA_FOV / 2.f) * std::max(Distance, CAMERA_NEAR));
 
-                Indices.push_back(UniqueVertices[Vert]);
+        for (uint32_t Lod = static_cast<uint32_t>(ModelLods.size()) - 1; Lod > 0; --Lod)
+        {
+            if (ModelLods[Lod].Error * PixelsPerUnit <= LOD_PIXEL_ERROR_THRESHOLD)
+            {
+                return Lod;
             }
         }
+
+        return 0;
     }
 
-    void GenerateMipmaps(VkImage Image, VkFormat ImageFormat, int32_t TexWidth, int32_t TexHeight, uint32_t mipLevels)
+    void UpdateModelLod()
     {
-        VkFormatProperties FormatFroperties;
-        vkGetPhysicalDeviceFormatProperties(PhysicalDevice, ImageFormat, &FormatFroperties);
-
-        if (!(FormatFroperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+        if (bModelBuffersCreated)
         {
-            throw std::runtime_error("Texture image format does not support linear blitting!");
+            CurrentModelLod = SelectModelLod();
         }
+    }
 
-        VkCommandBuffer CommandBuffer = BeginSingleTimeCommands();
-
-        VkImageMemoryBarrier Barrier{};
-        Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        Barrier.image = Image;
-        Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        Barrier.subresourceRange.baseArrayLayer = 0;
-        Barrier.subresourceRange.layerCount = 1;
-        Barrier.subresourceRange.levelCount = 1;
-
-        int32_t MipWidth = TexWidth;
-        int32_t MipHeight = TexHeight;
+    void UpdateDrawArguments(uint32_t CurrentImage)
+    {
+        std::vector<VkDrawIndexedIndirectCommand> DrawCommands(GetDrawCommandCount(), VkDrawIndexedIndirectCommand{});
 
-        for (uint32_t i = 1; i < MipLevels; ++i)
+        // Until the selected LOD is resident the part of LOD0 that is already uploaded gets drawn
+        if (ResidentIndexCount > 0)
         {
-            Barrier.subresourceRange.baseMipLevel = i - 1;
-            Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            Barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-            vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &Barrier);
-
-            VkImageBlit Blit{};
-            Blit.srcOffsets[0] = {0, 0, 0};
-            Blit.srcOffsets[1] = {MipWidth, MipHeight, 1};
-            Blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            Blit.srcSubresource.mipLevel = i - 1;
-            Blit.srcSubresource.baseArrayLayer = 0;
-            Blit.srcSubresource.layerCount = 1;
-            Blit.dstOffsets[0] = {0, 0, 0};
-            Blit.dstOffsets[1] = {MipWidth > 1 ? MipWidth / 2 : 1, MipHeight > 1 ? MipHeight / 2 : 1, 1};
-            Blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            Blit.dstSubresource.mipLevel = i;
-            Blit.dstSubresource.baseArrayLayer = 0;
-            Blit.dstSubresource.layerCount = 1;
-
-            vkCmdBlitImage(CommandBuffer, Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Blit, VK_FILTER_LINEAR);
-
-            Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            Barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            Barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,nullptr, 0, nullptr, 1, &Barrier);
+            const FMeshLod& Lod = ModelLods[CurrentModelLod];
+            bool bLodResident = Lod.FirstIndex + Lod.IndexCount <= ResidentIndexCount;
+            const FMeshLod& DrawnLod = bLodResident ? Lod : ModelLods[0];
 
-            if (MipWidth > 1)
+            for (uint32_t s = DrawnLod.FirstSubmesh; s < DrawnLod.FirstSubmesh + DrawnLod.SubmeshCount; ++s)
             {
-                MipWidth /= 2;
-            }
+                const FMeshSubmesh& Submesh = ModelSubmeshes[s];
+                VkDrawIndexedIndirectCommand& DrawCommand = DrawCommands[Submesh.Material];
 
-            if (MipHeight > 1)
-            {
-                MipHeight /= 2;
+                DrawCommand.indexCount = bLodResident ? Submesh.IndexCount : std::min(ResidentIndexCount - std::min(ResidentIndexCount, Submesh.FirstIndex), Submesh.IndexCount);
+                DrawCommand.instanceCount = 1;
+                DrawCommand.firstIndex = Submesh.FirstIndex;
             }
         }
 
-        Barrier.subresourceRange.baseMipLevel = MipLevels - 1;
-        Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        Barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        void* Data;
+        vkMapMemory(Device, DrawIndirectBuffersMemory[CurrentImage], 0, DrawCommands.size() * sizeof(VkDrawIndexedIndirectCommand), 0, &Data);
+        memcpy(Data, DrawCommands.data(), DrawCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
+        vkUnmapMemory(Device, DrawIndirectBuffersMemory[CurrentImage]);
+    }
 
-        vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,nullptr, 0, nullptr, 1, &Barrier);
+    const void* GetModelIndexData() const
+    {
+        return ModelIndexType == VK_INDEX_TYPE_UINT16 ? static_cast<const void*>(CompactIndices.data()) : Indices.data();
+    }
 
-        EndSingleTimeCommand(CommandBuffer);
+    static uint32_t GetIndexSize(VkIndexType IndexType)
+    {
+        return IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
     }
 
     VkSampleCountFlagBits GetMaxUSableSampleCount()
@@ -1739,22 +3837,191 @@ private:
         CreateImageViews();
         CreateRenderPass();
         CreateDescriptorSetLayout();
+        CreatePipelineLayout();
         CreateGraphicsPipeline();
         CreateCommandPool();
         CreateColorResources();
         CreateDepthResources();
         CreateFramebuffers();
+        StartModelStreaming();
+        CreateVirtualTextureAtlas();
         CreateTextureImage();
-        CreateTextureImageView();
-        CreateTextureSampler();
-        LoadModel();
-        CreateVertexBuffer();
-        CreateIndexBuffer();
+        CreateTextureSamplers();
         CreateUniformBuffers();
+        CreateDrawIndirectBuffers();
+        CreateVirtualTextureFeedbackBuffers();
         CreateDescriptorPool();
         CreateDescriptorSet();
         CreateCommandBuffers();
         CreateSyncObjects();
+
+        if (bEnableShaderHotReload)
+        {
+            ShaderWatcher = std::make_unique<FShaderWatcher>(SHADER_DIRECTORY);
+        }
+    }
+
+    // The compiler runs on the asset load pool so saving a shader never stalls the frame loop, the pipeline is rebuilt
+    // once a compile that changed one of its modules has finished. A source saved again while it compiles is compiled
+    // once more afterwards, so two compiles never write the same output.
+    void ReloadChangedShaders()
+    {
+        for (const auto& SourcePath : ShaderWatcher->PollChangedSources())
+        {
+            auto Pending = std::find_if(PendingShaderCompiles.begin(), PendingShaderCompiles.end(), [&SourcePath](const FShaderCompile& Compile) { return Compile.SourcePath == SourcePath; });
+
+            if (Pending != PendingShaderCompiles.end())
+            {
+                Pending->bSourceChangedAgain = true;
+                continue;
+            }
+
+            PendingShaderCompiles.push_back({SourcePath, SubmitShaderCompile(SourcePath)});
+        }
+
+        std::vector<std::string> CompiledPaths;
+
+        for (auto Compile = PendingShaderCompiles.begin(); Compile != PendingShaderCompiles.end();)
+        {
+            if (!IsFutureReady(Compile->Succeeded))
+            {
+                ++Compile;
+                continue;
+            }
+
+            auto CompiledPath = GetCompiledShaderPath(Compile->SourcePath);
+
+            if (!Compile->Succeeded.get())
+            {
+                std::cerr << "Failed to compile " << Compile->SourcePath << ", keeping the current pipeline" << std::endl;
+            }
+            else if (CompiledPath == VERTEX_SHADER_PATH || CompiledPath == GetFragmentShaderPath())
+            {
+                CompiledPaths.push_back(CompiledPath);
+            }
+
+            if (Compile->bSourceChangedAgain)
+            {
+                Compile->Succeeded = SubmitShaderCompile(Compile->SourcePath);
+                Compile->bSourceChangedAgain = false;
+                ++Compile;
+            }
+            else
+            {
+                Compile = PendingShaderCompiles.erase(Compile);
+            }
+        }
+
+        if (!CompiledPaths.empty())
+        {
+            RebuildGraphicsPipeline(CompiledPaths);
+        }
+    }
+
+    std::future<bool> SubmitShaderCompile(const std::string& SourcePath)
+    {
+        return AssetLoadPool.Submit([SourcePath]() { return CompileShader(SHADER_COMPILER, SourcePath, GetCompiledShaderPath(SourcePath)); });
+    }
+
+    // The changed modules and the new pipeline are created next to the current ones, which keep rendering if either
+    // fails. The replaced objects are retired through the deferred destroy list instead of waiting for every frame.
+    void RebuildGraphicsPipeline(const std::vector<std::string>& CompiledPaths)
+    {
+        std::unordered_map<std::string, FShaderModuleCacheEntry> OldModules;
+        VkPipeline OldPipeline = GraphicsPipeline;
+        std::array<VkPipeline, 4> OldLibraries = PipelineLibraries;
+        auto OldOptimizedPipelineFuture = std::move(OptimizedPipelineFuture);
+
+        try
+        {
+            for (const auto& Path : CompiledPaths)
+            {
+                auto It = ShaderModuleCache.find(Path);
+
+                if (It == ShaderModuleCache.end() || OldModules.count(Path) != 0)
+                {
+                    continue;
+                }
+
+                auto Code = ReadFile(Path);
+                uint64_t Hash = HashBytes(Code.data(), Code.size());
+
+                if (Hash == It->second.Hash)
+                {
+                    continue;
+                }
+
+                VkShaderModule NewModule = CreateShaderModule(Code);
+                OldModules[Path] = It->second;
+                It->second.Module = NewModule;
+                It->second.Hash = Hash;
+            }
+
+            if (OldModules.empty())
+            {
+                OptimizedPipelineFuture = std::move(OldOptimizedPipelineFuture);
+                return;
+            }
+
+            CreateGraphicsPipeline();
+        }
+        catch (const std::exception& Error)
+        {
+            std::cerr << "Failed to rebuild the graphics pipeline (" << Error.what() << "), keeping the current pipeline" << std::endl;
+
+            for (std::size_t i = 1; i < PipelineLibraries.size(); ++i)
+            {
+                if (PipelineLibraries[i] != OldLibraries[i])
+                {
+                    vkDestroyPipeline(Device, PipelineLibraries[i], nullptr);
+                }
+            }
+
+            for (const auto& Entry : OldModules)
+            {
+                vkDestroyShaderModule(Device, ShaderModuleCache[Entry.first].Module, nullptr);
+                ShaderModuleCache[Entry.first] = Entry.second;
+            }
+
+            PipelineLibraries = OldLibraries;
+            GraphicsPipeline = OldPipeline;
+            OptimizedPipelineFuture = std::move(OldOptimizedPipelineFuture);
+            return;
+        }
+
+        // An optimized link still running reads the old libraries, so they are released only after its result
+        auto OldOptimizedPipeline = std::make_shared<std::future<VkPipeline>>(std::move(OldOptimizedPipelineFuture));
+
+        DeferDestroy([this, OldPipeline, OldLibraries, OldModules, OldOptimizedPipeline, OldCommandBuffers = CommandBuffers]()
+        {
+            vkFreeCommandBuffers(Device, CommandPool, static_cast<uint32_t>(OldCommandBuffers.size()), OldCommandBuffers.data());
+            vkDestroyPipeline(Device, OldPipeline, nullptr);
+
+            if (OldOptimizedPipeline->valid())
+            {
+                VkPipeline OptimizedPipeline = OldOptimizedPipeline->get();
+
+                if (OptimizedPipeline != VK_NULL_HANDLE)
+                {
+                    vkDestroyPipeline(Device, OptimizedPipeline, nullptr);
+                }
+            }
+
+            for (std::size_t i = 1; i < OldLibraries.size(); ++i)
+            {
+                if (OldLibraries[i] != VK_NULL_HANDLE)
+                {
+                    vkDestroyPipeline(Device, OldLibraries[i], nullptr);
+                }
+            }
+
+            for (const auto& Entry : OldModules)
+            {
+                vkDestroyShaderModule(Device, Entry.second.Module, nullptr);
+            }
+        });
+
+        CreateCommandBuffers();
     }
 
     void MainLoop()
@@ -1762,6 +4029,12 @@ private:
         while (!glfwWindowShouldClose(Window))
         {
             glfwPollEvents();
+
+            if (ShaderWatcher)
+            {
+                ReloadChangedShaders();
+            }
+
             DrawFrame();
         }
         vkDeviceWaitIdle(Device);
@@ -1770,6 +4043,12 @@ private:
     void DrawFrame()
     {
         vkWaitForFences(Device, 1, &InFlightFences[CurrentFrame], VK_TRUE, UINT64_MAX);
+        RunDeferredDestroys(CurrentFrame);
+        SwapInOptimizedPipeline();
+        UpdateModelStreaming();
+        UpdateTextureStreaming();
+        UpdateModelLod();
+
         uint ImageIndex;
         VkResult Result = vkAcquireNextImageKHR(Device, SwapChain, UINT64_MAX, ImageAvailableSemaphores[CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
 
@@ -1789,8 +4068,11 @@ private:
         }
 
         ImagesInFlight[ImageIndex] = InFlightFences[CurrentFrame];
+        FlushTextureDescriptorWrites(ImageIndex);
 
         UpdateUniformBuffer(ImageIndex);
+        UpdateDrawArguments(ImageIndex);
+        UpdateVirtualTextures(ImageIndex);
 
         VkSubmitInfo SubmitInfo{};
         SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1800,8 +4082,12 @@ private:
         SubmitInfo.waitSemaphoreCount = 1;
         SubmitInfo.pWaitSemaphores = WaitSemaphores;
         SubmitInfo.pWaitDstStageMask = WaitStages;
-        SubmitInfo.commandBufferCount = 1;
-        SubmitInfo.pCommandBuffers = &CommandBuffers[ImageIndex];
+
+        // Pages uploaded this frame are copied ahead of the draw that samples them
+        VkCommandBuffer FrameCommandBuffers[] = {VirtualTextureCommandBuffers[CurrentFrame], CommandBuffers[ImageIndex]};
+        bool bUploadPages = FrameCommandBuffers[0] != VK_NULL_HANDLE;
+        SubmitInfo.commandBufferCount = bUploadPages ? 2 : 1;
+        SubmitInfo.pCommandBuffers = bUploadPages ? FrameCommandBuffers : &FrameCommandBuffers[1];
 
         VkSemaphore SignalSemaphores[] = {RenderFinishedSemaphores[CurrentFrame]};
         SubmitInfo.signalSemaphoreCount = 1;
@@ -1847,9 +4133,10 @@ private:
         float Time = std::chrono::duration<float, std::chrono::seconds::period>(CurrentTime - StartTime).count();
 
         UniformBufferObject UBO{};
-        UBO.Model = Rotate(Time * 1.f, FVector3(0.f, 0.f, 1.f));
-        UBO.View = LookAt(FVector3(2.f, 2.f, 2.f), FVector3(0.f, 0.f, 0.f), FVector3(0.f, 0.f, 1.f));
-        UBO.Projection = GetPerspective(0.785398f, SwapChainExtent.width / (float) SwapChainExtent.height, 0.1f, 10.f);
+        UBO.Model = Rotate(Time * 1.f, FVector3(0.f, 0.f, 1.f)) * ModelDequantization;
+        UBO.View = LookAt(CAMERA_POSITION, FVector3(0.f, 0.f, 0.f), FVector3(0.f, 0.f, 1.f));
+        UBO.Projection = GetPerspective(CAMERA_FOV, SwapChainExtent.width / (float) SwapChainExtent.height, CAMERA_NEAR, CAMERA_FAR);
+        UBO.TexCoordDequantization = ModelTexCoordDequantization;
 
         void* Data;
         vkMapMemory(Device, UniformBuffersMemory[CurrentImage], 0, sizeof(UBO), 0, &Data);
@@ -1859,16 +4146,51 @@ private:
 
     void Cleanup()
     {
+        if (ModelLoadFuture.valid())
+        {
+            ModelLoadFuture.wait();
+        }
+
+        for (std::size_t Frame = 0; Frame < MAX_FRAMES_IN_FLIGHT; ++Frame)
+        {
+            RunDeferredDestroys(Frame);
+        }
+
+        DestroyModelStreamingResources();
+        DestroyTextureStreamingResources();
+        DestroyVirtualTextureResources();
         CleanUpSwapChain();
 
-        vkDestroySampler(Device, TextureSampler, nullptr);
-        vkDestroyImageView(Device, TextureImageView, nullptr);
+        for (VkSampler Sampler : TextureSamplers)
+        {
+            vkDestroySampler(Device, Sampler, nullptr);
+        }
 
-        vkDestroyImage(Device, TextureImage, nullptr);
-        vkFreeMemory(Device, TextureImageMemory, nullptr);
+        for (const auto& Texture : Textures)
+        {
+            vkDestroyImageView(Device, Texture.View, nullptr);
+            vkDestroyImage(Device, Texture.Image, nullptr);
+            vkFreeMemory(Device, Texture.Memory, nullptr);
+        }
 
         vkDestroyDescriptorSetLayout(Device, DescriptorSetLayout, nullptr);
 
+        ClearShaderModuleCache();
+
+        if (PipelineLibraries[0] != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(Device, PipelineLibraries[0], nullptr);
+        }
+
+        vkDestroyBuffer(Device, MeshletTriangleBuffer, nullptr);
+        vkFreeMemory(Device, MeshletTriangleBufferMemory, nullptr);
+
+        vkDestroyBuffer(Device, MeshletVertexBuffer, nullptr);
+        vkFreeMemory(Device, MeshletVertexBufferMemory, nullptr);
+
+        vkDestroyBuffer(Device, MeshletBuffer, nullptr);
+        vkFreeMemory(Device, MeshletBufferMemory, nullptr);
+
         vkDestroyBuffer(Device, IndexBuffer, nullptr);
         vkFreeMemory(Device, IndexBufferMemory, nullptr);
 
@@ -1913,9 +4235,19 @@ private:
     VkDescriptorSetLayout DescriptorSetLayout;
     VkDescriptorPool DescriptorPool;
     std::vector<VkDescriptorSet> DescriptorSets;
+    std::vector<std::vector<std::size_t>> PendingTextureWrites;
+    std::vector<char> PendingVirtualTextureWrites;
+    std::vector<FRetiredTextureImage> RetiredTextureImages;
     VkPipelineLayout PipelineLayout;
     VkRenderPass RenderPass;
     VkPipeline GraphicsPipeline;
+    std::array<VkPipeline, 4> PipelineLibraries{};
+    std::future<VkPipeline> OptimizedPipelineFuture;
+    std::array<std::vector<std::function<void()>>, MAX_FRAMES_IN_FLIGHT> DeferredDestroys;
+    bool bGraphicsPipelineLibrarySupported = false;
+    bool bHostImageCopySupported = false;
+    PFN_vkCopyMemoryToImageEXT CopyMemoryToImageEXT = nullptr;
+    PFN_vkTransitionImageLayoutEXT TransitionImageLayoutEXT = nullptr;
     std::vector<VkFramebuffer> SwapChainFramebuffers;
     VkCommandPool CommandPool;
     std::vector<VkCommandBuffer> CommandBuffers;
@@ -1925,18 +4257,24 @@ private:
     std::vector<VkFence> ImagesInFlight;
     size_t CurrentFrame = 0;
     bool bFramebufferResized = false;
-    VkBuffer VertexBuffer;
-    VkDeviceMemory VertexBufferMemory;
-    VkBuffer IndexBuffer;
-    VkDeviceMemory IndexBufferMemory;
-    VkBuffer StagingBuffer;
-    VkDeviceMemory StagingBufferMemory;
-    uint32_t  MipLevels;
-    VkImage TextureImage;
-    VkDeviceMemory TextureImageMemory;
-    VkImageView TextureImageView;
-    VkSampler TextureSampler;
+    VkBuffer VertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory VertexBufferMemory = VK_NULL_HANDLE;
+    VkBuffer IndexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory IndexBufferMemory = VK_NULL_HANDLE;
+    VkBuffer MeshletBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory MeshletBufferMemory = VK_NULL_HANDLE;
+    VkBuffer MeshletVertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory MeshletVertexBufferMemory = VK_NULL_HANDLE;
+    VkBuffer MeshletTriangleBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory MeshletTriangleBufferMemory = VK_NULL_HANDLE;
+    // Staging buffers of recorded texture uploads, released once the command buffer they were recorded into completed
+    std::vector<FStagingBuffer> PendingStagingBuffers;
+    std::vector<FTexture> Textures;
+    std::vector<uint32_t> MaterialTextures;
+    std::array<VkSampler, TEXTURE_CACHE_MAX_LEVELS> TextureSamplers{};
     VkSampleCountFlagBits MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+    std::vector<VkFormat> SupportedTextureFormats;
+    std::vector<VkFormat> HostImageCopyFormats;
     VkImage DepthImage;
     VkDeviceMemory DepthImageMemory;
     VkImageView DepthImageView;
@@ -1946,9 +4284,69 @@ private:
 
     std::vector<VkBuffer> UniformBuffers;
     std::vector<VkDeviceMemory> UniformBuffersMemory;
+    std::vector<VkBuffer> DrawIndirectBuffers;
+    std::vector<VkDeviceMemory> DrawIndirectBuffersMemory;
+
+    std::unordered_map<std::string, FShaderModuleCacheEntry> ShaderModuleCache;
+    std::unique_ptr<FShaderWatcher> ShaderWatcher;
+    std::vector<FShaderCompile> PendingShaderCompiles;
 
-    std::vector<Vertex> Vertices;
     std::vector<uint32_t> Indices;
+    std::vector<uint16_t> CompactIndices;
+    FMeshCache ModelCache;
+    uint32_t ModelVertexCount = 0;
+    uint32_t ModelIndexCount = 0;
+    VkIndexType ModelIndexType = VK_INDEX_TYPE_UINT32;
+    VkDeviceSize ConstantColorOffset = 0;
+    FMatrix4 ModelDequantization;
+    FVector4 ModelTexCoordDequantization{1.f, 1.f, 0.f, 0.f};
+    FMeshBounds ModelBounds{};
+    std::vector<FMeshLod> ModelLods;
+    std::vector<FMeshSubmesh> ModelSubmeshes;
+    std::vector<FMeshMaterial> ModelMaterials;
+    std::vector<std::future<std::unique_ptr<FTextureCache>>> MaterialTextureFutures;
+    uint32_t CurrentModelLod = 0;
+
+    std::chrono::steady_clock::time_point AssetLoadStartTime;
+    std::future<std::unique_ptr<FTextureCache>> DefaultTextureFuture;
+    std::future<void> ModelLoadFuture;
+    std::chrono::steady_clock::time_point ModelStreamStartTime;
+    std::array<FModelStream, static_cast<std::size_t>(EModelStream::Count)> ModelStreams{};
+    VkBuffer ModelStagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory ModelStagingBufferMemory = VK_NULL_HANDLE;
+    char* ModelStagingData = nullptr;
+    VkCommandBuffer ModelUploadCommandBuffer = VK_NULL_HANDLE;
+    VkFence ModelUploadFence = VK_NULL_HANDLE;
+    bool bModelBuffersCreated = false;
+    bool bModelResident = false;
+    uint32_t ResidentIndexCount = 0;
+    VkBuffer TextureStagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory TextureStagingBufferMemory = VK_NULL_HANDLE;
+    char* TextureStagingData = nullptr;
+    VkDeviceSize TextureStagingSize = 0;
+    VkCommandBuffer TextureUploadCommandBuffer = VK_NULL_HANDLE;
+    VkFence TextureUploadFence = VK_NULL_HANDLE;
+    FTextureUpload PendingTextureUpload{};
+    bool bVirtualTexturing = false;
+    FPageCache VirtualTexturePageCache;
+    uint64_t VirtualTextureFrame = 0;
+    VkImage VirtualTextureAtlasImage = VK_NULL_HANDLE;
+    VkDeviceMemory VirtualTextureAtlasMemory = VK_NULL_HANDLE;
+    VkImageView VirtualTextureAtlasView = VK_NULL_HANDLE;
+    VkSampler VirtualTextureAtlasSampler = VK_NULL_HANDLE;
+    VkSampler VirtualTextureIndirectionSampler = VK_NULL_HANDLE;
+    std::vector<VkBuffer> VirtualTextureFeedbackBuffers;
+    std::vector<VkDeviceMemory> VirtualTextureFeedbackBuffersMemory;
+    std::vector<uint32_t*> VirtualTextureFeedbackData;
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> VirtualTextureStagingBuffers{};
+    std::array<VkDeviceMemory, MAX_FRAMES_IN_FLIGHT> VirtualTextureStagingBuffersMemory{};
+    std::array<char*, MAX_FRAMES_IN_FLIGHT> VirtualTextureStagingData{};
+    std::array<VkDeviceSize, MAX_FRAMES_IN_FLIGHT> VirtualTextureStagingSizes{};
+    std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> VirtualTextureCommandBuffers{};
+    std::vector<FVirtualPageRead> PendingPageReads;
+
+    // Declared last so queued loads finish before the members they write to are destroyed
+    FTaskPool AssetLoadPool;
 
 
 };
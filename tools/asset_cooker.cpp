@@ -0,0 +1,248 @@
+#include "main.h"
+#include "cooked_assets.h"
+#include "model_cooker.h"
+#include "texture_cooker.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class EAssetType
+{
+    Model,
+    Texture
+};
+
+struct FCookJob
+{
+    EAssetType Type;
+    std::string SourcePath;
+    std::string CookedPath;
+    uintmax_t SourceSize;
+};
+
+static bool GetAssetType(const std::filesystem::path& Path, EAssetType& Type)
+{
+    std::string Extension = Path.extension().string();
+    std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char C) { return static_cast<char>(std::tolower(C)); });
+
+    if (Extension == ".obj")
+    {
+        Type = EAssetType::Model;
+        return true;
+    }
+
+    if (Extension == ".png" || Extension == ".jpg" || Extension == ".jpeg" || Extension == ".tga" || Extension == ".bmp")
+    {
+        Type = EAssetType::Texture;
+        return true;
+    }
+
+    return false;
+}
+
+static std::vector<FCookJob> FindCookJobs(const std::vector<std::string>& InputDirectories)
+{
+    std::vector<FCookJob> Jobs;
+
+    for (const auto& Directory : InputDirectories)
+    {
+        std::error_code Error;
+
+        for (std::filesystem::recursive_directory_iterator It(Directory, Error), End; !Error && It != End; It.increment(Error))
+        {
+            EAssetType Type;
+
+            if (It->is_regular_file() && GetAssetType(It->path(), Type))
+            {
+                std::string SourcePath = It->path().lexically_normal().generic_string();
+                const std::string& Extension = Type == EAssetType::Model ? MESH_CACHE_EXTENSION : TEXTURE_CACHE_EXTENSION;
+                Jobs.push_back({Type, SourcePath, GetCookedAssetPath(SourcePath, Extension), It->file_size()});
+            }
+        }
+
+        if (Error)
+        {
+            std::cerr << "Failed to scan " << Directory << ": " << Error.message() << std::endl;
+        }
+    }
+
+    // Largest inputs start first so one big model does not end up running alone at the end
+    std::sort(Jobs.begin(), Jobs.end(), [](const FCookJob& A, const FCookJob& B) { return A.SourceSize > B.SourceSize; });
+
+    return Jobs;
+}
+
+static bool IsCookedAssetCurrent(const FCookJob& Job, uint64_t SourceHash, const FTextureCookSettings& Settings)
+{
+    if (Job.Type == EAssetType::Model)
+    {
+        FMeshCache Cache;
+        return Cache.Open(Job.CookedPath, GetVertexLayout(MODEL_VERTEX_FORMAT)) && Cache.GetHeader().SourceHash == SourceHash;
+    }
+
+    return IsCookedTextureCurrent(Job.SourcePath, Job.CookedPath, SourceHash, Settings);
+}
+
+enum class ECookResult
+{
+    Cooked,
+    Skipped,
+    Failed
+};
+
+static ECookResult RunCookJob(const FCookJob& Job, const FTextureCookSettings& Settings, std::ostream& Log)
+{
+    bool bFound;
+    uint64_t SourceHash = Job.Type == EAssetType::Model ? HashModelSources(Job.SourcePath, bFound) : HashTextureSource(Job.SourcePath, bFound);
+
+    if (!bFound)
+    {
+        Log << "Failed to open " << Job.SourcePath << std::endl;
+        return ECookResult::Failed;
+    }
+
+    if (IsCookedAssetCurrent(Job, SourceHash, Settings))
+    {
+        return ECookResult::Skipped;
+    }
+
+    std::error_code Error;
+    std::filesystem::create_directories(std::filesystem::path(Job.CookedPath).parent_path(), Error);
+
+    auto StartTime = std::chrono::steady_clock::now();
+    bool bCooked;
+
+    try
+    {
+        bCooked = Job.Type == EAssetType::Model ? CookModel(Job.SourcePath, Job.CookedPath, SourceHash, Log) : CookTexture(Job.SourcePath, Job.CookedPath, SourceHash, Settings, Log);
+    }
+    catch (const std::exception& Exception)
+    {
+        Log << Exception.what() << std::endl;
+        bCooked = false;
+    }
+
+    if (!bCooked)
+    {
+        Log << "Failed to cook " << Job.SourcePath << std::endl;
+        return ECookResult::Failed;
+    }
+
+    auto CookTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+    Log << "Cooked " << Job.SourcePath << " -> " << Job.CookedPath << " in " << CookTime << " ms" << std::endl;
+
+    return ECookResult::Cooked;
+}
+
+static bool ParseCompressionQuality(const std::string& Name, ECompressionQuality& Quality)
+{
+    const std::pair<const char*, ECompressionQuality> Presets[] = {
+            {"fast", ECompressionQuality::Fast},
+            {"normal", ECompressionQuality::Normal},
+            {"high", ECompressionQuality::High}
+    };
+
+    for (const auto& Preset : Presets)
+    {
+        if (Name == Preset.first)
+        {
+            Quality = Preset.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Usage: asset_cooker [--quality fast|normal|high] [--supercompress] [--virtual-textures] [input directories...], run from the directory the application runs in
+int main(int argc, char** argv)
+{
+    std::vector<std::string> InputDirectories;
+    FTextureCookSettings Settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string Argument = argv[i];
+
+        if (Argument == "--supercompress")
+        {
+            Settings.Supercompression = ETextureSupercompression::Lz;
+        }
+        else if (Argument == "--virtual-textures")
+        {
+            Settings.bVirtualTexture = true;
+        }
+        else if (Argument != "--quality")
+        {
+            InputDirectories.push_back(Argument);
+        }
+        else if (i + 1 >= argc || !ParseCompressionQuality(argv[++i], Settings.Quality))
+        {
+            std::cerr << "Failed to parse --quality, expected fast, normal or high" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (InputDirectories.empty())
+    {
+        InputDirectories = {"models", "textures"};
+    }
+
+    auto StartTime = std::chrono::steady_clock::now();
+    std::vector<FCookJob> Jobs = FindCookJobs(InputDirectories);
+
+    std::atomic<std::size_t> NextJob{0};
+    std::atomic<std::size_t> Counts[3] = {{0}, {0}, {0}};
+    std::mutex LogMutex;
+
+    auto Worker = [&]()
+    {
+        for (std::size_t i = NextJob++; i < Jobs.size(); i = NextJob++)
+        {
+            std::ostringstream Log;
+            ECookResult Result = RunCookJob(Jobs[i], Settings, Log);
+            ++Counts[static_cast<int>(Result)];
+
+            std::lock_guard<std::mutex> Lock(LogMutex);
+            std::cout << Log.str();
+        }
+    };
+
+    std::size_t ThreadCount = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, std::max<std::size_t>(Jobs.size(), 1));
+    std::vector<std::thread> Workers;
+
+    for (std::size_t i = 1; i < ThreadCount; ++i)
+    {
+        Workers.emplace_back(Worker);
+    }
+
+    Worker();
+
+    for (auto& Thread : Workers)
+    {
+        Thread.join();
+    }
+
+    auto CookTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+    std::cout << "Cooked " << Counts[0] << ", up to date " << Counts[1] << ", failed " << Counts[2] << " of " << Jobs.size() << " assets in " << CookTime << " ms on "
+              << ThreadCount << " threads" << std::endl;
+
+    return Counts[2] == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}